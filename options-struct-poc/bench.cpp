@@ -0,0 +1,609 @@
+#include <atomic>
+#include <cstdlib>
+#include <fcntl.h>
+#include <map>
+#include <optional>
+#include <new>
+#include <spawn.h>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "options-colormap-lut.h"
+#include "options-history.h"
+#include "options-json.h"
+#include "options-snapshot.h"
+#include "options-structio.h" // generated
+#include "options.h"
+#include "regex-parsers.h"
+
+typedef struct options_ns::f3d_options Options;
+typedef options_ns::f3d_options_io::Diff OptionsDiff;
+namespace OptionsIO = options_ns::f3d_options_io;
+
+/* count the allocations of the whole program, benchmarks report the
+  difference per iteration as the `allocs` counter */
+static std::atomic<size_t> allocations = 0;
+
+static void *counted_alloc(size_t size, size_t alignment = 0) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  size = size ? size : 1;
+  if (void *p = alignment ? std::aligned_alloc(
+                                alignment, (size + alignment - 1) / alignment *
+                                               alignment)
+                          : std::malloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+static void counted_free(void *p) noexcept { std::free(p); }
+
+void *operator new(size_t size) { return counted_alloc(size); }
+void *operator new[](size_t size) { return counted_alloc(size); }
+void *operator new(size_t size, std::align_val_t al) {
+  return counted_alloc(size, static_cast<size_t>(al));
+}
+void *operator new[](size_t size, std::align_val_t al) {
+  return counted_alloc(size, static_cast<size_t>(al));
+}
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+void operator delete(void *p, size_t) noexcept { counted_free(p); }
+void operator delete[](void *p, size_t) noexcept { counted_free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+  counted_free(p);
+}
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+  counted_free(p);
+}
+
+namespace {
+
+class count_allocations {
+public:
+  explicit count_allocations(benchmark::State &state)
+      : state(state), first(allocations.load()) {}
+  ~count_allocations() {
+    state.counters["allocs"] = benchmark::Counter(
+        double(allocations.load() - first), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State &state;
+  size_t first;
+};
+
+/* one key per value type, with a value as string and json */
+struct sample {
+  const char *type;
+  std::string_view key;
+  std::string str;
+  json js;
+};
+
+const std::vector<sample> &samples() {
+  static const std::vector<sample> samples = {
+      {"std::string", OptionsIO::keys.model.color.texture, "/tmp/texture.png",
+       "/tmp/texture.png"},
+      {"int", OptionsIO::keys.scene.animation.index, "42", 42},
+      {"double", OptionsIO::keys.camera.view_angle, "33.5", 33.5},
+      {"bool", OptionsIO::keys.interactor.axis, "yes", true},
+      {"Vector3", OptionsIO::keys.camera.direction, "-y", {0., -1., 0.}},
+      {"Point3", OptionsIO::keys.camera.position, "1.5,-2,3e2",
+       {1.5, -2., 3e2}},
+      {"Color", OptionsIO::keys.model.color.rgb, "#ff8000", {1., .5, 0.}},
+      {"Colormap", OptionsIO::keys.model.scivis.colormap, "viridis",
+       "viridis"},
+  };
+  return samples;
+}
+
+const std::string config = R"(
+{
+  "render": {
+    "background": {"color": [0.5, 0.5, 0.5]},
+    "effect": {"ambient_occlusion": true, "anti_aliasing": "yes"},
+    "grid": {"enable": true, "subdivisions": 5}
+  },
+  "camera": {"position": [1, 2, 3], "view_angle": 45},
+  "model.scivis.colormap": "inferno",
+  "ui": {"font_file": "~/myfont.ttf"}
+}
+)";
+
+const std::vector<const char *> argv = {
+    "App",       "-g",     "--camera-position=0,0,10", "--colormap=plasma",
+    "--up=+z",   "--font", "/usr/share/fonts/f.ttf",   "model.obj",
+};
+
+/* a diff changing every sample key */
+OptionsDiff samples_diff() {
+  OptionsDiff diff;
+  for (const auto &s : samples())
+    diff[s.key] = OptionsIO::from_string(s.key, s.str);
+  return diff;
+}
+
+void BM_key_id(benchmark::State &state, std::string_view key) {
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::key_id(key));
+}
+
+void BM_find_key_id_unknown(benchmark::State &state) {
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::find_key_id("render.grid.enabled"));
+}
+BENCHMARK(BM_find_key_id_unknown);
+
+void BM_get(benchmark::State &state, std::string_view key) {
+  const Options options;
+  const auto id = OptionsIO::key_id(key);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::get(options, id));
+}
+
+void BM_set(benchmark::State &state, const sample &s) {
+  Options options;
+  const auto id = OptionsIO::key_id(s.key);
+  const auto value = OptionsIO::from_string(id, s.str);
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::set(options, id, value);
+    benchmark::ClobberMemory();
+  }
+}
+
+void BM_from_string(benchmark::State &state, const sample &s) {
+  const auto id = OptionsIO::key_id(s.key);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::from_string(id, s.str));
+}
+
+void BM_try_from_string(benchmark::State &state, const sample &s) {
+  const auto id = OptionsIO::key_id(s.key);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::try_from_string(id, s.str));
+}
+
+void BM_from_json(benchmark::State &state, const sample &s) {
+  const auto id = OptionsIO::key_id(s.key);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::from_json(id, s.js));
+}
+
+void BM_to_string(benchmark::State &state, const sample &s) {
+  const auto id = OptionsIO::key_id(s.key);
+  const auto value = OptionsIO::from_string(id, s.str);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::to_string(id, value));
+}
+
+void BM_to_json(benchmark::State &state, const sample &s) {
+  const auto id = OptionsIO::key_id(s.key);
+  const auto value = OptionsIO::from_string(id, s.str);
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::to_json(id, value));
+}
+
+/* rejecting malformed input, with and without exceptions */
+void BM_from_string_malformed(benchmark::State &state) {
+  const auto id = OptionsIO::key_id(OptionsIO::keys.camera.view_angle);
+  const std::string value = "60deg";
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    try {
+      benchmark::DoNotOptimize(OptionsIO::from_string(id, value));
+    } catch (std::invalid_argument &) {
+    }
+  }
+}
+BENCHMARK(BM_from_string_malformed);
+
+void BM_try_from_string_malformed(benchmark::State &state) {
+  const auto id = OptionsIO::key_id(OptionsIO::keys.camera.view_angle);
+  const std::string value = "60deg";
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::try_from_string(id, value));
+}
+BENCHMARK(BM_try_from_string_malformed);
+
+void BM_format_double_buffer(benchmark::State &state) {
+  char buffer[options_ns::format_buffer_size];
+  const double value = 0.1 + 0.2;
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        options_ns::format_double(buffer, std::end(buffer), value));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_format_double_buffer);
+
+/* the hand-written scanners against the regex parsers they replaced, which
+  built their regexes on every call (`_regex`), and against the matching alone
+  with regexes built once (`_regex_cached`) */
+template <typename Parse>
+void BM_parse_triple(benchmark::State &state, Parse parse, std::string value) {
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(parse(value));
+}
+BENCHMARK_CAPTURE(BM_parse_triple, Vector3_axis_scanner,
+                  options_ns::parse_Vector3, std::string("-y"));
+BENCHMARK_CAPTURE(BM_parse_triple, Vector3_axis_regex,
+                  regex_parsers::per_call::parse_Vector3, std::string("-y"));
+BENCHMARK_CAPTURE(BM_parse_triple, Vector3_axis_regex_cached,
+                  regex_parsers::parse_Vector3, std::string("-y"));
+BENCHMARK_CAPTURE(BM_parse_triple, Point3_scanner, options_ns::parse_Point3,
+                  std::string("1.5,-2,3e2"));
+BENCHMARK_CAPTURE(BM_parse_triple, Point3_regex,
+                  regex_parsers::per_call::parse_Point3,
+                  std::string("1.5,-2,3e2"));
+BENCHMARK_CAPTURE(BM_parse_triple, Point3_regex_cached,
+                  regex_parsers::parse_Point3, std::string("1.5,-2,3e2"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_hex_scanner, options_ns::parse_Color,
+                  std::string("#ff8000"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_hex_regex,
+                  regex_parsers::per_call::parse_Color, std::string("#ff8000"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_hex_regex_cached,
+                  regex_parsers::parse_Color, std::string("#ff8000"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_brackets_scanner,
+                  options_ns::parse_Color, std::string("(0.5, 0.25, 1)"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_brackets_regex,
+                  regex_parsers::per_call::parse_Color,
+                  std::string("(0.5, 0.25, 1)"));
+BENCHMARK_CAPTURE(BM_parse_triple, Color_brackets_regex_cached,
+                  regex_parsers::parse_Color, std::string("(0.5, 0.25, 1)"));
+
+void BM_diff(benchmark::State &state) {
+  const Options previous;
+  Options current;
+  OptionsIO::apply(current, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::diff(current, previous));
+}
+BENCHMARK(BM_diff);
+
+/* the `std::map<std::string, std::optional<V>>` diff that the generated
+  `Diff` replaced, keyed and applied by name */
+typedef std::map<std::string, std::optional<OptionsIO::V>> MapDiff;
+
+MapDiff map_diff(const Options &current, const Options &previous) {
+  MapDiff d;
+  OptionsIO::for_each_field(
+      current, previous, [&](auto key, const auto &a, const auto &b) {
+        if (a != b)
+          d[std::string(OptionsIO::key_name(key.value))] =
+              OptionsIO::get(current, key.value);
+      });
+  return d;
+}
+
+void map_apply(Options &s, const MapDiff &diff) {
+  for (const auto &[key, value] : diff)
+    if (value.has_value())
+      OptionsIO::set(s, key, value.value());
+    else
+      OptionsIO::unset(s, key);
+}
+
+void BM_diff_apply(benchmark::State &state) {
+  const Options previous;
+  Options current, target;
+  OptionsIO::apply(current, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::apply(target, OptionsIO::diff(current, previous));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_diff_apply);
+
+void BM_diff_apply_map(benchmark::State &state) {
+  const Options previous;
+  Options current, target;
+  OptionsIO::apply(current, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    map_apply(target, map_diff(current, previous));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_diff_apply_map);
+
+void BM_diff_equal(benchmark::State &state) {
+  const Options previous, current;
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::diff(current, previous));
+}
+BENCHMARK(BM_diff_equal);
+
+/* one element changed in a large vector option, diffed as an edit */
+void BM_diff_vector_edit(benchmark::State &state) {
+  Options previous;
+  previous.model.volume.opacity_map.assign(state.range(0), 0.5);
+  Options current = previous;
+  current.model.volume.opacity_map[state.range(0) / 2] = 0.25;
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::edit_diff(current, previous));
+}
+BENCHMARK(BM_diff_vector_edit)->Arg(64)->Arg(4096);
+
+void BM_history_apply_undo_vector_edit(benchmark::State &state) {
+  Options options;
+  options.model.volume.opacity_map.assign(state.range(0), 0.5);
+  Options changed = options;
+  changed.model.volume.opacity_map[state.range(0) / 2] = 0.25;
+  options_ns::diff_history<Options, OptionsDiff> history;
+  const auto diff = OptionsIO::edit_diff(changed, options);
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    history.apply(options, diff);
+    history.undo(options);
+  }
+}
+BENCHMARK(BM_history_apply_undo_vector_edit)->Arg(64)->Arg(4096);
+
+void BM_non_default_mask(benchmark::State &state) {
+  Options options;
+  OptionsIO::apply(options, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::non_default_mask(options));
+}
+BENCHMARK(BM_non_default_mask);
+
+void BM_fingerprint(benchmark::State &state) {
+  Options options;
+  OptionsIO::apply(options, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::fingerprint(options));
+}
+BENCHMARK(BM_fingerprint);
+
+void BM_fingerprint_render(benchmark::State &state) {
+  Options options;
+  OptionsIO::apply(options, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        OptionsIO::fingerprint(options, OptionsIO::impact::render));
+}
+BENCHMARK(BM_fingerprint_render);
+
+/* what the fingerprint replaces as a cache key */
+void BM_fingerprint_as_json(benchmark::State &state) {
+  Options options;
+  OptionsIO::apply(options, samples_diff());
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    std::stringstream ss;
+    options_ns::write_json(ss, OptionsIO::diff(options, Options{}));
+    benchmark::DoNotOptimize(ss.str());
+  }
+}
+BENCHMARK(BM_fingerprint_as_json);
+
+void BM_reset_subtree(benchmark::State &state) {
+  Options options;
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::reset_subtree(options, "camera");
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_reset_subtree);
+
+void BM_apply(benchmark::State &state) {
+  Options options;
+  const auto diff = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::apply(options, diff);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_apply);
+
+void BM_apply_fingerprint(benchmark::State &state) {
+  Options options;
+  uint64_t fingerprint = OptionsIO::fingerprint(options);
+  const auto diff = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::apply(options, diff, fingerprint);
+    benchmark::DoNotOptimize(fingerprint);
+  }
+}
+BENCHMARK(BM_apply_fingerprint);
+
+void BM_set_fingerprint(benchmark::State &state) {
+  Options options;
+  uint64_t fingerprint = OptionsIO::fingerprint(options);
+  const auto id = OptionsIO::key_id(OptionsIO::keys.camera.view_angle);
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    OptionsIO::set(options, id, 33.5, fingerprint);
+    benchmark::DoNotOptimize(fingerprint);
+  }
+}
+BENCHMARK(BM_set_fingerprint);
+
+void BM_try_apply(benchmark::State &state) {
+  Options options;
+  const auto diff = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::try_apply(options, diff));
+}
+BENCHMARK(BM_try_apply);
+
+void BM_compose(benchmark::State &state) {
+  const auto first = options_ns::json_to_diff<OptionsDiff>(config);
+  const auto second = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::compose(first, second));
+}
+BENCHMARK(BM_compose);
+
+void BM_invert(benchmark::State &state) {
+  const Options options;
+  const auto diff = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::invert(diff, options));
+}
+BENCHMARK(BM_invert);
+
+void BM_history_apply_undo(benchmark::State &state) {
+  Options options;
+  options_ns::diff_history<Options, OptionsDiff> history;
+  const auto diff = samples_diff();
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    history.apply(options, diff);
+    history.undo(options);
+  }
+}
+BENCHMARK(BM_history_apply_undo);
+
+void BM_json_to_diff(benchmark::State &state) {
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(options_ns::json_to_diff<OptionsDiff>(config));
+  state.SetBytesProcessed(state.iterations() * config.size());
+}
+BENCHMARK(BM_json_to_diff);
+
+void BM_write_json(benchmark::State &state) {
+  const auto diff = options_ns::json_to_diff<OptionsDiff>(config);
+  std::string out;
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    out.clear();
+    options_ns::write_json(out, diff);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+BENCHMARK(BM_write_json);
+
+void BM_parse_cli(benchmark::State &state) {
+  const Options defaults;
+  count_allocations allocs(state);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(OptionsIO::parse_cli(
+        argv.size(), argv.data(), defaults, "<unset>", "<default>"));
+}
+BENCHMARK(BM_parse_cli);
+
+/* what an application does at startup: read its config and command line,
+  apply both, and keep the effective diff from defaults */
+void BM_startup(benchmark::State &state) {
+  const Options defaults;
+  count_allocations allocs(state);
+  for (auto _ : state) {
+    Options options;
+    const auto cfg = options_ns::json_to_diff<OptionsDiff>(config);
+    const auto cli = OptionsIO::parse_cli(argv.size(), argv.data(), defaults,
+                                          "<unset>", "<default>");
+    OptionsIO::apply(options, OptionsIO::compose(cfg, cli.diff));
+    benchmark::DoNotOptimize(OptionsIO::diff(options, defaults));
+  }
+}
+BENCHMARK(BM_startup);
+
+/* a cold process: launch `App --help` and wait for it, which adds loading,
+  static initialization and exit to what `BM_startup` measures */
+void BM_process_startup(benchmark::State &state) {
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+  char path[] = OPTIONS_APP_PATH, help[] = "--help";
+  char *args[] = {path, help, nullptr};
+  for (auto _ : state) {
+    pid_t pid;
+    int status = 0;
+    if (posix_spawn(&pid, path, &actions, nullptr, args, environ) != 0 ||
+        waitpid(pid, &status, 0) != pid || status != 0) {
+      state.SkipWithError("cannot run App");
+      break;
+    }
+  }
+  posix_spawn_file_actions_destroy(&actions);
+}
+BENCHMARK(BM_process_startup)->UseRealTime();
+
+/* readers of a snapshot while the first thread keeps publishing changes */
+void BM_snapshot_read(benchmark::State &state) {
+  static options_ns::snapshot_publisher<Options> publisher;
+  options_ns::snapshot_publisher<Options>::reader reader(publisher);
+  const auto diff = samples_diff();
+  size_t n = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0 && ++n % 1024 == 0)
+      publisher.apply(diff);
+    benchmark::DoNotOptimize(reader.read()->camera.view_angle);
+  }
+}
+BENCHMARK(BM_snapshot_read)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_colormap_lut_map(benchmark::State &state) {
+  const options_ns::colormap_lut lut(std::get<Colormap>(
+      OptionsIO::from_string(OptionsIO::keys.model.scivis.colormap, "viridis")));
+  std::vector<float> scalars(state.range(0));
+  for (size_t i = 0; i < scalars.size(); ++i)
+    scalars[i] = float(i % 1000) / 1000;
+  std::vector<uint8_t> rgba(4 * scalars.size());
+  for (auto _ : state) {
+    lut.map(scalars, {0.f, 1.f}, rgba, state.range(1));
+    benchmark::DoNotOptimize(rgba.data());
+  }
+  state.SetItemsProcessed(state.iterations() * scalars.size());
+}
+BENCHMARK(BM_colormap_lut_map)
+    ->ArgsProduct({{1 << 10, 1 << 20}, {1, 0}})
+    ->UseRealTime();
+
+/* the per-key benchmarks, one per value type */
+const bool registered = [] {
+  for (const auto &s : samples()) {
+    const std::string suffix = std::string("/") + s.type;
+    benchmark::RegisterBenchmark(("BM_key_id" + suffix).c_str(), BM_key_id,
+                                 s.key);
+    benchmark::RegisterBenchmark(("BM_get" + suffix).c_str(), BM_get, s.key);
+    benchmark::RegisterBenchmark(("BM_set" + suffix).c_str(), BM_set, s);
+    benchmark::RegisterBenchmark(("BM_from_string" + suffix).c_str(),
+                                 BM_from_string, s);
+    benchmark::RegisterBenchmark(("BM_try_from_string" + suffix).c_str(),
+                                 BM_try_from_string, s);
+    benchmark::RegisterBenchmark(("BM_from_json" + suffix).c_str(),
+                                 BM_from_json, s);
+    benchmark::RegisterBenchmark(("BM_to_string" + suffix).c_str(),
+                                 BM_to_string, s);
+    benchmark::RegisterBenchmark(("BM_to_json" + suffix).c_str(), BM_to_json,
+                                 s);
+  }
+  return true;
+}();
+
+} // namespace
+
+BENCHMARK_MAIN();
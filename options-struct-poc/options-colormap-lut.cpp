@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OPTIONS_LUT_AVX2
+#endif
+
+#include "options-colormap-lut.h"
+
+namespace options_ns {
+
+namespace {
+
+/* below this many scalars per thread, starting threads costs more than it
+  saves */
+constexpr size_t min_chunk = 1 << 16;
+
+/* the scalar and AVX2 kernels do the same float operations (no fused
+  multiply-add) so they give the same colors */
+void map_scalar(const float *scalars, size_t n, float low, float scale,
+                const uint32_t *table, uint8_t *rgba) {
+  constexpr float top = colormap_lut::size - 1;
+  for (size_t i = 0; i < n; ++i) {
+    float x = (scalars[i] - low) * scale;
+    x = std::min(std::max(0.f, x), top); /* NaN to 0 */
+    std::memcpy(rgba + 4 * i, &table[(int32_t)(x + 0.5f)], 4);
+  }
+}
+
+#ifdef OPTIONS_LUT_AVX2
+__attribute__((target("avx2"))) void
+map_avx2(const float *scalars, size_t n, float low, float scale,
+         const uint32_t *table, uint8_t *rgba) {
+  const __m256 low8 = _mm256_set1_ps(low);
+  const __m256 scale8 = _mm256_set1_ps(scale);
+  const __m256 zero8 = _mm256_setzero_ps();
+  const __m256 top8 = _mm256_set1_ps(colormap_lut::size - 1);
+  const __m256 half8 = _mm256_set1_ps(0.5f);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(scalars + i), low8),
+                             scale8);
+    /* `max` returns its second operand for NaN */
+    x = _mm256_min_ps(_mm256_max_ps(x, zero8), top8);
+    const __m256i index = _mm256_cvttps_epi32(_mm256_add_ps(x, half8));
+    const __m256i colors =
+        _mm256_i32gather_epi32((const int *)table, index, sizeof(uint32_t));
+    _mm256_storeu_si256((__m256i *)(rgba + 4 * i), colors);
+  }
+  map_scalar(scalars + i, n - i, low, scale, table, rgba + 4 * i);
+}
+
+bool has_avx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+#endif
+
+void map_chunk(const float *scalars, size_t n, float low, float scale,
+               const uint32_t *table, uint8_t *rgba) {
+#ifdef OPTIONS_LUT_AVX2
+  if (has_avx2())
+    return map_avx2(scalars, n, low, scale, table, rgba);
+#endif
+  map_scalar(scalars, n, low, scale, table, rgba);
+}
+
+uint8_t to_byte(double c) {
+  return (uint8_t)std::lround(std::clamp(c, 0., 1.) * 255);
+}
+
+} // namespace
+
+void colormap_lut::bake(const Colormap &cm) {
+  const auto &colors = cm.colors;
+  if (colors.empty())
+    throw std::invalid_argument("cannot bake an empty colormap");
+
+  const size_t last = colors.size() - 1;
+  for (size_t k = 0; k < size; ++k) {
+    const double t = (double)k / (size - 1) * last;
+    const size_t i = std::min((size_t)t, last);
+    const auto &c0 = colors[i];
+    const auto &c1 = colors[std::min(i + 1, last)];
+    const uint8_t bytes[4] = {
+        to_byte(c0[0] + (c1[0] - c0[0]) * (t - i)),
+        to_byte(c0[1] + (c1[1] - c0[1]) * (t - i)),
+        to_byte(c0[2] + (c1[2] - c0[2]) * (t - i)),
+        255,
+    };
+    std::memcpy(&table[k], bytes, sizeof(bytes));
+  }
+}
+
+void colormap_lut::map(std::span<const float> scalars,
+                       std::array<float, 2> range, std::span<uint8_t> rgba,
+                       unsigned threads) const {
+  if (rgba.size() < scalars.size() * 4)
+    throw std::invalid_argument("RGBA buffer too small");
+
+  const float low = range[0];
+  const float scale = range[1] != range[0] ? (size - 1) / (range[1] - range[0])
+                                           : 0.f;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t chunks =
+      std::clamp<size_t>(scalars.size() / min_chunk, 1, threads);
+  const size_t chunk_size = (scalars.size() + chunks - 1) / chunks;
+
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+  for (size_t c = 1; c < chunks; ++c) {
+    const size_t first = c * chunk_size;
+    const size_t n = std::min(chunk_size, scalars.size() - first);
+    workers.emplace_back(map_chunk, scalars.data() + first, n, low, scale,
+                         table.data(), rgba.data() + 4 * first);
+  }
+  map_chunk(scalars.data(), std::min(chunk_size, scalars.size()), low, scale,
+            table.data(), rgba.data());
+  for (auto &worker : workers)
+    worker.join();
+}
+
+std::array<uint8_t, 4> colormap_lut::entry(size_t i) const {
+  std::array<uint8_t, 4> bytes;
+  std::memcpy(bytes.data(), &table.at(i), sizeof(bytes));
+  return bytes;
+}
+
+} // namespace options_ns
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "options.h"
+
+namespace options_ns {
+
+/** Colormap baked into a lookup table of RGBA8 colors, for mapping large
+ * arrays of scalars.
+ * The table is baked once when the colormap changes, mapping a scalar is then
+ * a clamp, a scale, and a table load (8 at a time with AVX2, when the CPU
+ * supports it).
+ */
+class colormap_lut {
+public:
+  static constexpr size_t size = 1024;
+
+  colormap_lut()
+      : colormap_lut(Colormap{{Color{0, 0, 0}, Color{1, 1, 1}}, "grayscale"}) {}
+  explicit colormap_lut(const Colormap &cm) { bake(cm); }
+
+  /** Interpolate the colors of `cm` into the table.
+   * Throws `std::invalid_argument` if it has no colors.
+   */
+  void bake(const Colormap &cm);
+
+  /** Write the RGBA colors of `scalars` mapped from `range` (values outside
+   * being clamped, NaN mapping to the first color) to `rgba`, which must have
+   * 4 bytes per scalar.
+   * Large arrays are split into chunks mapped by `threads` threads (0 for the
+   * number of hardware threads).
+   */
+  void map(std::span<const float> scalars, std::array<float, 2> range,
+           std::span<uint8_t> rgba, unsigned threads = 0) const;
+
+  /** RGBA color of entry `i` of the table. */
+  std::array<uint8_t, 4> entry(size_t i) const;
+
+private:
+  /* RGBA8 packed in native byte order, to be loaded 4 bytes at a time */
+  alignas(64) std::array<uint32_t, size> table;
+};
+
+} // namespace options_ns
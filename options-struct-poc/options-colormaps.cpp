@@ -0,0 +1,222 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "options-colormaps.h"
+#include "options-io.h"
+
+namespace options_ns {
+
+namespace {
+
+constexpr Color rgb(uint32_t hex) {
+  return {((hex >> 16) & 0xff) / 255., ((hex >> 8) & 0xff) / 255.,
+          (hex & 0xff) / 255.};
+}
+
+/* evenly spaced samples of the matplotlib and Moreland palettes */
+constexpr std::array cividis = {
+    rgb(0x00224e), rgb(0x123570), rgb(0x3b496c), rgb(0x575d6d),
+    rgb(0x707173), rgb(0x8a8779), rgb(0xa69d75), rgb(0xc4b56c),
+    rgb(0xe4cf5b), rgb(0xfee838),
+};
+constexpr std::array coolwarm = {
+    rgb(0x3b4cc0),
+    rgb(0xdddddd),
+    rgb(0xb40426),
+};
+constexpr std::array frenchflag = {
+    rgb(0x0000ff),
+    rgb(0xffffff),
+    rgb(0xff0000),
+};
+constexpr std::array grayscale = {
+    rgb(0x000000),
+    rgb(0xffffff),
+};
+constexpr std::array inferno = {
+    rgb(0x000004), rgb(0x1b0c41), rgb(0x4a0c6b), rgb(0x781c6d),
+    rgb(0xa52c60), rgb(0xcf4446), rgb(0xed6925), rgb(0xfb9b06),
+    rgb(0xf7d13d), rgb(0xfcffa4),
+};
+constexpr std::array magma = {
+    rgb(0x000004), rgb(0x180f3d), rgb(0x440f76), rgb(0x721f81),
+    rgb(0x9e2f7f), rgb(0xcd4071), rgb(0xf1605d), rgb(0xfd9668),
+    rgb(0xfeca8d), rgb(0xfcfdbf),
+};
+constexpr std::array plasma = {
+    rgb(0x0d0887), rgb(0x46039f), rgb(0x7201a8), rgb(0x9c179e),
+    rgb(0xbd3786), rgb(0xd8576b), rgb(0xed7953), rgb(0xfb9f3a),
+    rgb(0xfdca26), rgb(0xf0f921),
+};
+constexpr std::array redblue = {
+    rgb(0xff0000),
+    rgb(0x0000ff),
+};
+constexpr std::array viridis = {
+    rgb(0x440154), rgb(0x482878), rgb(0x3e4989), rgb(0x31688e),
+    rgb(0x26828e), rgb(0x1f9e89), rgb(0x35b779), rgb(0x6ece58),
+    rgb(0xb5de2b), rgb(0xfde725),
+};
+
+struct palette {
+  std::string_view name;
+  const Color *colors;
+  size_t size;
+};
+
+/* sorted by name */
+constexpr palette palettes[] = {
+    {"cividis", cividis.data(), cividis.size()},
+    {"coolwarm", coolwarm.data(), coolwarm.size()},
+    {"frenchflag", frenchflag.data(), frenchflag.size()},
+    {"grayscale", grayscale.data(), grayscale.size()},
+    {"inferno", inferno.data(), inferno.size()},
+    {"magma", magma.data(), magma.size()},
+    {"plasma", plasma.data(), plasma.size()},
+    {"redblue", redblue.data(), redblue.size()},
+    {"viridis", viridis.data(), viridis.size()},
+};
+
+/* tables parsed from files, and from lists for as long as they are used */
+struct file_colors {
+  std::filesystem::file_time_type mtime;
+  ColorTable colors;
+};
+struct list_colors {
+  std::weak_ptr<const Color> colors;
+  size_t size;
+};
+
+std::mutex cache_mutex;
+std::map<std::string, file_colors, std::less<>> files;
+std::map<std::string, list_colors, std::less<>> lists;
+
+std::string_view trim(std::string_view s) {
+  const auto first = s.find_first_not_of(" \t\r");
+  if (first == s.npos)
+    return {};
+  return s.substr(first, s.find_last_not_of(" \t\r") + 1 - first);
+}
+
+expected<void> try_parse_color_list(std::string_view s,
+                                    std::vector<Color> &colors) {
+  for (size_t begin = 0, end; begin <= s.size(); begin = end + 1) {
+    end = std::min(s.find(',', begin), s.size());
+    auto color = try_parse_Color(std::string(s.substr(begin, end - begin)));
+    if (!color)
+      return unexpected(color.error());
+    colors.push_back(*color);
+  }
+  return {};
+}
+
+void parse_color_list(std::string_view s, std::vector<Color> &colors) {
+  try_parse_color_list(s, colors).value();
+}
+
+std::vector<Color> read_colors(std::istream &in, const std::string &path) {
+  std::vector<Color> colors;
+  std::string line;
+  for (size_t n = 1; std::getline(in, line); ++n) {
+    const auto s = trim(line);
+    if (s.empty())
+      continue;
+    try {
+      if (s[0] == '#')
+        parse_color_list(s, colors);
+      else
+        colors.push_back(parse_Color(std::string(s)));
+    } catch (std::invalid_argument &e) {
+      throw std::invalid_argument("cannot read colormap " + path + ":" +
+                                  std::to_string(n) + " (" + e.what() + ")");
+    }
+  }
+  if (colors.empty())
+    throw std::invalid_argument("no colors in colormap " + path);
+  return colors;
+}
+
+} // namespace
+
+std::vector<std::string_view> builtin_colormap_names() {
+  std::vector<std::string_view> names;
+  for (const auto &p : palettes)
+    names.push_back(p.name);
+  return names;
+}
+
+std::optional<Colormap> builtin_colormap(std::string_view name) {
+  const auto it = std::lower_bound(
+      std::begin(palettes), std::end(palettes), name,
+      [](const palette &p, std::string_view name) { return p.name < name; });
+  if (it == std::end(palettes) || it->name != name)
+    return std::nullopt;
+  /* aliasing an empty pointer, the static colors are not owned */
+  return Colormap{ColorTable(std::shared_ptr<const Color>(
+                                 std::shared_ptr<const Color>(), it->colors),
+                             it->size),
+                  std::string(name)};
+}
+
+Colormap load_colormap(const std::string &path) {
+  std::error_code error;
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  if (error)
+    throw std::invalid_argument("cannot read colormap " + path + " (" +
+                                error.message() + ")");
+
+  std::lock_guard lock(cache_mutex);
+  const auto it = files.find(path);
+  if (it != files.end() && it->second.mtime == mtime)
+    return {it->second.colors, path};
+
+  std::ifstream in(path);
+  if (!in)
+    throw std::invalid_argument("cannot read colormap " + path);
+  const ColorTable colors(read_colors(in, path));
+  files.insert_or_assign(path, file_colors{mtime, colors});
+  return {colors, path};
+}
+
+expected<Colormap> try_lookup_colormap(const std::string &value) {
+  if (auto cm = builtin_colormap(value))
+    return std::move(*cm);
+
+  std::error_code error;
+  if (std::filesystem::is_regular_file(value, error)) {
+    try {
+      return load_colormap(value);
+    } catch (std::invalid_argument &) {
+      return unexpected(conversion_error{conversion_errc::invalid_value,
+                                         "Colormap", "cannot read file"});
+    }
+  }
+
+  std::lock_guard lock(cache_mutex);
+  const auto it = lists.find(value);
+  if (it != lists.end())
+    if (auto colors = it->second.colors.lock())
+      return Colormap{ColorTable(std::move(colors), it->second.size), ""};
+
+  std::vector<Color> parsed;
+  if (auto ok = try_parse_color_list(value, parsed); !ok)
+    return unexpected(ok.error());
+  const ColorTable colors(std::move(parsed));
+  std::erase_if(lists, [](const auto &item) {
+    return item.second.colors.expired();
+  });
+  lists.insert_or_assign(value, list_colors{colors.shared(), colors.size()});
+  return Colormap{colors, ""};
+}
+
+Colormap lookup_colormap(const std::string &value) {
+  std::error_code error;
+  if (std::filesystem::is_regular_file(value, error))
+    return load_colormap(value);
+  return try_lookup_colormap(value).value();
+}
+
+} // namespace options_ns
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "options-expected.h"
+#include "options.h"
+
+namespace options_ns {
+
+/** Names of the built-in palettes, sorted. */
+std::vector<std::string_view> builtin_colormap_names();
+
+/** Built-in palette, its colors are static and never copied. */
+std::optional<Colormap> builtin_colormap(std::string_view name);
+
+/** Colormap read from a file listing colors, one per line as `#rrggbb` or
+ * number triples (`r,g,b` or `r g b`), or comma-separated `#rrggbb` lists.
+ * Files are only read again when their modification time changes.
+ * Throws `std::invalid_argument` if the file cannot be read or parsed.
+ */
+Colormap load_colormap(const std::string &path);
+
+/** Colormap from an option value: a built-in palette name, a file path, or a
+ * comma-separated list of colors.
+ * Equal values share the same color table for as long as it is in use.
+ */
+Colormap lookup_colormap(const std::string &value);
+
+/** `lookup_colormap` returning an error instead of throwing, the details of
+ * file errors are only available from `load_colormap`.
+ */
+expected<Colormap> try_lookup_colormap(const std::string &value);
+
+} // namespace options_ns
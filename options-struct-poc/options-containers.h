@@ -0,0 +1,551 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "options-expected.h"
+#include "options-io.h"
+
+namespace options_ns {
+
+/** Element-level edit of a vector, to carry a change to a large array in a
+ * diff without copying it.
+ * Runs are applied in order, each replacing `erase` elements at `pos` with
+ * `insert` (an insertion if `erase` is 0, an erasure if `insert` is empty).
+ */
+template <typename T> struct vector_edit {
+  typedef std::vector<T> vector_type;
+
+  struct run {
+    size_t pos;
+    size_t erase;
+    std::vector<T> insert;
+
+    bool operator==(const run &) const = default;
+  };
+  std::vector<run> runs;
+
+  /** Throws `std::out_of_range` if a run does not fit in `v`. */
+  void apply(std::vector<T> &v) const {
+    for (const auto &r : runs)
+      apply_run(v, r);
+  }
+
+  /** Edit reverting this one, applied to `base`. */
+  vector_edit inverse(const std::vector<T> &base) const {
+    vector_edit inv;
+    if (runs.size() == 1) {
+      inv.runs.push_back(inverse_run(base, runs.front()));
+      return inv;
+    }
+    /* each run is reverted from the state it was applied to */
+    std::vector<T> v = base;
+    for (const auto &r : runs) {
+      inv.runs.insert(inv.runs.begin(), inverse_run(v, r));
+      apply_run(v, r);
+    }
+    return inv;
+  }
+
+  /** Whether the runs fit in `v`, ie. `apply(v)` does not throw. */
+  bool fits(const std::vector<T> &v) const {
+    size_t n = v.size();
+    for (const auto &r : runs) {
+      if (r.pos > n || r.erase > n - r.pos)
+        return false;
+      n = n - r.erase + r.insert.size();
+    }
+    return true;
+  }
+
+  /** Number of elements carried. */
+  size_t size() const {
+    size_t n = 0;
+    for (const auto &r : runs)
+      n += r.insert.size();
+    return n;
+  }
+
+  bool operator==(const vector_edit &) const = default;
+
+private:
+  static void check(const std::vector<T> &v, const run &r) {
+    if (r.pos > v.size() || r.erase > v.size() - r.pos)
+      throw std::out_of_range("vector edit out of range");
+  }
+
+  static void apply_run(std::vector<T> &v, const run &r) {
+    check(v, r);
+    const auto first = v.begin() + r.pos;
+    const size_t common = std::min(r.erase, r.insert.size());
+    std::copy_n(r.insert.begin(), common, first);
+    if (r.erase > common)
+      v.erase(first + common, first + r.erase);
+    else
+      v.insert(first + common, r.insert.begin() + common, r.insert.end());
+  }
+
+  static run inverse_run(const std::vector<T> &v, const run &r) {
+    check(v, r);
+    const auto first = v.begin() + r.pos;
+    return {r.pos, r.insert.size(), {first, first + r.erase}};
+  }
+};
+
+template <typename T> struct is_vector_edit : std::false_type {};
+template <typename T>
+struct is_vector_edit<vector_edit<T>> : std::true_type {};
+
+namespace detail {
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+} // namespace detail
+
+/** Edit turning `from` into `to`: the changed elements between their common
+ * prefix and suffix, as runs of changed elements when sizes are equal.
+ */
+template <typename T>
+vector_edit<T> make_vector_edit(const std::vector<T> &from,
+                                const std::vector<T> &to) {
+  size_t prefix = 0;
+  while (prefix < from.size() && prefix < to.size() &&
+         from[prefix] == to[prefix])
+    ++prefix;
+  size_t suffix = 0;
+  while (suffix < from.size() - prefix && suffix < to.size() - prefix &&
+         from[from.size() - 1 - suffix] == to[to.size() - 1 - suffix])
+    ++suffix;
+
+  vector_edit<T> edit;
+  const size_t last = from.size() - suffix;
+  if (from.size() != to.size()) {
+    if (prefix < last || prefix < to.size() - suffix)
+      edit.runs.push_back({prefix, last - prefix,
+                           {to.begin() + prefix, to.end() - suffix}});
+    return edit;
+  }
+
+  /* a few equal elements cost less than a new run */
+  constexpr size_t min_gap = 4;
+  for (size_t i = prefix; i < last;) {
+    size_t end = i + 1, gap = 0;
+    for (size_t j = end; j < last && gap < min_gap; ++j)
+      if (from[j] != to[j])
+        end = j + 1, gap = 0;
+      else
+        ++gap;
+    edit.runs.push_back({i, end - i, {to.begin() + i, to.begin() + end}});
+    for (i = end; i < last && from[i] == to[i]; ++i)
+      ;
+  }
+  return edit;
+}
+
+/* the generic parts of the generated diff functions, `V` being the value
+  variant with a `vector_edit<T>` alternative for each `std::vector<T>` */
+
+/** Value of a field in an `edit_diff()`: an edit of `previous` for vectors
+ * when it carries less than half the elements, the current value otherwise.
+ */
+template <typename V, typename T>
+std::optional<V> diff_value(const T &current, const T &) {
+  return current;
+}
+template <typename V, typename T>
+std::optional<V> diff_value(const std::vector<T> &current,
+                            const std::vector<T> &previous) {
+  auto edit = make_vector_edit(previous, current);
+  if (2 * (edit.size() + edit.runs.size()) < current.size())
+    return V(std::move(edit));
+  return V(current);
+}
+template <typename V, typename T>
+std::optional<V> diff_value(const std::optional<std::vector<T>> &current,
+                            const std::optional<std::vector<T>> &previous) {
+  if (current && previous)
+    return diff_value<V>(*current, *previous);
+  return current;
+}
+
+/** Assign a value, or apply an edit, to a field. */
+template <typename T, typename V> void assign_value(T &field, const V &value) {
+  field = std::get<T>(value);
+}
+template <typename T, typename V>
+void assign_value(std::vector<T> &field, const V &value) {
+  if (const auto edit = std::get_if<vector_edit<T>>(&value))
+    edit->apply(field);
+  else
+    field = std::get<std::vector<T>>(value);
+}
+template <typename T, typename V>
+void assign_value(std::optional<T> &field, const V &value) {
+  if (!field)
+    field.emplace();
+  assign_value(*field, value);
+}
+
+/** Check that `assign_value(field, value)` would succeed: `value` holds the
+ * type of the field, and edits fit in it. `key` is the subject of the errors.
+ */
+template <typename T, typename V>
+expected<void> check_value(const T &, const V &value, std::string_view key) {
+  if (std::holds_alternative<T>(value))
+    return {};
+  return unexpected(conversion_error{conversion_errc::wrong_type,
+                                     std::string(key), "wrong value type"});
+}
+template <typename T, typename V>
+expected<void> check_value(const std::vector<T> &field, const V &value,
+                           std::string_view key) {
+  const auto edit = std::get_if<vector_edit<T>>(&value);
+  if (edit && !edit->fits(field))
+    return unexpected(conversion_error{conversion_errc::invalid_edit,
+                                       std::string(key),
+                                       "vector edit out of range"});
+  if (edit || std::holds_alternative<std::vector<T>>(value))
+    return {};
+  return unexpected(conversion_error{conversion_errc::wrong_type,
+                                     std::string(key), "wrong value type"});
+}
+template <typename T, typename V>
+expected<void> check_value(const std::optional<T> &field, const V &value,
+                           std::string_view key) {
+  return field ? check_value(*field, value, key) : check_value(T(), value, key);
+}
+
+/** `check_value` of a diff item, or check that `field` is optional if the
+ * item unsets it, for `try_apply()`.
+ */
+template <typename T, typename V>
+expected<void> check_change(const T &field, const std::optional<V> &value,
+                            std::string_view key) {
+  if (value)
+    return check_value(field, *value, key);
+  if constexpr (detail::is_optional<T>::value)
+    return {};
+  else
+    return unexpected(conversion_error{conversion_errc::non_optional_key,
+                                       std::string(key), {}});
+}
+
+/** Value equivalent to `first` followed by `second`, for `compose()`. */
+template <typename V>
+std::optional<V> compose_values(const std::optional<V> &first,
+                                const std::optional<V> &second) {
+  if (!second)
+    return second;
+  return std::visit(
+      [&](const auto &edit) -> std::optional<V> {
+        typedef std::decay_t<decltype(edit)> E;
+        if constexpr (is_vector_edit<E>::value) {
+          if (first)
+            if (const auto previous = std::get_if<E>(&*first)) {
+              E both = *previous;
+              both.runs.insert(both.runs.end(), edit.runs.begin(),
+                               edit.runs.end());
+              return V(std::move(both));
+            }
+          auto v = first ? std::get<typename E::vector_type>(*first)
+                         : typename E::vector_type();
+          edit.apply(v);
+          return V(std::move(v));
+        } else {
+          return second;
+        }
+      },
+      *second);
+}
+
+/** Value reverting `change` on a field whose value is `base`, for
+ * `invert()`.
+ */
+template <typename V>
+std::optional<V> invert_value(const std::optional<V> &change,
+                              std::optional<V> base) {
+  if (change && base)
+    if (auto inverse = std::visit(
+            [&](const auto &edit) -> std::optional<V> {
+              typedef std::decay_t<decltype(edit)> E;
+              if constexpr (is_vector_edit<E>::value)
+                return V(edit.inverse(
+                    std::get<typename E::vector_type>(*base)));
+              else
+                return std::nullopt;
+            },
+            *change))
+      return inverse;
+  return base;
+}
+
+/* string and json conversions of `std::vector<T>`, `std::pair<T, U>` and
+  `std::map<std::string, T>` of `std::string`, `int`, `double` or `bool`, as
+  `a,b,c`, `a,b` and `k1=v1,k2=v2` strings, json arrays and objects.
+  Elements must not contain `,` (nor `=` for map keys) in strings.
+  Edits are written for display (`[pos:end]=a,b` and `{"splice": [[pos,
+  erase, [a, b]]]}`), they are not parsed back: only `edit_diff()` makes
+  them, `diff()` holds values */
+
+namespace detail {
+
+inline expected<std::string> try_parse_element(const std::string &s,
+                                               std::string *) {
+  return try_parse_std_string(s);
+}
+inline expected<int> try_parse_element(const std::string &s, int *) {
+  return try_parse_int(s);
+}
+inline expected<double> try_parse_element(const std::string &s, double *) {
+  return try_parse_double(s);
+}
+inline expected<bool> try_parse_element(const std::string &s, bool *) {
+  return try_parse_bool(s);
+}
+
+inline expected<std::string> try_json_to_element(const json &j,
+                                                 std::string *) {
+  return try_json_to_std_string(j);
+}
+inline expected<int> try_json_to_element(const json &j, int *) {
+  return try_json_to_int(j);
+}
+inline expected<double> try_json_to_element(const json &j, double *) {
+  return try_json_to_double(j);
+}
+inline expected<bool> try_json_to_element(const json &j, bool *) {
+  return try_json_to_bool(j);
+}
+
+inline std::string format_element(const std::string &v) { return v; }
+inline std::string format_element(int v) { return format_int(v); }
+inline std::string format_element(double v) { return format_double(v); }
+inline std::string format_element(bool v) { return format_bool(v); }
+
+inline json element_to_json(const std::string &v) {
+  return std_string_to_json(v);
+}
+inline json element_to_json(int v) { return int_to_json(v); }
+inline json element_to_json(double v) { return double_to_json(v); }
+inline json element_to_json(bool v) { return bool_to_json(v); }
+
+template <typename T> expected<T> try_parse_as(std::string_view s) {
+  return try_parse_element(std::string(s), static_cast<T *>(nullptr));
+}
+template <typename T> expected<T> try_json_as(const json &j) {
+  return try_json_to_element(j, static_cast<T *>(nullptr));
+}
+
+/* call `f(part)` for the `sep`-separated parts of `s`, none if empty */
+template <typename F>
+expected<void> for_each_part(std::string_view s, char sep, F &&f) {
+  if (s.empty())
+    return {};
+  for (size_t begin = 0, end; begin <= s.size(); begin = end + 1) {
+    end = std::min(s.find(sep, begin), s.size());
+    if (auto ok = f(s.substr(begin, end - begin)); !ok)
+      return ok;
+  }
+  return {};
+}
+
+template <typename T> std::string format_elements(const std::vector<T> &v) {
+  std::string s;
+  for (const auto &x : v) {
+    if (!s.empty())
+      s += ',';
+    s += format_element(x);
+  }
+  return s;
+}
+
+template <typename T> json elements_to_json(const std::vector<T> &v) {
+  json j = json::array();
+  for (const auto &x : v)
+    j.push_back(element_to_json(x));
+  return j;
+}
+
+} // namespace detail
+
+template <typename T>
+expected<std::vector<T>> try_parse_std_vector(const std::string &s) {
+  std::vector<T> v;
+  auto ok = detail::for_each_part(s, ',', [&](std::string_view part) {
+    auto x = detail::try_parse_as<T>(part);
+    if (!x)
+      return expected<void>(unexpected(x.error()));
+    v.push_back(std::move(*x));
+    return expected<void>();
+  });
+  if (!ok)
+    return unexpected(ok.error());
+  return v;
+}
+template <typename T>
+std::vector<T> parse_std_vector(const std::string &s) {
+  return try_parse_std_vector<T>(s).value();
+}
+template <typename T> std::string format_std_vector(const std::vector<T> &v) {
+  return detail::format_elements(v);
+}
+template <typename T> std::string format_std_vector(const vector_edit<T> &e) {
+  std::string s;
+  for (const auto &r : e.runs) {
+    if (!s.empty())
+      s += "; ";
+    s += "[" + std::to_string(r.pos) + ":" + std::to_string(r.pos + r.erase) +
+         "]=" + detail::format_elements(r.insert);
+  }
+  return s;
+}
+
+template <typename T>
+expected<std::vector<T>> try_json_to_std_vector(const json &j) {
+  if (j.is_string())
+    return try_parse_std_vector<T>(j.get<std::string>());
+  if (!j.is_array())
+    return unexpected(conversion_error{conversion_errc::invalid_value,
+                                       "std::vector", "not an array"});
+  std::vector<T> v;
+  v.reserve(j.size());
+  for (const auto &item : j) {
+    auto x = detail::try_json_as<T>(item);
+    if (!x)
+      return unexpected(x.error());
+    v.push_back(std::move(*x));
+  }
+  return v;
+}
+template <typename T> std::vector<T> json_to_std_vector(const json &j) {
+  return try_json_to_std_vector<T>(j).value();
+}
+template <typename T> json std_vector_to_json(const std::vector<T> &v) {
+  return detail::elements_to_json(v);
+}
+template <typename T> json std_vector_to_json(const vector_edit<T> &e) {
+  json runs = json::array();
+  for (const auto &r : e.runs)
+    runs.push_back({r.pos, r.erase, detail::elements_to_json(r.insert)});
+  return {{"splice", std::move(runs)}};
+}
+
+template <typename T, typename U>
+expected<std::pair<T, U>> try_parse_std_pair(const std::string &s) {
+  const auto sep = s.find(',');
+  if (sep == s.npos)
+    return unexpected(conversion_error{conversion_errc::invalid_value,
+                                       "std::pair", "not a pair"});
+  auto first = detail::try_parse_as<T>(std::string_view(s).substr(0, sep));
+  if (!first)
+    return unexpected(first.error());
+  auto second = detail::try_parse_as<U>(std::string_view(s).substr(sep + 1));
+  if (!second)
+    return unexpected(second.error());
+  return std::pair<T, U>(std::move(*first), std::move(*second));
+}
+template <typename T, typename U>
+std::pair<T, U> parse_std_pair(const std::string &s) {
+  return try_parse_std_pair<T, U>(s).value();
+}
+template <typename T, typename U>
+std::string format_std_pair(const std::pair<T, U> &p) {
+  return detail::format_element(p.first) + "," +
+         detail::format_element(p.second);
+}
+
+template <typename T, typename U>
+expected<std::pair<T, U>> try_json_to_std_pair(const json &j) {
+  if (j.is_string())
+    return try_parse_std_pair<T, U>(j.get<std::string>());
+  if (!j.is_array() || j.size() != 2)
+    return unexpected(conversion_error{conversion_errc::invalid_value,
+                                       "std::pair", "not a pair"});
+  auto first = detail::try_json_as<T>(j[0]);
+  if (!first)
+    return unexpected(first.error());
+  auto second = detail::try_json_as<U>(j[1]);
+  if (!second)
+    return unexpected(second.error());
+  return std::pair<T, U>(std::move(*first), std::move(*second));
+}
+template <typename T, typename U>
+std::pair<T, U> json_to_std_pair(const json &j) {
+  return try_json_to_std_pair<T, U>(j).value();
+}
+template <typename T, typename U>
+json std_pair_to_json(const std::pair<T, U> &p) {
+  return {detail::element_to_json(p.first), detail::element_to_json(p.second)};
+}
+
+template <typename K, typename T>
+expected<std::map<K, T>> try_parse_std_map(const std::string &s) {
+  static_assert(std::is_same_v<K, std::string>, "map keys must be strings");
+  std::map<K, T> m;
+  auto ok = detail::for_each_part(s, ',', [&](std::string_view part) {
+    const auto sep = part.find('=');
+    if (sep == part.npos)
+      return expected<void>(unexpected(conversion_error{
+          conversion_errc::invalid_value, "std::map", "not a key=value list"}));
+    auto x = detail::try_parse_as<T>(part.substr(sep + 1));
+    if (!x)
+      return expected<void>(unexpected(x.error()));
+    m.insert_or_assign(std::string(part.substr(0, sep)), std::move(*x));
+    return expected<void>();
+  });
+  if (!ok)
+    return unexpected(ok.error());
+  return m;
+}
+template <typename K, typename T>
+std::map<K, T> parse_std_map(const std::string &s) {
+  return try_parse_std_map<K, T>(s).value();
+}
+template <typename K, typename T>
+std::string format_std_map(const std::map<K, T> &m) {
+  std::string s;
+  for (const auto &[k, v] : m) {
+    if (!s.empty())
+      s += ',';
+    s += k + "=" + detail::format_element(v);
+  }
+  return s;
+}
+
+template <typename K, typename T>
+expected<std::map<K, T>> try_json_to_std_map(const json &j) {
+  static_assert(std::is_same_v<K, std::string>, "map keys must be strings");
+  if (j.is_string())
+    return try_parse_std_map<K, T>(j.get<std::string>());
+  if (!j.is_object())
+    return unexpected(conversion_error{conversion_errc::invalid_value,
+                                       "std::map", "not an object"});
+  std::map<K, T> m;
+  for (const auto &[k, item] : j.items()) {
+    auto x = detail::try_json_as<T>(item);
+    if (!x)
+      return unexpected(x.error());
+    m.emplace(k, std::move(*x));
+  }
+  return m;
+}
+template <typename K, typename T>
+std::map<K, T> json_to_std_map(const json &j) {
+  return try_json_to_std_map<K, T>(j).value();
+}
+template <typename K, typename T>
+json std_map_to_json(const std::map<K, T> &m) {
+  json j = json::object();
+  for (const auto &[k, v] : m)
+    j[k] = detail::element_to_json(v);
+  return j;
+}
+
+} // namespace options_ns
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace options_ns::detail {
+
+/* `apply()`/`invert()`/`compose()` are the generated functions from the
+  namespace of the diff type, found by ADL */
+template <typename S, typename Diff> void apply_diff(S &s, const Diff &diff) {
+  apply(s, diff);
+}
+template <typename S, typename Diff>
+Diff invert_diff(const Diff &diff, const S &base) {
+  return invert(diff, base);
+}
+template <typename Diff>
+Diff compose_diffs(const Diff &first, const Diff &second) {
+  return compose(first, second);
+}
+
+/* `from_json()`/`to_json()` are the generated functions from the namespace of
+  the key id */
+template <typename KeyId, typename Json>
+auto from_json_value(KeyId id, const Json &value) {
+  return from_json(id, value);
+}
+template <typename KeyId, typename V>
+auto to_json_value(KeyId id, const V &value) {
+  return to_json(id, value);
+}
+
+} // namespace options_ns::detail
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace options_ns {
+
+enum class conversion_errc : uint8_t {
+  invalid_value = 1,
+  out_of_range,
+  invalid_key,
+  non_optional_key,
+  wrong_type,
+  invalid_edit,
+};
+
+/** Error of a conversion.
+ * `subject` is the type of the value (or the key, for key errors), owned so
+ * that errors about keys outlive the caller's string; type names fit in the
+ * small string buffer and do not allocate. `what` is the cause, a static
+ * string.
+ */
+struct conversion_error {
+  conversion_errc code = conversion_errc::invalid_value;
+  std::string subject;
+  std::string_view what;
+
+  std::string message() const {
+    switch (code) {
+    case conversion_errc::invalid_key:
+      return "invalid key: " + subject;
+    case conversion_errc::non_optional_key:
+      return "non-optional key: " + subject;
+    case conversion_errc::wrong_type:
+      return "wrong value type for key: " + subject;
+    case conversion_errc::invalid_edit:
+      return "invalid edit of key: " + subject + " (" +
+             std::string(what) + ")";
+    default:
+      return "cannot parse " + subject + " (" + std::string(what) + ")";
+    }
+  }
+
+  /** Throw the exception of the throwing API for this error. */
+  [[noreturn]] void raise() const {
+    if (code == conversion_errc::invalid_value ||
+        code == conversion_errc::wrong_type)
+      throw std::invalid_argument(message());
+    throw std::out_of_range(message());
+  }
+
+  bool operator==(const conversion_error &) const = default;
+};
+
+template <typename E> struct unexpected {
+  E error;
+};
+template <typename E> unexpected(E) -> unexpected<E>;
+
+/** Value or error, a subset of C++23 `std::expected<T, conversion_error>`
+ * whose `value()` raises the error.
+ */
+template <typename T, typename E = conversion_error> class expected {
+public:
+  typedef T value_type;
+  typedef E error_type;
+
+  expected() : v(std::in_place_index<0>) {}
+  expected(T value) : v(std::in_place_index<0>, std::move(value)) {}
+  expected(unexpected<E> e) : v(std::in_place_index<1>, std::move(e.error)) {}
+  template <typename U>
+    requires(!std::is_same_v<T, U> && std::is_constructible_v<T, U &&>)
+  expected(expected<U, E> other)
+      : v(other ? std::variant<T, E>(std::in_place_index<0>, std::move(*other))
+                : std::variant<T, E>(std::in_place_index<1>, other.error())) {}
+
+  bool has_value() const noexcept { return v.index() == 0; }
+  explicit operator bool() const noexcept { return has_value(); }
+
+  T &operator*() & { return *std::get_if<0>(&v); }
+  const T &operator*() const & { return *std::get_if<0>(&v); }
+  T &&operator*() && { return std::move(*std::get_if<0>(&v)); }
+  T *operator->() { return std::get_if<0>(&v); }
+  const T *operator->() const { return std::get_if<0>(&v); }
+
+  T &value() & {
+    if (!has_value())
+      error().raise();
+    return **this;
+  }
+  const T &value() const & {
+    if (!has_value())
+      error().raise();
+    return **this;
+  }
+  T &&value() && { return std::move(value()); }
+
+  template <typename U> T value_or(U &&other) const & {
+    return has_value() ? **this : T(std::forward<U>(other));
+  }
+
+  const E &error() const { return *std::get_if<1>(&v); }
+
+private:
+  std::variant<T, E> v;
+};
+
+template <typename E> class expected<void, E> {
+public:
+  typedef void value_type;
+  typedef E error_type;
+
+  expected() = default;
+  expected(unexpected<E> e) : e(std::move(e.error)), failed(true) {}
+
+  bool has_value() const noexcept { return !failed; }
+  explicit operator bool() const noexcept { return has_value(); }
+
+  void value() const {
+    if (failed)
+      e.raise();
+  }
+
+  const E &error() const { return e; }
+
+private:
+  E e;
+  bool failed = false;
+};
+
+} // namespace options_ns
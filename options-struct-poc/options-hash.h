@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "options.h"
+
+namespace options_ns {
+
+/* Canonical 64 bits hashes of option values, for fingerprinting instances.
+  Values are hashed by what they compare equal on rather than by how they
+  are formatted, and do not depend on the platform or on the run, so that
+  fingerprints can key persistent caches.
+  `hash_append()` overloads feed the words of a value to a running state,
+  one multiply each, and `hash_value()` finalizes the state once. */
+
+/** 64 bits FNV-1a. */
+constexpr uint64_t hash_bytes(std::string_view bytes,
+                              uint64_t h = 0xCBF29CE484222325) {
+  for (const char c : bytes)
+    h = (h ^ static_cast<uint8_t>(c)) * 0x100000001B3;
+  return h;
+}
+
+/** splitmix64 finalizer, spreads every input bit over the output. */
+constexpr uint64_t hash_mix(uint64_t h) {
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EB;
+  return h ^ (h >> 31);
+}
+
+constexpr void hash_append_word(uint64_t &h, uint64_t word) {
+  h = (std::rotl(h, 5) ^ word) * 0x517CC1B727220A95;
+}
+
+template <typename T>
+  requires std::is_integral_v<T>
+constexpr void hash_append(uint64_t &h, T x) {
+  hash_append_word(h, static_cast<uint64_t>(static_cast<int64_t>(x)));
+}
+
+/* -0.0 hashes as 0.0 and all NaNs alike */
+inline void hash_append(uint64_t &h, double x) {
+  if (x == 0.0)
+    x = 0.0;
+  else if (std::isnan(x))
+    x = std::numeric_limits<double>::quiet_NaN();
+  hash_append_word(h, std::bit_cast<uint64_t>(x));
+}
+
+inline void hash_append(uint64_t &h, const std::string &s) {
+  hash_append_word(h, hash_bytes(s));
+}
+
+template <typename T> void hash_append(uint64_t &h, const std::optional<T> &o);
+template <typename T, typename U>
+void hash_append(uint64_t &h, const std::pair<T, U> &p);
+template <typename T, size_t N>
+void hash_append(uint64_t &h, const std::array<T, N> &a);
+template <typename T> void hash_append(uint64_t &h, const std::vector<T> &v);
+template <typename K, typename T>
+void hash_append(uint64_t &h, const std::map<K, T> &m);
+
+namespace detail {
+/* prefixed by the size so that nested sequences cannot alias */
+template <typename It>
+void hash_append_range(uint64_t &h, It first, It last, size_t size) {
+  hash_append_word(h, size);
+  for (; first != last; ++first)
+    hash_append(h, *first);
+}
+} // namespace detail
+
+template <typename T> void hash_append(uint64_t &h, const std::optional<T> &o) {
+  hash_append_word(h, o.has_value());
+  if (o.has_value())
+    hash_append(h, *o);
+}
+
+template <typename T, typename U>
+void hash_append(uint64_t &h, const std::pair<T, U> &p) {
+  hash_append(h, p.first);
+  hash_append(h, p.second);
+}
+
+template <typename T, size_t N>
+void hash_append(uint64_t &h, const std::array<T, N> &a) {
+  for (const auto &x : a)
+    hash_append(h, x);
+}
+
+template <typename T> void hash_append(uint64_t &h, const std::vector<T> &v) {
+  detail::hash_append_range(h, v.begin(), v.end(), v.size());
+}
+
+/* items are visited in key order, independent of insertion order */
+template <typename K, typename T>
+void hash_append(uint64_t &h, const std::map<K, T> &m) {
+  detail::hash_append_range(h, m.begin(), m.end(), m.size());
+}
+
+inline void hash_append(uint64_t &h, const ColorTable &t) {
+  detail::hash_append_range(h, t.begin(), t.end(), t.size());
+}
+
+/* the name is not part of the value, see `Colormap_t::operator==` */
+inline void hash_append(uint64_t &h, const Colormap &c) {
+  hash_append(h, c.colors);
+}
+
+/** Hash of a value, `seed` distinguishes values of different origins. */
+template <typename T> uint64_t hash_value(const T &value, uint64_t seed = 0) {
+  hash_append(seed, value);
+  return hash_mix(seed);
+}
+
+/** Hash of a field for fingerprints, `seed` is the hash of its key so that
+ * the fields of an instance can be XOR-ed together. */
+template <typename T> uint64_t field_hash(uint64_t seed, const T &value) {
+  return hash_value(value, seed);
+}
+
+} // namespace options_ns
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "options-containers.h"
+#include "options-detail.h"
+#include "options.h"
+
+namespace options_ns {
+
+/* approximate heap memory owned by option values */
+template <typename T> size_t heap_size(const T &) { return 0; }
+
+inline size_t heap_size(const std::string &s) {
+  const auto object = reinterpret_cast<const char *>(&s);
+  const bool small = s.data() >= object && s.data() < object + sizeof(s);
+  return small ? 0 : s.capacity() + 1;
+}
+
+/* color tables are shared, count them as if they were not */
+inline size_t heap_size(const Colormap &cm) {
+  return cm.colors.size() * sizeof(Color) + heap_size(cm.name);
+}
+
+template <typename T> size_t heap_size(const std::vector<T> &v) {
+  size_t n = v.capacity() * sizeof(T);
+  for (const auto &x : v)
+    n += heap_size(x);
+  return n;
+}
+
+template <typename T, typename U>
+size_t heap_size(const std::pair<T, U> &p) {
+  return heap_size(p.first) + heap_size(p.second);
+}
+
+/* red-black tree nodes hold 4 words besides the item */
+template <typename K, typename T> size_t heap_size(const std::map<K, T> &m) {
+  size_t n = m.size() * (sizeof(std::pair<const K, T>) + 4 * sizeof(void *));
+  for (const auto &[k, v] : m)
+    n += heap_size(k) + heap_size(v);
+  return n;
+}
+
+template <typename T> size_t heap_size(const vector_edit<T> &e) {
+  size_t n = e.runs.capacity() * sizeof(typename vector_edit<T>::run);
+  for (const auto &r : e.runs)
+    n += heap_size(r.insert);
+  return n;
+}
+
+template <typename T> size_t heap_size(const std::optional<T> &o) {
+  return o.has_value() ? heap_size(o.value()) : 0;
+}
+
+template <typename... Ts> size_t heap_size(const std::variant<Ts...> &v) {
+  return std::visit([](const auto &x) { return heap_size(x); }, v);
+}
+
+/** Undo/redo history of the diffs applied to an instance.
+ * Only the diffs reverting each change are kept, the oldest ones being
+ * dropped when their total size exceeds `max_bytes`.
+ * Consecutive changes of the same keys within `coalesce_window` are recorded
+ * as a single step.
+ * Diffs from the generated `edit_diff()` keep the reverting changes of
+ * vectors as `vector_edit`s rather than copies.
+ */
+template <typename S, typename Diff> class diff_history {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  explicit diff_history(
+      size_t max_bytes = 1 << 20,
+      clock::duration coalesce_window = std::chrono::milliseconds(500))
+      : max_bytes(max_bytes), coalesce_window(coalesce_window) {}
+
+  /** Apply a diff to an instance and record how to revert it. */
+  void apply(S &s, const Diff &diff, clock::time_point now = clock::now()) {
+    if (diff.empty())
+      return;
+
+    Diff inverse = detail::invert_diff(diff, s);
+    detail::apply_diff(s, diff);
+
+    clear(redos);
+    if (coalescing && !undos.empty() &&
+        now - undos.back().time <= coalesce_window &&
+        same_keys(undos.back().diff, diff)) {
+      /* revert this change then the previous ones: the values of a key
+        are those before the sequence, but `vector_edit`s are relative to
+        the state they apply to and must be kept in order */
+      entry &last = undos.back();
+      bytes -= last.bytes;
+      last.diff = detail::compose_diffs(inverse, last.diff);
+      last.bytes = diff_bytes(last.diff);
+      last.time = now;
+      bytes += last.bytes;
+    } else {
+      push(undos, std::move(inverse), now);
+    }
+    coalescing = true;
+    trim();
+  }
+
+  /** Revert the last recorded change, returns false if there is none. */
+  bool undo(S &s) { return move(s, undos, redos); }
+
+  /** Re-apply the last reverted change, returns false if there is none. */
+  bool redo(S &s) { return move(s, redos, undos); }
+
+  bool can_undo() const { return !undos.empty(); }
+  bool can_redo() const { return !redos.empty(); }
+  size_t undo_count() const { return undos.size(); }
+  size_t redo_count() const { return redos.size(); }
+
+  /** Approximate memory used by the recorded diffs, in bytes. */
+  size_t memory_usage() const { return bytes; }
+
+  void clear() {
+    clear(undos);
+    clear(redos);
+  }
+
+private:
+  struct entry {
+    Diff diff;
+    clock::time_point time;
+    size_t bytes;
+  };
+
+  size_t max_bytes;
+  clock::duration coalesce_window;
+  std::deque<entry> undos;
+  std::deque<entry> redos;
+  size_t bytes = 0;
+  bool coalescing = false;
+
+  static size_t diff_bytes(const Diff &diff) {
+    size_t n = sizeof(entry) + diff.size() * sizeof(typename Diff::value_type);
+    for (const auto &[_key, value] : diff)
+      n += heap_size(value);
+    return n;
+  }
+
+  static bool same_keys(const Diff &a, const Diff &b) {
+    if (a.size() != b.size())
+      return false;
+    for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+      if (i->first != j->first)
+        return false;
+    return true;
+  }
+
+  void push(std::deque<entry> &stack, Diff &&diff, clock::time_point time) {
+    const size_t n = diff_bytes(diff);
+    stack.push_back({std::move(diff), time, n});
+    bytes += n;
+  }
+
+  void pop(std::deque<entry> &stack, bool oldest = false) {
+    bytes -= oldest ? stack.front().bytes : stack.back().bytes;
+    if (oldest)
+      stack.pop_front();
+    else
+      stack.pop_back();
+  }
+
+  void clear(std::deque<entry> &stack) {
+    while (!stack.empty())
+      pop(stack);
+  }
+
+  void trim() {
+    while (bytes > max_bytes && !undos.empty())
+      pop(undos, true);
+    while (bytes > max_bytes && !redos.empty())
+      pop(redos, true);
+  }
+
+  bool move(S &s, std::deque<entry> &from, std::deque<entry> &to) {
+    if (from.empty())
+      return false;
+
+    const Diff diff = std::move(from.back().diff);
+    pop(from);
+    push(to, detail::invert_diff(diff, s), clock::now());
+    detail::apply_diff(s, diff);
+    coalescing = false;
+    trim();
+    return true;
+  }
+};
+
+} // namespace options_ns
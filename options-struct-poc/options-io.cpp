@@ -1,276 +1,469 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cmath>
-#include <iomanip>
-#include <iostream>
-#include <regex>
-#include <stdio.h>
-#include <stdlib.h>
+#include <string_view>
 
+#include "options-colormaps.h"
 #include "options-io.h"
 #include "options.h"
 
 namespace options_ns {
 
+namespace {
+
+/* sequential writes into a caller-provided buffer, the buffer is left
+  unspecified once too small */
+class chars_writer {
+public:
+  chars_writer(char *first, char *last) : first(first), last(last) {}
+
+  void put(char c) {
+    if (first == last)
+      full = true;
+    if (!full)
+      *first++ = c;
+  }
+
+  template <typename T> void put_number(T v) {
+    if (full)
+      return;
+    const auto [ptr, ec] = std::to_chars(first, last, v);
+    if (ec != std::errc())
+      full = true;
+    else
+      first = ptr;
+  }
+
+  std::to_chars_result result() const {
+    if (full)
+      return {last, std::errc::value_too_large};
+    return {first, std::errc()};
+  }
+
+private:
+  char *first;
+  char *last;
+  bool full = false;
+};
+
+/* string-returning version of a buffer formatter */
+template <typename T>
+std::string format_to_string(
+    std::to_chars_result (*format)(char *, char *, const T &), const T &v) {
+  char buffer[format_buffer_size];
+  const auto [ptr, ec] = format(buffer, buffer + sizeof(buffer), v);
+  return std::string(buffer, ptr);
+}
+
+conversion_error invalid(std::string_view subject, std::string_view what) {
+  return {conversion_errc::invalid_value, std::string(subject), what};
+}
+
+} // namespace
+
+expected<std::string> try_parse_std_string(const std::string &s) { return s; }
 std::string parse_std_string(const std::string &s) { return s; }
 std::string format_std_string(const std::string &v) { return v; }
 
-int parse_int(const std::string &s) { return std::stoi(s); }
-std::string format_int(const int &v) {
-  std::stringstream stream;
-  stream << v;
-  return stream.str();
+int parse_int(const std::string &s) { return try_parse_int(s).value(); }
+std::to_chars_result format_int(char *first, char *last, const int &v) {
+  return std::to_chars(first, last, v);
 }
+std::string format_int(const int &v) { return format_to_string(format_int, v); }
 
-double parse_double(const std::string &s) { return std::stod(s); }
+double parse_double(const std::string &s) {
+  return try_parse_double(s).value();
+}
+std::to_chars_result format_double(char *first, char *last,
+                                   const double &v) {
+  return std::to_chars(first, last, v);
+}
 std::string format_double(const double &v) {
-  std::stringstream stream;
-  stream << v;
-  return stream.str();
+  return format_to_string(format_double, v);
 }
 
-bool parse_bool(const std::string &s) {
+expected<bool> try_parse_bool(const std::string &s) {
   if (s == "true" || s == "yes" || s == "y" || s == "on" || s == "1")
     return true;
   else if (s == "false" || s == "no" || s == "n" || s == "off" || s == "0")
     return false;
   else
-    throw std::invalid_argument("cannot parse boolean: " + s);
+    return unexpected(invalid("bool", "not a boolean"));
 }
+bool parse_bool(const std::string &s) { return try_parse_bool(s).value(); }
 std::string format_bool(const bool &boolean) {
   return boolean ? "true" : "false";
 }
 
-const std::string re_lbrackets = "[\\[\\{\\(]";
-const std::string re_rbrackets = "[\\]\\}\\)]";
-const std::string re_number =
-    "[+-]?(?:\\d+(?:[.]\\d*)?(?:[eE][+-]?\\d+)?|[.]\\d+(?:[eE][+-]?\\d+)?)";
-const std::string re_array3double =
-    "(" + re_lbrackets + ")?\\s*(" + re_number + ")\\s*,?\\s*(" + re_number +
-    ")\\s*,?\\s*(" + re_number + ")\\s*(" + re_rbrackets + ")?";
-
-std::array<double, 3> _parse_array_double3(const std::string &s) {
-  const std::regex pattern(re_array3double, std::regex_constants::icase);
-
-  std::smatch match;
-  if (std::regex_match(s, match, pattern)) {
-    if ((match[1] == "(" and match[5] != ")") ||
-        (match[1] == "[" and match[5] != "]") ||
-        (match[1] == "{" and match[5] != "}") ||
-        (match[1] == "" and match[5] != ""))
-      throw std::invalid_argument("mismatched brackets");
-    return {std::stod(match[2]), std::stod(match[3]), std::stod(match[4])};
-  }
-  throw std::invalid_argument("not a number triple");
+namespace {
+
+/* hand-written scanners for the grammars:
+  - number: `[+-]?(?:\d+(?:[.]\d*)?(?:[eE][+-]?\d+)?|[.]\d+(?:[eE][+-]?\d+)?)`
+  - triple:
+    `([\[\{\(])?\s*(number)\s*,?\s*(number)\s*,?\s*(number)\s*([\]\}\)])?`
+  - axes: `(([+-]?)(x))?(([+-]?)(y))?(([+-]?)(z))?` (case insensitive)
+  numbers are not delimited in a triple (`123` is `1, 2, 3`), so the possible
+  ends of each number are tried longest first, the same order as the
+  backtracking of a regex matcher */
+
+bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
 }
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
 
-Vector3 parse_Vector3(const std::string &s) {
-  const std::regex pattern("(([+-]?)(x))?(([+-]?)(y))?(([+-]?)(z))?",
-                           std::regex_constants::icase);
-  std::smatch match;
-  if (std::regex_match(s, match, pattern)) {
-    int sign = 1;
-    if (match[2] == "-")
-      sign = -1;
-    else if (match[2] == "+")
-      sign = +1;
+size_t skip_spaces(std::string_view s, size_t i) {
+  while (i < s.size() && is_space(s[i]))
+    ++i;
+  return i;
+}
+size_t skip_digits(std::string_view s, size_t i) {
+  while (i < s.size() && is_digit(s[i]))
+    ++i;
+  return i;
+}
 
-    double x = match[3] == "" ? 0 : sign;
+/* call `f(end)` for the possible ends of an exponent starting at `i`, longest
+  first, then for `i` itself (no exponent), until `f` returns true */
+template <typename F> bool exponent_ends(std::string_view s, size_t i, F &&f) {
+  if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+    size_t j = i + 1;
+    if (j < s.size() && (s[j] == '+' || s[j] == '-'))
+      ++j;
+    for (size_t end = skip_digits(s, j); end > j; --end)
+      if (f(end))
+        return true;
+  }
+  return f(i);
+}
 
-    if (match[5] == "-")
-      sign = -1;
-    else if (match[5] == "+")
-      sign = +1;
+/* call `f(end)` for the possible ends of a number starting at `i`, longest
+  first, until `f` returns true */
+template <typename F> bool number_ends(std::string_view s, size_t i, F &&f) {
+  if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+    ++i;
+  if (i < s.size() && is_digit(s[i])) {
+    const size_t digits_end = skip_digits(s, i);
+    if (digits_end < s.size() && s[digits_end] == '.')
+      for (size_t end = skip_digits(s, digits_end + 1); end > digits_end; --end)
+        if (exponent_ends(s, end, f))
+          return true;
+    for (size_t end = digits_end; end > i; --end)
+      if (exponent_ends(s, end, f))
+        return true;
+  } else if (i + 1 < s.size() && s[i] == '.' && is_digit(s[i + 1])) {
+    for (size_t end = skip_digits(s, i + 1); end > i + 1; --end)
+      if (exponent_ends(s, end, f))
+        return true;
+  }
+  return false;
+}
 
-    double y = match[6] == "" ? 0 : sign;
+/* the whole of `s` but surrounding spaces as a number */
+template <typename T>
+expected<T> to_number(std::string_view s, std::string_view subject) {
+  size_t last = s.size();
+  while (last > 0 && is_space(s[last - 1]))
+    --last;
+  s = s.substr(0, last).substr(std::min(skip_spaces(s, 0), last));
+  if (s.size() > 1 && s[0] == '+' && s[1] != '-' && s[1] != '+')
+    s.remove_prefix(1);
+  T value = 0;
+  const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  if (ec == std::errc::result_out_of_range)
+    return unexpected(conversion_error{conversion_errc::out_of_range,
+                                       std::string(subject),
+                                       "number out of range"});
+  if (ec != std::errc() || end != s.data() + s.size())
+    return unexpected(invalid(subject, "not a number"));
+  return value;
+}
 
-    if (match[8] == "-")
-      sign = -1;
-    else if (match[8] == "+")
-      sign = +1;
+bool is_lbracket(char c) { return c == '(' || c == '[' || c == '{'; }
+bool is_rbracket(char c) { return c == ')' || c == ']' || c == '}'; }
+
+/* write `(x,y,z)`, or `x y z` without brackets */
+std::to_chars_result format_array_double3(char *first, char *last,
+                                          const std::array<double, 3> &a,
+                                          bool brackets = true) {
+  chars_writer out(first, last);
+  if (brackets)
+    out.put('(');
+  for (int i = 0; i < 3; ++i) {
+    if (i > 0)
+      out.put(brackets ? ',' : ' ');
+    out.put_number(a[i]);
+  }
+  if (brackets)
+    out.put(')');
+  return out.result();
+}
 
-    double z = match[9] == "" ? 0 : sign;
+/* colors are written as `#rrggbb` when it parses back exactly, as a number
+  triple otherwise */
+bool is_8bit_color(const Color &color) {
+  return std::all_of(color.begin(), color.end(), [](double c) {
+    return c >= 0 && c <= 1 && std::round(c * 255) / 255. == c;
+  });
+}
 
-    return {x, y, z};
+std::to_chars_result format_hex_color(char *first, char *last,
+                                      const Color &color) {
+  static constexpr char digits[] = "0123456789abcdef";
+  chars_writer out(first, last);
+  out.put('#');
+  for (double c : color) {
+    const int i = (int)std::round(c * 255);
+    out.put(digits[i / 16]);
+    out.put(digits[i % 16]);
   }
-  try {
-    return _parse_array_double3(s);
-  } catch (std::invalid_argument &e) {
-    throw std::invalid_argument("cannot parse Vector3 (" +
-                                std::string(e.what()) + ")");
+  return out.result();
+}
+
+expected<std::array<double, 3>> parse_array_double3(std::string_view s,
+                                                    std::string_view subject) {
+  const char lbracket = !s.empty() && is_lbracket(s[0]) ? s[0] : 0;
+  size_t starts[3], ends[3];
+  char rbracket = 0;
+
+  const auto separator = [&](size_t i) {
+    i = skip_spaces(s, i);
+    if (i < s.size() && s[i] == ',')
+      ++i;
+    return skip_spaces(s, i);
+  };
+
+  /* numbers `n` to 2 starting at `i`, followed by the end of the triple */
+  const auto numbers = [&](const auto &self, int n, size_t i) -> bool {
+    starts[n] = i;
+    return number_ends(s, i, [&](size_t end) {
+      ends[n] = end;
+      if (n < 2)
+        return self(self, n + 1, separator(end));
+      size_t j = skip_spaces(s, end);
+      rbracket = j < s.size() && is_rbracket(s[j]) ? s[j++] : 0;
+      return j == s.size();
+    });
+  };
+
+  if (numbers(numbers, 0, skip_spaces(s, lbracket ? 1 : 0))) {
+    if ((lbracket == '(' && rbracket != ')') ||
+        (lbracket == '[' && rbracket != ']') ||
+        (lbracket == '{' && rbracket != '}') || (!lbracket && rbracket))
+      return unexpected(invalid(subject, "mismatched brackets"));
+    std::array<double, 3> values;
+    for (int n = 0; n < 3; ++n) {
+      const auto value =
+          to_number<double>(s.substr(starts[n], ends[n] - starts[n]), subject);
+      if (!value)
+        return unexpected(value.error());
+      values[n] = *value;
+    }
+    return values;
   }
+  return unexpected(invalid(subject, "not a number triple"));
+}
+
+} // namespace
+
+expected<int> try_parse_int(const std::string &s) {
+  return to_number<int>(s, "int");
+}
+
+expected<double> try_parse_double(const std::string &s) {
+  return to_number<double>(s, "double");
+}
+
+expected<Vector3> try_parse_Vector3(const std::string &s) {
+  Vector3 v = {0, 0, 0};
+  double sign = 1;
+  size_t i = 0;
+  for (size_t axis = 0; axis < 3; ++axis) {
+    size_t j = i;
+    const char sign_char =
+        j < s.size() && (s[j] == '+' || s[j] == '-') ? s[j++] : 0;
+    if (j < s.size() && (s[j] | 0x20) == "xyz"[axis]) {
+      if (sign_char)
+        sign = sign_char == '-' ? -1 : +1;
+      v[axis] = sign;
+      i = j + 1;
+    }
+  }
+  if (i == s.size())
+    return v;
+
+  return parse_array_double3(s, "Vector3");
+}
+Vector3 parse_Vector3(const std::string &s) {
+  return try_parse_Vector3(s).value();
+}
+std::to_chars_result format_Vector3(char *first, char *last,
+                                    const Vector3 &v) {
+  return format_array_double3(first, last, v);
 }
 std::string format_Vector3(const Vector3 &v) {
-  std::stringstream stream;
-  stream << "(" << v[0] << "," << v[1] << "," << v[2] << ")";
-  return stream.str();
+  return format_to_string(format_Vector3, v);
 }
 
+expected<Point3> try_parse_Point3(const std::string &s) {
+  return parse_array_double3(s, "Point3");
+}
 Point3 parse_Point3(const std::string &s) {
-  try {
-    return _parse_array_double3(s);
-  } catch (std::invalid_argument &e) {
-    throw std::invalid_argument("cannot parse Point3 (" +
-                                std::string(e.what()) + ")");
-  }
+  return try_parse_Point3(s).value();
+}
+std::to_chars_result format_Point3(char *first, char *last, const Point3 &p) {
+  return format_array_double3(first, last, p);
 }
 std::string format_Point3(const Point3 &p) {
-  std::stringstream stream;
-  stream << "(" << p[0] << "," << p[1] << "," << p[2] << ")";
-  return stream.str();
-}
-
-Color parse_Color(const std::string &s) {
-  const std::regex hexPattern("#([0-9a-f]{6})", std::regex_constants::icase);
-  std::smatch match;
-  if (std::regex_match(s, match, hexPattern)) {
-    int r = 0, g = 0, b = 0;
-    sscanf(match[1].str().c_str(), "%02x%02x%02x", &r, &g, &b);
-    return {r / 255., g / 255., b / 255.};
-  }
+  return format_to_string(format_Point3, p);
+}
 
-  try {
-    return _parse_array_double3(s);
-  } catch (std::invalid_argument &e) {
-    throw std::invalid_argument("cannot parse Color (" + std::string(e.what()) +
-                                ")");
+expected<Color> try_parse_Color(const std::string &s) {
+  if (s.size() == 7 && s[0] == '#' &&
+      std::all_of(s.begin() + 1, s.end(),
+                  [](char c) { return std::isxdigit((unsigned char)c); })) {
+    Color color;
+    for (int i = 0; i < 3; ++i) {
+      int c = 0;
+      std::from_chars(s.data() + 1 + 2 * i, s.data() + 3 + 2 * i, c, 16);
+      color[i] = c / 255.;
+    }
+    return color;
   }
+
+  return parse_array_double3(s, "Color");
 }
+Color parse_Color(const std::string &s) { return try_parse_Color(s).value(); }
 
+std::to_chars_result format_Color(char *first, char *last,
+                                  const Color &color) {
+  if (is_8bit_color(color))
+    return format_hex_color(first, last, color);
+  return format_array_double3(first, last, color);
+}
 std::string format_Color(const Color &color) {
-  std::stringstream stream;
-  stream << "#" << std::hex //
-         << std::setfill('0') << std::setw(2)
-         << (int)std::round(color[0] * 255) //
-         << std::setfill('0') << std::setw(2)
-         << (int)std::round(color[1] * 255) //
-         << std::setfill('0') << std::setw(2)
-         << (int)std::round(color[2] * 255);
-  return stream.str();
-}
-
-Colormap parse_Colormap(const std::string &v) {
-  if (v == "redblue") {
-    return Colormap({{Color({1., 0., 0.}), Color({0., 0., 1.})}, v});
-  } else if (v == "frenchflag") {
-    return Colormap(
-        {{Color({0., 0., 1.}), Color({1., 1., 1.}), Color({1., 0., 0.})}, v});
-    // } else if (v == "...") {
-    // TODO lookup more names
-  } else {
-    Colormap cm;
-    std::stringstream stream(v);
-    while (stream.good()) {
-      std::string substr;
-      getline(stream, substr, ',');
-      cm.colors.push_back(parse_Color(substr));
-    }
-    return cm;
-  }
+  return format_to_string(format_Color, color);
+}
+
+expected<Colormap> try_parse_Colormap(const std::string &v) {
+  return try_lookup_colormap(v);
 }
+Colormap parse_Colormap(const std::string &v) { return lookup_colormap(v); }
 
 std::string format_Colormap(const Colormap &cm) {
   if (cm.name.empty()) {
-    std::stringstream stream;
-    if (!cm.colors.empty()) {
-      bool first = true;
-      for (auto color : cm.colors) {
-        if (!first)
-          stream << ",";
-        stream << format_Color(color);
-        first = false;
-      }
+    /* colors are comma-separated, triples are written space-separated */
+    std::string s;
+    char buffer[format_buffer_size];
+    for (const auto &color : cm.colors) {
+      if (!s.empty())
+        s += ',';
+      const auto [ptr, ec] =
+          is_8bit_color(color)
+              ? format_hex_color(buffer, buffer + sizeof(buffer), color)
+              : format_array_double3(buffer, buffer + sizeof(buffer), color,
+                                     false);
+      s.append(buffer, ptr);
     }
-    return stream.str();
+    return s;
   } else {
     return cm.name;
   }
 }
 
-std::string json_to_std_string(const json &s) {
+expected<std::string> try_json_to_std_string(const json &s) {
   if (s.is_string())
     return s.get<std::string>();
   if (s.is_structured())
-    throw std::invalid_argument("complex object");
-  std::stringstream ss;
-  ss << s;
-  return ss.str();
+    return unexpected(invalid("std::string", "complex object"));
+  return s.dump();
 }
 
-int json_to_int(const json &s) {
+namespace {
+
+/* parse the string form of a json value */
+template <typename T>
+expected<T> parse_json_string(const json &v, std::string_view subject,
+                              expected<T> (*parse)(const std::string &)) {
+  const auto s = try_json_to_std_string(v);
+  if (!s)
+    return unexpected(invalid(subject, s.error().what));
+  return parse(*s);
+}
+
+bool is_number_triple(const json &o) {
+  return o.is_array() && o.size() == 3 && o[0].is_number() &&
+         o[1].is_number() && o[2].is_number();
+}
+
+std::array<double, 3> to_array_double3(const json &o) {
+  return {o[0].get<double>(), o[1].get<double>(), o[2].get<double>()};
+}
+
+} // namespace
+
+expected<int> try_json_to_int(const json &s) {
   if (s.is_number_integer())
     return s.get<int>();
-  else
-    return parse_int(json_to_std_string(s));
+  return parse_json_string(s, "int", try_parse_int);
 }
 
-double json_to_double(const json &s) {
+expected<double> try_json_to_double(const json &s) {
   if (s.is_number())
     return s.get<double>();
-  else
-    return parse_double(json_to_std_string(s));
+  return parse_json_string(s, "double", try_parse_double);
 }
 
-bool json_to_bool(const json &s) {
+expected<bool> try_json_to_bool(const json &s) {
   if (s.is_boolean())
     return s.get<bool>();
-  else
-    return parse_bool(json_to_std_string(s));
-}
-
-std::array<double, 3> _json_to_array_double3(const json &o) {
-  if (o.is_array() && o.size() == 3 && o[0].is_number() && o[1].is_number() &&
-      o[2].is_number()) {
-    return {o[0].get<double>(), o[1].get<double>(), o[2].get<double>()};
-  } else
-    throw std::invalid_argument("not a number triple");
-}
-
-Vector3 json_to_Vector3(const json &v) {
-  try {
-    return _json_to_array_double3(v);
-  } catch (std::invalid_argument &e) {
-    try {
-      return parse_Vector3(json_to_std_string(v));
-    } catch (std::invalid_argument &e) {
-      throw std::invalid_argument("cannot convert json to Vector3 (" +
-                                  std::string(e.what()) + ")");
-    }
-  }
+  return parse_json_string(s, "bool", try_parse_bool);
 }
 
-Point3 json_to_Point3(const json &v) {
-  try {
-    return _json_to_array_double3(v);
-  } catch (std::invalid_argument &e) {
-    try {
-      return parse_Point3(json_to_std_string(v));
-    } catch (std::invalid_argument &e) {
-      throw std::invalid_argument("cannot convert json to Point3 (" +
-                                  std::string(e.what()) + ")");
-    }
-  }
+expected<Vector3> try_json_to_Vector3(const json &v) {
+  if (is_number_triple(v))
+    return to_array_double3(v);
+  return parse_json_string(v, "Vector3", try_parse_Vector3);
 }
 
-Color json_to_Color(const json &v) {
-  try {
-    return _json_to_array_double3(v);
-  } catch (std::invalid_argument &e) {
-    try {
-      return parse_Color(json_to_std_string(v));
-    } catch (std::invalid_argument &e) {
-      throw std::invalid_argument("cannot convert json to Color (" +
-                                  std::string(e.what()) + ")");
-    }
-  }
+expected<Point3> try_json_to_Point3(const json &v) {
+  if (is_number_triple(v))
+    return to_array_double3(v);
+  return parse_json_string(v, "Point3", try_parse_Point3);
 }
 
-Colormap json_to_Colormap(const json &v) {
+expected<Color> try_json_to_Color(const json &v) {
+  if (is_number_triple(v))
+    return to_array_double3(v);
+  return parse_json_string(v, "Color", try_parse_Color);
+}
+
+expected<Colormap> try_json_to_Colormap(const json &v) {
   // TODO
-  try {
-    return parse_Colormap(json_to_std_string(v));
-  } catch (std::invalid_argument &e) {
-    throw std::invalid_argument("cannot convert json to Colormap (" +
-                                std::string(e.what()) + ")");
-  }
+  return parse_json_string(v, "Colormap", try_parse_Colormap);
+}
+
+std::string json_to_std_string(const json &s) {
+  return try_json_to_std_string(s).value();
 }
+int json_to_int(const json &s) { return try_json_to_int(s).value(); }
+double json_to_double(const json &s) { return try_json_to_double(s).value(); }
+bool json_to_bool(const json &s) { return try_json_to_bool(s).value(); }
+Vector3 json_to_Vector3(const json &v) { return try_json_to_Vector3(v).value(); }
+Point3 json_to_Point3(const json &v) { return try_json_to_Point3(v).value(); }
+Color json_to_Color(const json &v) { return try_json_to_Color(v).value(); }
+Colormap json_to_Colormap(const json &v) {
+  return parse_Colormap(json_to_std_string(v));
+}
+
+json std_string_to_json(const std::string &v) { return v; }
+json int_to_json(const int &v) { return v; }
+json double_to_json(const double &v) { return v; }
+json bool_to_json(const bool &v) { return v; }
+json Vector3_to_json(const Vector3 &v) { return v; }
+json Point3_to_json(const Point3 &p) { return p; }
+json Color_to_json(const Color &color) { return color; }
+json Colormap_to_json(const Colormap &cm) { return format_Colormap(cm); }
 
 } // namespace options_ns
\ No newline at end of file
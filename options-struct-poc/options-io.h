@@ -1,39 +1,67 @@
 #pragma once
 
+#include <charconv>
 #include <stdexcept>
 #include <string>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "options-expected.h"
 #include "options.h"
 
 namespace options_ns {
 
+/* the `format_*(first, last, value)` overloads write into a caller-provided
+  buffer without allocating, like `std::to_chars` (`ec` is
+  `std::errc::value_too_large` if the buffer is too small).
+  Floating point numbers are written in their shortest form that parses back to
+  the same value, `format_buffer_size` chars are enough for any of the types */
+constexpr size_t format_buffer_size = 80;
+
+expected<std::string> try_parse_std_string(const std::string &);
 std::string parse_std_string(const std::string &);
 std::string format_std_string(const std::string &);
 
+/* numbers are the whole string but surrounding spaces, as read by
+  `std::from_chars` with an optional leading `+`. Unlike the `std::stoi` and
+  `std::stod` they replaced, trailing text ("12abc", "1e3x") and hexadecimal
+  floats are rejected; `inf` and `nan` are still accepted */
+expected<int> try_parse_int(const std::string &);
 int parse_int(const std::string &);
 std::string format_int(const int &);
+std::to_chars_result format_int(char *first, char *last, const int &);
 
+expected<double> try_parse_double(const std::string &);
 double parse_double(const std::string &);
 std::string format_double(const double &);
+std::to_chars_result format_double(char *first, char *last, const double &);
 
+expected<bool> try_parse_bool(const std::string &);
 bool parse_bool(const std::string &);
 std::string format_bool(const bool &);
 
+expected<Color> try_parse_Color(const std::string &);
 Color parse_Color(const std::string &);
 std::string format_Color(const Color &);
+std::to_chars_result format_Color(char *first, char *last, const Color &);
 
+expected<Vector3> try_parse_Vector3(const std::string &);
 Vector3 parse_Vector3(const std::string &);
 std::string format_Vector3(const Vector3 &);
+std::to_chars_result format_Vector3(char *first, char *last, const Vector3 &);
 
+expected<Point3> try_parse_Point3(const std::string &);
 Point3 parse_Point3(const std::string &);
 std::string format_Point3(const Point3 &);
+std::to_chars_result format_Point3(char *first, char *last, const Point3 &);
 
+expected<Colormap> try_parse_Colormap(const std::string &);
 Colormap parse_Colormap(const std::string &);
 std::string format_Colormap(const Colormap &);
 
+/* the `try_*` conversions return errors instead of throwing, the throwing
+  ones raise them as `std::invalid_argument` or `std::out_of_range` */
 std::string json_to_std_string(const json &);
 int json_to_int(const json &);
 double json_to_double(const json &);
@@ -42,5 +70,22 @@ Vector3 json_to_Vector3(const json &);
 Point3 json_to_Point3(const json &);
 Color json_to_Color(const json &);
 Colormap json_to_Colormap(const json &);
+expected<std::string> try_json_to_std_string(const json &);
+expected<int> try_json_to_int(const json &);
+expected<double> try_json_to_double(const json &);
+expected<bool> try_json_to_bool(const json &);
+expected<Vector3> try_json_to_Vector3(const json &);
+expected<Point3> try_json_to_Point3(const json &);
+expected<Color> try_json_to_Color(const json &);
+expected<Colormap> try_json_to_Colormap(const json &);
+
+json std_string_to_json(const std::string &);
+json int_to_json(const int &);
+json double_to_json(const double &);
+json bool_to_json(const bool &);
+json Vector3_to_json(const Vector3 &);
+json Point3_to_json(const Point3 &);
+json Color_to_json(const Color &);
+json Colormap_to_json(const Colormap &);
 
 } // namespace options_ns
\ No newline at end of file
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "options-detail.h"
+
+namespace options_ns {
+
+/** Streaming conversion of a JSON document into a diff, without building the
+ * document tree.
+ * Nested objects are flattened into keys joined with `key_sep`, so
+ * `{"a": {"b": 1}}` and `{"a.b": 1}` are equivalent, except for the objects
+ * of keys with object values (maps). Each leaf is converted as soon as it has
+ * been read, only arrays and those objects are built as `json` values before
+ * conversion. `null` leaves unset their key.
+ */
+template <typename Diff>
+class json_diff_reader : public nlohmann::json_sax<nlohmann::json> {
+public:
+  typedef nlohmann::json json;
+
+  explicit json_diff_reader(std::string key_sep = ".")
+      : key_sep(std::move(key_sep)) {}
+
+  bool null() override { return value(nullptr); }
+  bool boolean(bool v) override { return value(v); }
+  bool number_integer(number_integer_t v) override { return value(v); }
+  bool number_unsigned(number_unsigned_t v) override { return value(v); }
+  bool number_float(number_float_t v, const string_t &) override {
+    return value(v);
+  }
+  bool string(string_t &v) override { return value(std::move(v)); }
+  bool binary(binary_t &v) override {
+    return value(json::binary(std::move(v)));
+  }
+
+  bool start_object(std::size_t) override {
+    if (!nested.empty() || (!prefixes.empty() && Diff::key(path)))
+      return push(json::object());
+    prefixes.push_back(path.size());
+    return true;
+  }
+  bool key(string_t &k) override {
+    if (!nested.empty()) {
+      member = std::move(k);
+      return true;
+    }
+    path.resize(prefixes.back());
+    if (!path.empty())
+      path += key_sep;
+    path += k;
+    return true;
+  }
+  bool end_object() override {
+    if (!nested.empty())
+      return pop();
+    path.resize(prefixes.back());
+    prefixes.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t) override { return push(json::array()); }
+  bool end_array() override { return pop(); }
+
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &e) override {
+    error = e.what();
+    return false;
+  }
+
+  /** The diff read so far. */
+  Diff &diff() { return result; }
+
+  /** Error message of a syntax error, empty if there was none. */
+  const std::string &parse_error_message() const { return error; }
+
+private:
+  std::string key_sep;
+  Diff result;
+
+  /* current dotted key, and its length before each of the enclosing keys */
+  std::string path;
+  std::vector<size_t> prefixes;
+
+  /* arrays (and what they contain) being built */
+  std::vector<json *> nested;
+  json array;
+  std::string member;
+
+  std::string error;
+
+  bool value(json &&v) {
+    if (nested.empty())
+      return leaf(std::move(v));
+    add(std::move(v));
+    return true;
+  }
+
+  json &add(json &&v) {
+    json &parent = *nested.back();
+    if (parent.is_array())
+      return parent.emplace_back(std::move(v));
+    return parent[member] = std::move(v);
+  }
+
+  bool push(json &&container) {
+    if (nested.empty()) {
+      if (prefixes.empty())
+        return false; /* the document must be an object */
+      array = std::move(container);
+      nested.push_back(&array);
+    } else {
+      nested.push_back(&add(std::move(container)));
+    }
+    return true;
+  }
+
+  bool pop() {
+    nested.pop_back();
+    if (nested.empty())
+      return leaf(std::move(array));
+    return true;
+  }
+
+  bool leaf(json &&v) {
+    if (prefixes.empty())
+      return false; /* the document must be an object */
+    auto &[id, entry] = *result.try_emplace(path).first;
+    if (v.is_null())
+      entry = std::nullopt;
+    else
+      entry = detail::from_json_value(id, v);
+    return true;
+  }
+};
+
+/** Read a diff from JSON text (string, stream, or iterator pair, as accepted
+ * by `nlohmann::json::sax_parse`).
+ * Throws `std::invalid_argument` if the text is not a JSON object, and the
+ * exceptions of the conversion functions for invalid keys or values.
+ */
+template <typename Diff, typename Input>
+Diff json_to_diff(Input &&input, const std::string &key_sep = ".") {
+  json_diff_reader<Diff> reader(key_sep);
+  if (!nlohmann::json::sax_parse(std::forward<Input>(input), &reader)) {
+    const auto &message = reader.parse_error_message();
+    throw std::invalid_argument(
+        message.empty() ? "JSON document is not an object" : message);
+  }
+  return std::move(reader.diff());
+}
+
+/** Layout of the keys of a written JSON document. */
+enum class json_layout {
+  nested, /* `{"a": {"b": 1}}` */
+  flat,   /* `{"a.b": 1}` */
+};
+
+namespace detail {
+
+inline void write_chars(std::string &out, std::string_view s) {
+  out.append(s);
+}
+inline void write_chars(std::ostream &out, std::string_view s) {
+  out.write(s.data(), s.size());
+}
+
+template <typename Out> void write_json_string(Out &out, std::string_view s) {
+  static constexpr char digits[] = "0123456789abcdef";
+  write_chars(out, "\"");
+  size_t begin = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    const unsigned char c = s[i];
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    write_chars(out, s.substr(begin, i - begin));
+    begin = i + 1;
+    switch (c) {
+    case '"':
+      write_chars(out, "\\\"");
+      break;
+    case '\\':
+      write_chars(out, "\\\\");
+      break;
+    case '\b':
+      write_chars(out, "\\b");
+      break;
+    case '\f':
+      write_chars(out, "\\f");
+      break;
+    case '\n':
+      write_chars(out, "\\n");
+      break;
+    case '\r':
+      write_chars(out, "\\r");
+      break;
+    case '\t':
+      write_chars(out, "\\t");
+      break;
+    default: {
+      const char escape[] = {'\\', 'u',           '0',
+                             '0',  digits[c >> 4], digits[c & 15]};
+      write_chars(out, std::string_view(escape, sizeof(escape)));
+    }
+    }
+  }
+  write_chars(out, s.substr(begin));
+  write_chars(out, "\"");
+}
+
+/* same output as `json::dump()`, except for floating point numbers which are
+  written in their shortest round-trip form */
+template <typename Out>
+void write_json_value(Out &out, const nlohmann::json &v) {
+  typedef nlohmann::json::value_t type;
+  char buffer[32];
+  switch (v.type()) {
+  case type::null:
+    write_chars(out, "null");
+    break;
+  case type::boolean:
+    write_chars(out, v.get<bool>() ? "true" : "false");
+    break;
+  case type::number_integer: {
+    const auto r = std::to_chars(buffer, buffer + sizeof(buffer),
+                                 v.get<int64_t>());
+    write_chars(out, std::string_view(buffer, r.ptr - buffer));
+    break;
+  }
+  case type::number_unsigned: {
+    const auto r = std::to_chars(buffer, buffer + sizeof(buffer),
+                                 v.get<uint64_t>());
+    write_chars(out, std::string_view(buffer, r.ptr - buffer));
+    break;
+  }
+  case type::number_float: {
+    const double d = v.get<double>();
+    if (!std::isfinite(d)) {
+      write_chars(out, "null");
+      break;
+    }
+    const auto r = std::to_chars(buffer, buffer + sizeof(buffer), d);
+    const std::string_view number(buffer, r.ptr - buffer);
+    write_chars(out, number);
+    if (number.find_first_not_of("-0123456789") == number.npos)
+      write_chars(out, ".0"); /* stay a floating point number when read */
+    break;
+  }
+  case type::string:
+    write_json_string(out, v.get_ref<const std::string &>());
+    break;
+  case type::array: {
+    write_chars(out, "[");
+    bool first = true;
+    for (const auto &item : v) {
+      if (!first)
+        write_chars(out, ",");
+      write_json_value(out, item);
+      first = false;
+    }
+    write_chars(out, "]");
+    break;
+  }
+  case type::object: {
+    write_chars(out, "{");
+    bool first = true;
+    for (const auto &[key, item] : v.items()) {
+      if (!first)
+        write_chars(out, ",");
+      write_json_string(out, key);
+      write_chars(out, ":");
+      write_json_value(out, item);
+      first = false;
+    }
+    write_chars(out, "}");
+    break;
+  }
+  default:
+    write_chars(out, v.dump());
+  }
+}
+
+} // namespace detail
+
+/** Streaming writer of a JSON object, to a `std::string` or a `std::ostream`.
+ * Values must be written in the sorted order of their keys, so that the keys
+ * sharing a prefix are written together in the nested layout.
+ */
+template <typename Out> class json_object_writer {
+public:
+  json_object_writer(Out &out, json_layout layout = json_layout::nested,
+                     std::string key_sep = ".")
+      : out(out), layout(layout), key_sep(std::move(key_sep)) {
+    detail::write_chars(out, "{");
+  }
+
+  json_object_writer(const json_object_writer &) = delete;
+  json_object_writer &operator=(const json_object_writer &) = delete;
+
+  void write(std::string_view key, const nlohmann::json &value) {
+    if (layout == json_layout::nested) {
+      close_until(key);
+      for (size_t pos; (pos = key.find(key_sep, path.size())) != key.npos;)
+        open(key.substr(path.size(), pos - path.size()));
+      key.remove_prefix(path.size());
+    }
+    if (!first)
+      detail::write_chars(out, ",");
+    detail::write_json_string(out, key);
+    detail::write_chars(out, ":");
+    detail::write_json_value(out, value);
+    first = false;
+  }
+
+  /** Close the object, nothing can be written afterwards. */
+  void finish() {
+    close_until({});
+    detail::write_chars(out, "}");
+  }
+
+private:
+  Out &out;
+  json_layout layout;
+  std::string key_sep;
+
+  /* prefix of the keys of the open nested objects, ending with `key_sep`, and
+    its length before each of them */
+  std::string path;
+  std::vector<size_t> prefixes;
+  bool first = true;
+
+  void open(std::string_view name) {
+    if (!first)
+      detail::write_chars(out, ",");
+    detail::write_json_string(out, name);
+    detail::write_chars(out, ":{");
+    prefixes.push_back(path.size());
+    path.append(name).append(key_sep);
+    first = true;
+  }
+
+  void close_until(std::string_view key) {
+    while (!prefixes.empty() && key.substr(0, path.size()) != path) {
+      detail::write_chars(out, "}");
+      path.resize(prefixes.back());
+      prefixes.pop_back();
+      first = false;
+    }
+  }
+};
+
+/** Write a diff as a JSON object, unset values being `null`. */
+template <typename Out, typename Diff>
+void write_json(Out &out, const Diff &diff,
+                json_layout layout = json_layout::nested,
+                const std::string &key_sep = ".") {
+  json_object_writer<Out> writer(out, layout, key_sep);
+  for (const auto &[id, value] : diff)
+    writer.write(key_name(id),
+                 value ? detail::to_json_value(id, *value) : nlohmann::json());
+  writer.finish();
+}
+
+/** Write the values of the `[first, last)` keys of an instance as a JSON
+ * object, unset optional values being `null`.
+ * All the keys are given by `key_range("")`.
+ */
+template <typename Out, typename S, typename KeyId>
+void write_json(Out &out, const S &s, std::pair<KeyId, KeyId> keys,
+                json_layout layout = json_layout::nested,
+                const std::string &key_sep = ".") {
+  typedef std::underlying_type_t<KeyId> index;
+  json_object_writer<Out> writer(out, layout, key_sep);
+  for (auto id = keys.first; id != keys.second; id = KeyId(index(id) + 1)) {
+    const auto value = get(s, id);
+    writer.write(key_name(id),
+                 value ? detail::to_json_value(id, *value) : nlohmann::json());
+  }
+  writer.finish();
+}
+
+} // namespace options_ns
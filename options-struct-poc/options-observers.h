@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "options-detail.h"
+
+namespace options_ns {
+
+/** Observers of the changes made to ranges of keys.
+ * Ranges are `[first, last)` identifier ranges as returned by the generated
+ * `key_range()`, eg. `key_range("render.grid")` for a whole subtree.
+ * Each subscriber is notified at most once per diff, with the part of the
+ * diff it subscribed to, as applied: from the generated `edit_diff()`, the
+ * changes of vectors are `vector_edit`s of the previous instance.
+ */
+template <typename S, typename Diff> class diff_observers {
+public:
+  typedef typename Diff::key_type KeyId;
+  typedef std::function<void(const S &, const Diff &)> callback;
+  typedef size_t subscription;
+
+  subscription subscribe(std::pair<KeyId, KeyId> range, callback f) {
+    const auto it = std::upper_bound(
+        subscribers.begin(), subscribers.end(), range.first,
+        [](KeyId id, const subscriber &sub) { return id < sub.first; });
+    subscribers.insert(it, {range.first, range.second, next_id, std::move(f)});
+    return next_id++;
+  }
+
+  void unsubscribe(subscription id) {
+    std::erase_if(subscribers,
+                  [id](const subscriber &sub) { return sub.id == id; });
+  }
+
+  /** Apply a diff to an instance and notify the subscribers. */
+  void apply(S &s, const Diff &diff) const {
+    detail::apply_diff(s, diff);
+    notify(s, diff);
+  }
+
+  /** Notify the subscribers of the keys changed by a diff. */
+  void notify(const S &s, const Diff &diff) const {
+    if (diff.empty())
+      return;
+    for (const auto &sub : subscribers) {
+      if (!(sub.first < diff_last(diff)))
+        break; /* subscribers are sorted by the start of their range */
+
+      auto it = std::lower_bound(
+          diff.begin(), diff.end(), sub.first,
+          [](const auto &item, KeyId id) { return item.first < id; });
+      if (it == diff.end() || !(it->first < sub.last))
+        continue;
+
+      Diff part;
+      for (; it != diff.end() && it->first < sub.last; ++it)
+        part[it->first] = it->second;
+      sub.f(s, part);
+    }
+  }
+
+private:
+  struct subscriber {
+    KeyId first;
+    KeyId last;
+    subscription id;
+    callback f;
+  };
+
+  std::vector<subscriber> subscribers;
+  subscription next_id = 0;
+
+  static KeyId diff_last(const Diff &diff) {
+    return KeyId(static_cast<size_t>(std::prev(diff.end())->first) + 1);
+  }
+};
+
+} // namespace options_ns
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "options-detail.h"
+
+namespace options_ns {
+
+/** Publication of immutable snapshots of an instance to concurrent readers.
+ * Writers modify a private copy of the current snapshot and publish it
+ * atomically, readers access the current snapshot without waiting.
+ * Replaced snapshots are deleted by writers once no reader can still be
+ * accessing them, using epochs: a reader announces the epoch it started
+ * reading in, a snapshot replaced in epoch `e` is only referenced by readers
+ * that started before `e`.
+ * All atomic operations are sequentially consistent, this is what makes a
+ * reader either visible to the writer scanning the announced epochs or
+ * guaranteed to load the newly published snapshot.
+ */
+template <typename S, size_t MaxReaders = 64> class snapshot_publisher {
+  static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+
+  struct alignas(64) slot {
+    std::atomic<uint64_t> epoch = idle;
+    std::atomic<bool> taken = false;
+  };
+
+public:
+  explicit snapshot_publisher(S initial = S())
+      : current(new S(std::move(initial))) {}
+
+  /* no reader may outlive the publisher */
+  ~snapshot_publisher() {
+    delete current.load();
+    for (const auto &r : retired)
+      delete r.snapshot;
+  }
+
+  snapshot_publisher(const snapshot_publisher &) = delete;
+  snapshot_publisher &operator=(const snapshot_publisher &) = delete;
+
+  /** Access to the current snapshot for as long as the guard is alive. */
+  class guard {
+  public:
+    ~guard() { announced.store(idle); }
+    guard(const guard &) = delete;
+    guard &operator=(const guard &) = delete;
+
+    const S &operator*() const { return *snapshot; }
+    const S *operator->() const { return snapshot; }
+
+  private:
+    friend class snapshot_publisher;
+    guard(std::atomic<uint64_t> &announced, const S *snapshot)
+        : announced(announced), snapshot(snapshot) {}
+
+    std::atomic<uint64_t> &announced;
+    const S *snapshot;
+  };
+
+  /** Registration of a reading thread.
+   * A reader must not be used by several threads at once, and must not hold
+   * more than one guard at a time.
+   */
+  class reader {
+  public:
+    explicit reader(snapshot_publisher &publisher) : publisher(publisher) {
+      for (auto &s : publisher.slots) {
+        bool expected = false;
+        if (s.taken.compare_exchange_strong(expected, true)) {
+          announced = &s;
+          return;
+        }
+      }
+      throw std::length_error("too many snapshot readers");
+    }
+    ~reader() { announced->taken.store(false); }
+    reader(const reader &) = delete;
+    reader &operator=(const reader &) = delete;
+
+    /** Get the current snapshot, wait-free. */
+    guard read() {
+      announced->epoch.store(publisher.epoch.load());
+      return guard(announced->epoch, publisher.current.load());
+    }
+
+  private:
+    snapshot_publisher &publisher;
+    slot *announced = nullptr;
+  };
+
+  /** Publish a new snapshot. */
+  void publish(S s) {
+    std::lock_guard lock(writer);
+    publish_locked(new S(std::move(s)));
+  }
+
+  /** Publish a copy of the current snapshot modified by `f(S&)`. */
+  template <typename F> void update(F &&f) {
+    std::lock_guard lock(writer);
+    S *next = new S(*current.load());
+    try {
+      f(*next);
+    } catch (...) {
+      delete next;
+      throw;
+    }
+    publish_locked(next);
+  }
+
+  /** Publish a copy of the current snapshot with a diff applied. */
+  template <typename Diff> void apply(const Diff &diff) {
+    update([&diff](S &s) { detail::apply_diff(s, diff); });
+  }
+
+  /** Delete the replaced snapshots no reader is accessing anymore. */
+  void collect() {
+    std::lock_guard lock(writer);
+    collect_locked();
+  }
+
+  /** Number of replaced snapshots not deleted yet. */
+  size_t pending() const {
+    std::lock_guard lock(writer);
+    return retired.size();
+  }
+
+private:
+  struct retired_snapshot {
+    const S *snapshot;
+    uint64_t epoch;
+  };
+
+  std::atomic<const S *> current;
+  std::atomic<uint64_t> epoch = 0;
+  std::array<slot, MaxReaders> slots;
+
+  mutable std::mutex writer;
+  std::vector<retired_snapshot> retired;
+
+  void publish_locked(const S *next) {
+    const S *previous = current.exchange(next);
+    retired.push_back({previous, epoch.fetch_add(1) + 1});
+    collect_locked();
+  }
+
+  void collect_locked() {
+    uint64_t oldest = idle;
+    for (const auto &s : slots)
+      oldest = std::min(oldest, s.epoch.load());
+
+    std::erase_if(retired, [oldest](const retired_snapshot &r) {
+      if (r.epoch > oldest)
+        return false;
+      delete r.snapshot;
+      return true;
+    });
+  }
+};
+
+} // namespace options_ns
@@ -5,93 +5,353 @@
 ////////////////////////////////////////////////////////////////////////////////
 namespace options_ns::app_options_io {
 
-const std::array<K, 1> sorted_keys = {
+constexpr std::array<std::string_view, 1> sorted_keys = {
   keys.watch, // 0 "watch"
 };
 
-inline size_t key_index(const K& key) {
-  const auto lower = std::lower_bound(sorted_keys.begin(), sorted_keys.end(), key);
-  if (lower == sorted_keys.end() || *lower != key)
-    throw invalid_key(key);
+/* hashes of `sorted_keys`, see `structio.py:fingerprint_seed()` */
+constexpr std::array<uint64_t, 1> fingerprint_seeds = {
+  0xD3B5E34C82D387C8, // "watch"
+};
+
+constexpr uint32_t key_hash(uint32_t seed, std::string_view key) {
+  uint32_t h = seed ? seed : 0x811c9dc5u;
+  for (const unsigned char c : key)
+    h = (h ^ c) * 0x01000193u;
+  return h;
+}
+
+/* perfect hash of `sorted_keys`, see `structio.py:perfect_hash()` */
+constexpr std::array<int32_t, 1> key_hash_seeds = {
+  -1,
+};
+constexpr std::array<uint16_t, 1> key_hash_slots = {
+  0,
+};
+
+std::optional<KeyId> find_key_id(std::string_view key) noexcept {
+  const size_t n = sorted_keys.size();
+  const int32_t seed = key_hash_seeds[key_hash(0, key) % n];
+  const size_t slot = seed < 0 ? -seed - 1 : key_hash(seed, key) % n;
+  const size_t index = key_hash_slots[slot];
+  if (sorted_keys[index] != key)
+    return std::nullopt;
+  else
+    return static_cast<KeyId>(index);
+}
+
+KeyId key_id(std::string_view key) {
+  if (const auto id = find_key_id(key))
+    return *id;
   else
-    return std::distance(sorted_keys.begin(), lower);
+    throw invalid_key(key);
+}
+
+std::string_view key_name(KeyId id) {
+  return sorted_keys.at(static_cast<size_t>(id));
+}
+
+std::pair<KeyId, KeyId> key_range(std::string_view prefix) noexcept {
+  const auto begin = sorted_keys.begin();
+  if (prefix.empty())
+    return {KeyId(0), KeyId(sorted_keys.size())};
+  if (const auto id = find_key_id(prefix))
+    return {*id, KeyId(static_cast<size_t>(*id) + 1)};
+  const std::string_view sep = ".";
+  const auto first = std::partition_point(begin, sorted_keys.end(),
+    [&](std::string_view key) {
+      const int c = key.compare(0, prefix.size(), prefix);
+      return c < 0 || (c == 0 && key.substr(prefix.size()) < sep);
+    });
+  const auto last = std::partition_point(first, sorted_keys.end(),
+    [&](std::string_view key) {
+      return key.starts_with(prefix) &&
+        key.substr(prefix.size()).starts_with(sep);
+    });
+  return {KeyId(first - begin), KeyId(last - begin)};
 }
 
-std::optional<V> get(const S& s, const K& key) {
-  switch(key_index(key)){
-    case 0: // "watch"
+std::optional<V> get(const S& s, KeyId id) {
+  switch(id){
+    case KeyId::watch:
       return s.watch;
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-void set(S& s, const K& key, const V& value) {
-  switch(key_index(key)){
-    case 0: // "watch"
+std::optional<V> get(const S& s, std::string_view key) {
+  return get(s, key_id(key));
+}
+
+void set(S& s, KeyId id, const V& value) {
+  switch(id){
+    case KeyId::watch:
       s.watch = std::get<bool>(value); break;
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-void unset(S& s, const K& key) {
-  switch(key_index(key)){
-    default: throw non_optional_key(key);
+void set(S& s, std::string_view key, const V& value) {
+  return set(s, key_id(key), value);
+}
+
+void unset(S& s, KeyId id) {
+  switch(id){
+    default: throw non_optional_key(key_name(id));
+  }
+}
+
+void unset(S& s, std::string_view key) {
+  return unset(s, key_id(key));
+}
+
+const S& defaults() {
+  static const S s{};
+  return s;
+}
+
+void reset(S& s, KeyId id) {
+  switch(id){
+    case KeyId::watch:
+      s.watch = defaults().watch; break;
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+void reset(S& s, std::string_view key) {
+  return reset(s, key_id(key));
+}
+
+void reset_subtree(S& s, std::string_view prefix) {
+  const auto [first, last] = key_range(prefix);
+  for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i)
+    reset(s, static_cast<KeyId>(i));
+}
+
+KeySet non_default_mask(const S& s) {
+  const S& d = defaults();
+  KeySet m;
+  m[0] = s.watch != d.watch;
+  return m;
+}
+
+uint64_t field_fingerprint(const S& s, KeyId id) {
+  const uint64_t seed = fingerprint_seeds[static_cast<size_t>(id)];
+  switch(id){
+    case KeyId::watch: return field_hash(seed, s.watch);
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+uint64_t fingerprint(const S& s) {
+  uint64_t h = 0;
+  h ^= field_hash(fingerprint_seeds[0], s.watch);
+  return h;
+}
+
+uint64_t fingerprint([[maybe_unused]] const S& s, [[maybe_unused]] Impact mask) {
+  uint64_t h = 0;
+  return h;
+}
+
+void set(S& s, KeyId id, const V& value, uint64_t& fingerprint) {
+  const uint64_t previous = field_fingerprint(s, id);
+  set(s, id, value);
+  fingerprint ^= previous ^ field_fingerprint(s, id);
+}
+
+void unset(S& s, KeyId id, uint64_t& fingerprint) {
+  const uint64_t previous = field_fingerprint(s, id);
+  unset(s, id);
+  fingerprint ^= previous ^ field_fingerprint(s, id);
+}
+
+void apply(S& s, const Diff& diff, uint64_t& fingerprint) {
+  for (const auto& [id, value] : diff)
+    if (value.has_value())
+      set(s, id, value.value(), fingerprint);
+    else
+      unset(s, id, fingerprint);
+}
+
+void apply(S& s, const Diff& diff, uint64_t& fingerprint, Impact mask) {
+  for (const auto& [id, value] : diff) {
+    const bool tracked = key_impact(id) & mask;
+    const uint64_t previous = tracked ? field_fingerprint(s, id) : 0;
+    if (value.has_value())
+      set(s, id, value.value());
+    else
+      unset(s, id);
+    if (tracked)
+      fingerprint ^= previous ^ field_fingerprint(s, id);
   }
 }
 
 Diff diff(const S& current, const S& previous) {
   Diff d;
-  if(current.watch != previous.watch) d[keys.watch] = current.watch;
+  if(current.watch != previous.watch) d[KeyId::watch] = current.watch;
+  return d;
+}
+
+Diff edit_diff(const S& current, const S& previous) {
+  Diff d;
+  if(current.watch != previous.watch) d[KeyId::watch] = current.watch;
   return d;
 }
 
 void apply(S& s, const Diff& diff) {
-  for (const auto item : diff)
-    if (item.second.has_value())
-      set(s, item.first, item.second.value());
+  for (const auto& [id, value] : diff)
+    if (value.has_value())
+      set(s, id, value.value());
     else
-      unset(s, item.first);
+      unset(s, id);
+}
+
+expected<void> try_apply(S& s, const Diff& diff) {
+  for (const auto& [id, value] : diff) {
+    expected<void> checked;
+    switch(id){
+      case KeyId::watch:
+        checked = check_change(s.watch, value, key_name(id)); break;
+      default: return unexpected(conversion_error{conversion_errc::invalid_key, {}, {}});
+    }
+    if (!checked)
+      return checked;
+  }
+  apply(s, diff);
+  return {};
 }
 
-std::string type(const K& key) {
-  switch(key_index(key)){
-    case 0: // "watch"
+Diff compose(const Diff& first, const Diff& second) {
+  Diff d;
+  d.reserve(first.size() + second.size());
+  auto a = first.begin(), b = second.begin();
+  while (a != first.end() || b != second.end())
+    if (b == second.end() || (a != first.end() && a->first < b->first)) {
+      d[a->first] = a->second;
+      ++a;
+    } else {
+      if (a != first.end() && a->first == b->first)
+        ++a;
+      d[b->first] = b->second;
+      ++b;
+    }
+  return d;
+}
+
+Diff invert(const Diff& diff, const S& base) {
+  Diff d;
+  d.reserve(diff.size());
+  for (const auto& item : diff)
+    d[item.first] = get(base, item.first);
+  return d;
+}
+
+Diff restrict(const Diff& diff, std::string_view prefix) {
+  const auto [first, last] = key_range(prefix);
+  Diff d;
+  for (auto it = std::lower_bound(diff.begin(), diff.end(), first,
+         [](const auto& item, KeyId id) { return item.first < id; });
+       it != diff.end() && it->first < last; ++it)
+    d[it->first] = it->second;
+  return d;
+}
+
+std::string type(KeyId id) {
+  switch(id){
+    case KeyId::watch:
       return "bool";
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-V from_string(const K& key, const std::string& value) {
-  switch(key_index(key)){
-    case 0: // "watch"
+std::string type(std::string_view key) {
+  return type(key_id(key));
+}
+
+V from_string(KeyId id, const std::string& value) {
+  switch(id){
+    case KeyId::watch:
       return options_ns::parse_bool(value);
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-V from_json(const K& key, const json& value) {
-  switch(key_index(key)){
-    case 0: // "watch"
+V from_string(std::string_view key, const std::string& value) {
+  return from_string(key_id(key), value);
+}
+
+V from_json(KeyId id, const json& value) {
+  switch(id){
+    case KeyId::watch:
       return options_ns::json_to_bool(value);
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+V from_json(std::string_view key, const json& value) {
+  return from_json(key_id(key), value);
+}
+
+expected<V> try_from_string(KeyId id, const std::string& value) {
+  switch(id){
+    case KeyId::watch:
+      return options_ns::try_parse_bool(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-std::string to_string(const K& key, const V& value) {
-  switch(key_index(key)){
-    case 0: // "watch"
+expected<V> try_from_string(std::string_view key, const std::string& value) {
+  if (const auto id = find_key_id(key))
+    return try_from_string(*id, value);
+  return unexpected(conversion_error{conversion_errc::invalid_key, std::string(key), {}});
+}
+
+expected<V> try_from_json(KeyId id, const json& value) {
+  switch(id){
+    case KeyId::watch:
+      return options_ns::try_json_to_bool(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+expected<V> try_from_json(std::string_view key, const json& value) {
+  if (const auto id = find_key_id(key))
+    return try_from_json(*id, value);
+  return unexpected(conversion_error{conversion_errc::invalid_key, std::string(key), {}});
+}
+
+std::string to_string(KeyId id, const V& value) {
+  switch(id){
+    case KeyId::watch:
       return options_ns::format_bool(std::get<bool>(value));
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
+std::string to_string(std::string_view key, const V& value) {
+  return to_string(key_id(key), value);
+}
+
+json to_json(KeyId id, const V& value) {
+  switch(id){
+    case KeyId::watch:
+      return options_ns::bool_to_json(std::get<bool>(value));
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+json to_json(std::string_view key, const V& value) {
+  return to_json(key_id(key), value);
+}
+
 } // namespace options_ns::app_options_io
 
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace options_ns::f3d_options_io {
 
-const std::array<K, 56> sorted_keys = {
+constexpr std::array<std::string_view, 59> sorted_keys = {
   keys.camera.azimuth_angle, // 0 "camera.azimuth_angle"
   keys.camera.direction, // 1 "camera.direction"
   keys.camera.elevation_angle, // 2 "camera.elevation_angle"
@@ -117,650 +377,1860 @@ const std::array<K, 56> sorted_keys = {
   keys.model.scivis.cells, // 22 "model.scivis.cells"
   keys.model.scivis.colormap, // 23 "model.scivis.colormap"
   keys.model.scivis.component, // 24 "model.scivis.component"
-  keys.model.volume.enable, // 25 "model.volume.enable"
-  keys.model.volume.inverse, // 26 "model.volume.inverse"
-  keys.render.background.blur.coc, // 27 "render.background.blur.coc"
-  keys.render.background.blur.enable, // 28 "render.background.blur.enable"
-  keys.render.background.color, // 29 "render.background.color"
-  keys.render.background.hdri, // 30 "render.background.hdri"
-  keys.render.effect.ambient_occlusion, // 31 "render.effect.ambient_occlusion"
-  keys.render.effect.anti_aliasing, // 32 "render.effect.anti_aliasing"
-  keys.render.effect.tone_mapping, // 33 "render.effect.tone_mapping"
-  keys.render.effect.translucency_support, // 34 "render.effect.translucency_support"
-  keys.render.grid.absolute, // 35 "render.grid.absolute"
-  keys.render.grid.enable, // 36 "render.grid.enable"
-  keys.render.grid.subdivisions, // 37 "render.grid.subdivisions"
-  keys.render.grid.unit, // 38 "render.grid.unit"
-  keys.render.line_width, // 39 "render.line_width"
-  keys.render.point_size, // 40 "render.point_size"
-  keys.render.raytracing.denoise, // 41 "render.raytracing.denoise"
-  keys.render.raytracing.enable, // 42 "render.raytracing.enable"
-  keys.render.raytracing.samples, // 43 "render.raytracing.samples"
-  keys.render.show_edges, // 44 "render.show_edges"
-  keys.scene.animation.frame_rate, // 45 "scene.animation.frame_rate"
-  keys.scene.animation.index, // 46 "scene.animation.index"
-  keys.scene.animation.speed_factor, // 47 "scene.animation.speed_factor"
-  keys.scene.camera.index, // 48 "scene.camera.index"
-  keys.scene.up_direction, // 49 "scene.up_direction"
-  keys.ui.bar, // 50 "ui.bar"
-  keys.ui.filename, // 51 "ui.filename"
-  keys.ui.font_file, // 52 "ui.font_file"
-  keys.ui.fps, // 53 "ui.fps"
-  keys.ui.loader_progress, // 54 "ui.loader_progress"
-  keys.ui.metadata, // 55 "ui.metadata"
+  keys.model.scivis.range, // 25 "model.scivis.range"
+  keys.model.volume.enable, // 26 "model.volume.enable"
+  keys.model.volume.inverse, // 27 "model.volume.inverse"
+  keys.model.volume.opacity_map, // 28 "model.volume.opacity_map"
+  keys.render.background.blur.coc, // 29 "render.background.blur.coc"
+  keys.render.background.blur.enable, // 30 "render.background.blur.enable"
+  keys.render.background.color, // 31 "render.background.color"
+  keys.render.background.hdri, // 32 "render.background.hdri"
+  keys.render.effect.ambient_occlusion, // 33 "render.effect.ambient_occlusion"
+  keys.render.effect.anti_aliasing, // 34 "render.effect.anti_aliasing"
+  keys.render.effect.tone_mapping, // 35 "render.effect.tone_mapping"
+  keys.render.effect.translucency_support, // 36 "render.effect.translucency_support"
+  keys.render.grid.absolute, // 37 "render.grid.absolute"
+  keys.render.grid.enable, // 38 "render.grid.enable"
+  keys.render.grid.subdivisions, // 39 "render.grid.subdivisions"
+  keys.render.grid.unit, // 40 "render.grid.unit"
+  keys.render.line_width, // 41 "render.line_width"
+  keys.render.point_size, // 42 "render.point_size"
+  keys.render.raytracing.denoise, // 43 "render.raytracing.denoise"
+  keys.render.raytracing.enable, // 44 "render.raytracing.enable"
+  keys.render.raytracing.samples, // 45 "render.raytracing.samples"
+  keys.render.show_edges, // 46 "render.show_edges"
+  keys.scene.animation.frame_rate, // 47 "scene.animation.frame_rate"
+  keys.scene.animation.index, // 48 "scene.animation.index"
+  keys.scene.animation.speed_factor, // 49 "scene.animation.speed_factor"
+  keys.scene.camera.index, // 50 "scene.camera.index"
+  keys.scene.reader_options, // 51 "scene.reader_options"
+  keys.scene.up_direction, // 52 "scene.up_direction"
+  keys.ui.bar, // 53 "ui.bar"
+  keys.ui.filename, // 54 "ui.filename"
+  keys.ui.font_file, // 55 "ui.font_file"
+  keys.ui.fps, // 56 "ui.fps"
+  keys.ui.loader_progress, // 57 "ui.loader_progress"
+  keys.ui.metadata, // 58 "ui.metadata"
 };
 
-inline size_t key_index(const K& key) {
-  const auto lower = std::lower_bound(sorted_keys.begin(), sorted_keys.end(), key);
-  if (lower == sorted_keys.end() || *lower != key)
-    throw invalid_key(key);
+/* hashes of `sorted_keys`, see `structio.py:fingerprint_seed()` */
+constexpr std::array<uint64_t, 59> fingerprint_seeds = {
+  0xDEEC9852A8ABDE70, // "camera.azimuth_angle"
+  0xAA1AA6A7F2F66641, // "camera.direction"
+  0x8056324981CA60AB, // "camera.elevation_angle"
+  0x317C47B8F3611E8C, // "camera.focal_point"
+  0xC1415B2D7A132AC3, // "camera.position"
+  0x6950D38A79B12A69, // "camera.view_angle"
+  0xA7FF8B447AF71007, // "camera.view_up"
+  0xC3A1B1EA20776987, // "camera.zoom_factor"
+  0x5F60EAA4F031A109, // "interactor.axis"
+  0xD441969BEAB3CF92, // "interactor.trackball"
+  0x03B5B2E821355564, // "model.color.opacity"
+  0x4D5978476A08857E, // "model.color.rgb"
+  0x0DA99D5BC7C15756, // "model.color.texture"
+  0xF06C5276A4CD8DF0, // "model.emissive.factor"
+  0x6148BC6D2EC5C95E, // "model.emissive.texture"
+  0x926D493F7DDBA99B, // "model.matcap.texture"
+  0x82C0A406846724DC, // "model.material.metallic"
+  0x10E6BEE85A405A81, // "model.material.roughness"
+  0xCB4309AD8EEF7E90, // "model.material.texture"
+  0x27C6D06779676A9B, // "model.normal.scale"
+  0x059AD0AB9A7EF212, // "model.normal.texture"
+  0xC7660A75401C7864, // "model.point_sprites.enable"
+  0xD70DBFD55AEB93A6, // "model.scivis.cells"
+  0xF60F923077E18242, // "model.scivis.colormap"
+  0x5A5687E8795A1654, // "model.scivis.component"
+  0x6C9F6268BBA68166, // "model.scivis.range"
+  0x9AAB2B8264FE946F, // "model.volume.enable"
+  0xC7FBE35B4C63E9FC, // "model.volume.inverse"
+  0x9A459B7877A3E928, // "model.volume.opacity_map"
+  0x1316CD2FFD095C55, // "render.background.blur.coc"
+  0x893F736807F61FF1, // "render.background.blur.enable"
+  0x6EE307115D6CCF18, // "render.background.color"
+  0x85D5973BEDA2D238, // "render.background.hdri"
+  0x6A3892774C40F72C, // "render.effect.ambient_occlusion"
+  0xDAF35D6A2A9C039B, // "render.effect.anti_aliasing"
+  0x1D79785A55F0A67B, // "render.effect.tone_mapping"
+  0x03DFF723ED31AA0F, // "render.effect.translucency_support"
+  0x98DA125A925B7C20, // "render.grid.absolute"
+  0x2B923CCFFFF8937A, // "render.grid.enable"
+  0x1B40737C21656793, // "render.grid.subdivisions"
+  0xDB35A20AAD99E84B, // "render.grid.unit"
+  0xBC592A6AAC99CE10, // "render.line_width"
+  0x9A38B90DC5B2403F, // "render.point_size"
+  0xC4945D13F3F4398E, // "render.raytracing.denoise"
+  0xEC33BCF5A9A9D6B8, // "render.raytracing.enable"
+  0x3AF13BF90F7884EA, // "render.raytracing.samples"
+  0x21279FAEEA118E95, // "render.show_edges"
+  0x8AA18DD805F3C3E7, // "scene.animation.frame_rate"
+  0xB59D1B5BCD9DCDA9, // "scene.animation.index"
+  0x470C04A44A39BE2C, // "scene.animation.speed_factor"
+  0x3C2B7C851968A646, // "scene.camera.index"
+  0xF8DB5A96921F6955, // "scene.reader_options"
+  0x122244A99F7DA6A0, // "scene.up_direction"
+  0x86E546D8DF862150, // "ui.bar"
+  0x8896AFBA952DFAFA, // "ui.filename"
+  0x255EA927270A42E5, // "ui.font_file"
+  0x62C5A3D8CAA4D376, // "ui.fps"
+  0xD6131551CE81AFF2, // "ui.loader_progress"
+  0x68CF1E2226F05A72, // "ui.metadata"
+};
+
+constexpr uint32_t key_hash(uint32_t seed, std::string_view key) {
+  uint32_t h = seed ? seed : 0x811c9dc5u;
+  for (const unsigned char c : key)
+    h = (h ^ c) * 0x01000193u;
+  return h;
+}
+
+/* perfect hash of `sorted_keys`, see `structio.py:perfect_hash()` */
+constexpr std::array<int32_t, 59> key_hash_seeds = {
+  -1, -9, 2, -22, -23, -24, 0, 0, 0, -28, 1, 1,
+  0, -29, 3, 0, 0, 0, 0, -30, -31, 5, -32, 0,
+  1, -33, -37, -39, 0, 0, 0, 0, 0, 0, 0, 12,
+  -43, -45, -47, -48, 1, 4, 6, -49, -53, 9, 4, 0,
+  -54, 0, 0, 0, 0, 0, -55, 6, -57, 2, -58,
+};
+constexpr std::array<uint16_t, 59> key_hash_slots = {
+  2, 52, 6, 20, 4, 40, 32, 30, 45, 56, 41, 9,
+  14, 35, 7, 54, 37, 12, 33, 51, 3, 22, 58, 42,
+  17, 34, 46, 28, 47, 38, 24, 10, 16, 50, 26, 31,
+  25, 57, 43, 1, 53, 44, 23, 13, 15, 18, 55, 29,
+  48, 36, 5, 27, 0, 49, 8, 39, 19, 21, 11,
+};
+
+/* perfect hash of the names of `cli_flags` */
+constexpr std::array<int32_t, 15> cli_hash_seeds = {
+  1, -2, -3, 1, -4, 0, 0, 0, -7, -9, 0, -14,
+  7, -15, 1,
+};
+constexpr std::array<uint16_t, 15> cli_hash_slots = {
+  7, 11, 5, 9, 12, 8, 0, 2, 14, 13, 6, 3,
+  4, 1, 10,
+};
+
+std::optional<KeyId> find_key_id(std::string_view key) noexcept {
+  const size_t n = sorted_keys.size();
+  const int32_t seed = key_hash_seeds[key_hash(0, key) % n];
+  const size_t slot = seed < 0 ? -seed - 1 : key_hash(seed, key) % n;
+  const size_t index = key_hash_slots[slot];
+  if (sorted_keys[index] != key)
+    return std::nullopt;
   else
-    return std::distance(sorted_keys.begin(), lower);
+    return static_cast<KeyId>(index);
+}
+
+KeyId key_id(std::string_view key) {
+  if (const auto id = find_key_id(key))
+    return *id;
+  else
+    throw invalid_key(key);
 }
 
-std::optional<V> get(const S& s, const K& key) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
+std::string_view key_name(KeyId id) {
+  return sorted_keys.at(static_cast<size_t>(id));
+}
+
+std::pair<KeyId, KeyId> key_range(std::string_view prefix) noexcept {
+  const auto begin = sorted_keys.begin();
+  if (prefix.empty())
+    return {KeyId(0), KeyId(sorted_keys.size())};
+  if (const auto id = find_key_id(prefix))
+    return {*id, KeyId(static_cast<size_t>(*id) + 1)};
+  const std::string_view sep = ".";
+  const auto first = std::partition_point(begin, sorted_keys.end(),
+    [&](std::string_view key) {
+      const int c = key.compare(0, prefix.size(), prefix);
+      return c < 0 || (c == 0 && key.substr(prefix.size()) < sep);
+    });
+  const auto last = std::partition_point(first, sorted_keys.end(),
+    [&](std::string_view key) {
+      return key.starts_with(prefix) &&
+        key.substr(prefix.size()).starts_with(sep);
+    });
+  return {KeyId(first - begin), KeyId(last - begin)};
+}
+
+std::optional<V> get(const S& s, KeyId id) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
       return s.camera.azimuth_angle;
-    case 1: // "camera.direction"
+    case KeyId::camera_direction:
       return s.camera.direction;
-    case 2: // "camera.elevation_angle"
+    case KeyId::camera_elevation_angle:
       return s.camera.elevation_angle;
-    case 3: // "camera.focal_point"
+    case KeyId::camera_focal_point:
       return s.camera.focal_point;
-    case 4: // "camera.position"
+    case KeyId::camera_position:
       return s.camera.position;
-    case 5: // "camera.view_angle"
+    case KeyId::camera_view_angle:
       return s.camera.view_angle;
-    case 6: // "camera.view_up"
+    case KeyId::camera_view_up:
       return s.camera.view_up;
-    case 7: // "camera.zoom_factor"
+    case KeyId::camera_zoom_factor:
       return s.camera.zoom_factor;
-    case 8: // "interactor.axis"
+    case KeyId::interactor_axis:
       return s.interactor.axis;
-    case 9: // "interactor.trackball"
+    case KeyId::interactor_trackball:
       return s.interactor.trackball;
-    case 10: // "model.color.opacity"
+    case KeyId::model_color_opacity:
       return s.model.color.opacity;
-    case 11: // "model.color.rgb"
+    case KeyId::model_color_rgb:
       return s.model.color.rgb;
-    case 12: // "model.color.texture"
+    case KeyId::model_color_texture:
       return s.model.color.texture;
-    case 13: // "model.emissive.factor"
+    case KeyId::model_emissive_factor:
       return s.model.emissive.factor;
-    case 14: // "model.emissive.texture"
+    case KeyId::model_emissive_texture:
       return s.model.emissive.texture;
-    case 15: // "model.matcap.texture"
+    case KeyId::model_matcap_texture:
       return s.model.matcap.texture;
-    case 16: // "model.material.metallic"
+    case KeyId::model_material_metallic:
       return s.model.material.metallic;
-    case 17: // "model.material.roughness"
+    case KeyId::model_material_roughness:
       return s.model.material.roughness;
-    case 18: // "model.material.texture"
+    case KeyId::model_material_texture:
       return s.model.material.texture;
-    case 19: // "model.normal.scale"
+    case KeyId::model_normal_scale:
       return s.model.normal.scale;
-    case 20: // "model.normal.texture"
+    case KeyId::model_normal_texture:
       return s.model.normal.texture;
-    case 21: // "model.point_sprites.enable"
+    case KeyId::model_point_sprites_enable:
       return s.model.point_sprites.enable;
-    case 22: // "model.scivis.cells"
+    case KeyId::model_scivis_cells:
       return s.model.scivis.cells;
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       return s.model.scivis.colormap;
-    case 24: // "model.scivis.component"
+    case KeyId::model_scivis_component:
       return s.model.scivis.component;
-    case 25: // "model.volume.enable"
+    case KeyId::model_scivis_range:
+      return s.model.scivis.range;
+    case KeyId::model_volume_enable:
       return s.model.volume.enable;
-    case 26: // "model.volume.inverse"
+    case KeyId::model_volume_inverse:
       return s.model.volume.inverse;
-    case 27: // "render.background.blur.coc"
+    case KeyId::model_volume_opacity_map:
+      return s.model.volume.opacity_map;
+    case KeyId::render_background_blur_coc:
       return s.render.background.blur.coc;
-    case 28: // "render.background.blur.enable"
+    case KeyId::render_background_blur_enable:
       return s.render.background.blur.enable;
-    case 29: // "render.background.color"
+    case KeyId::render_background_color:
       return s.render.background.color;
-    case 30: // "render.background.hdri"
+    case KeyId::render_background_hdri:
       return s.render.background.hdri;
-    case 31: // "render.effect.ambient_occlusion"
+    case KeyId::render_effect_ambient_occlusion:
       return s.render.effect.ambient_occlusion;
-    case 32: // "render.effect.anti_aliasing"
+    case KeyId::render_effect_anti_aliasing:
       return s.render.effect.anti_aliasing;
-    case 33: // "render.effect.tone_mapping"
+    case KeyId::render_effect_tone_mapping:
       return s.render.effect.tone_mapping;
-    case 34: // "render.effect.translucency_support"
+    case KeyId::render_effect_translucency_support:
       return s.render.effect.translucency_support;
-    case 35: // "render.grid.absolute"
+    case KeyId::render_grid_absolute:
       return s.render.grid.absolute;
-    case 36: // "render.grid.enable"
+    case KeyId::render_grid_enable:
       return s.render.grid.enable;
-    case 37: // "render.grid.subdivisions"
+    case KeyId::render_grid_subdivisions:
       return s.render.grid.subdivisions;
-    case 38: // "render.grid.unit"
+    case KeyId::render_grid_unit:
       return s.render.grid.unit;
-    case 39: // "render.line_width"
+    case KeyId::render_line_width:
       return s.render.line_width;
-    case 40: // "render.point_size"
+    case KeyId::render_point_size:
       return s.render.point_size;
-    case 41: // "render.raytracing.denoise"
+    case KeyId::render_raytracing_denoise:
       return s.render.raytracing.denoise;
-    case 42: // "render.raytracing.enable"
+    case KeyId::render_raytracing_enable:
       return s.render.raytracing.enable;
-    case 43: // "render.raytracing.samples"
+    case KeyId::render_raytracing_samples:
       return s.render.raytracing.samples;
-    case 44: // "render.show_edges"
+    case KeyId::render_show_edges:
       return s.render.show_edges;
-    case 45: // "scene.animation.frame_rate"
+    case KeyId::scene_animation_frame_rate:
       return s.scene.animation.frame_rate;
-    case 46: // "scene.animation.index"
+    case KeyId::scene_animation_index:
       return s.scene.animation.index;
-    case 47: // "scene.animation.speed_factor"
+    case KeyId::scene_animation_speed_factor:
       return s.scene.animation.speed_factor;
-    case 48: // "scene.camera.index"
+    case KeyId::scene_camera_index:
       return s.scene.camera.index;
-    case 49: // "scene.up_direction"
+    case KeyId::scene_reader_options:
+      return s.scene.reader_options;
+    case KeyId::scene_up_direction:
       return s.scene.up_direction;
-    case 50: // "ui.bar"
+    case KeyId::ui_bar:
       return s.ui.bar;
-    case 51: // "ui.filename"
+    case KeyId::ui_filename:
       return s.ui.filename;
-    case 52: // "ui.font_file"
+    case KeyId::ui_font_file:
       return s.ui.font_file;
-    case 53: // "ui.fps"
+    case KeyId::ui_fps:
       return s.ui.fps;
-    case 54: // "ui.loader_progress"
+    case KeyId::ui_loader_progress:
       return s.ui.loader_progress;
-    case 55: // "ui.metadata"
+    case KeyId::ui_metadata:
       return s.ui.metadata;
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-void set(S& s, const K& key, const V& value) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
+std::optional<V> get(const S& s, std::string_view key) {
+  return get(s, key_id(key));
+}
+
+void set(S& s, KeyId id, const V& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
       s.camera.azimuth_angle = std::get<double>(value); break;
-    case 1: // "camera.direction"
+    case KeyId::camera_direction:
       s.camera.direction = std::get<std::array<double, 3>>(value); break;
-    case 2: // "camera.elevation_angle"
+    case KeyId::camera_elevation_angle:
       s.camera.elevation_angle = std::get<double>(value); break;
-    case 3: // "camera.focal_point"
+    case KeyId::camera_focal_point:
       s.camera.focal_point = std::get<std::array<double, 3>>(value); break;
-    case 4: // "camera.position"
+    case KeyId::camera_position:
       s.camera.position = std::get<std::array<double, 3>>(value); break;
-    case 5: // "camera.view_angle"
+    case KeyId::camera_view_angle:
       s.camera.view_angle = std::get<double>(value); break;
-    case 6: // "camera.view_up"
+    case KeyId::camera_view_up:
       s.camera.view_up = std::get<std::array<double, 3>>(value); break;
-    case 7: // "camera.zoom_factor"
+    case KeyId::camera_zoom_factor:
       s.camera.zoom_factor = std::get<double>(value); break;
-    case 8: // "interactor.axis"
+    case KeyId::interactor_axis:
       s.interactor.axis = std::get<bool>(value); break;
-    case 9: // "interactor.trackball"
+    case KeyId::interactor_trackball:
       s.interactor.trackball = std::get<bool>(value); break;
-    case 10: // "model.color.opacity"
+    case KeyId::model_color_opacity:
       s.model.color.opacity = std::get<double>(value); break;
-    case 11: // "model.color.rgb"
+    case KeyId::model_color_rgb:
       s.model.color.rgb = std::get<std::array<double, 3>>(value); break;
-    case 12: // "model.color.texture"
+    case KeyId::model_color_texture:
       s.model.color.texture = std::get<std::basic_string<char>>(value); break;
-    case 13: // "model.emissive.factor"
+    case KeyId::model_emissive_factor:
       s.model.emissive.factor = std::get<std::array<double, 3>>(value); break;
-    case 14: // "model.emissive.texture"
+    case KeyId::model_emissive_texture:
       s.model.emissive.texture = std::get<std::basic_string<char>>(value); break;
-    case 15: // "model.matcap.texture"
+    case KeyId::model_matcap_texture:
       s.model.matcap.texture = std::get<std::basic_string<char>>(value); break;
-    case 16: // "model.material.metallic"
+    case KeyId::model_material_metallic:
       s.model.material.metallic = std::get<double>(value); break;
-    case 17: // "model.material.roughness"
+    case KeyId::model_material_roughness:
       s.model.material.roughness = std::get<double>(value); break;
-    case 18: // "model.material.texture"
+    case KeyId::model_material_texture:
       s.model.material.texture = std::get<std::basic_string<char>>(value); break;
-    case 19: // "model.normal.scale"
+    case KeyId::model_normal_scale:
       s.model.normal.scale = std::get<double>(value); break;
-    case 20: // "model.normal.texture"
+    case KeyId::model_normal_texture:
       s.model.normal.texture = std::get<std::basic_string<char>>(value); break;
-    case 21: // "model.point_sprites.enable"
+    case KeyId::model_point_sprites_enable:
       s.model.point_sprites.enable = std::get<bool>(value); break;
-    case 22: // "model.scivis.cells"
+    case KeyId::model_scivis_cells:
       s.model.scivis.cells = std::get<bool>(value); break;
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       s.model.scivis.colormap = std::get<Colormap_t>(value); break;
-    case 24: // "model.scivis.component"
+    case KeyId::model_scivis_component:
       s.model.scivis.component = std::get<int>(value); break;
-    case 25: // "model.volume.enable"
+    case KeyId::model_scivis_range:
+      s.model.scivis.range = std::get<std::pair<double, double>>(value); break;
+    case KeyId::model_volume_enable:
       s.model.volume.enable = std::get<bool>(value); break;
-    case 26: // "model.volume.inverse"
+    case KeyId::model_volume_inverse:
       s.model.volume.inverse = std::get<bool>(value); break;
-    case 27: // "render.background.blur.coc"
+    case KeyId::model_volume_opacity_map:
+      assign_value(s.model.volume.opacity_map, value); break;
+    case KeyId::render_background_blur_coc:
       s.render.background.blur.coc = std::get<double>(value); break;
-    case 28: // "render.background.blur.enable"
+    case KeyId::render_background_blur_enable:
       s.render.background.blur.enable = std::get<bool>(value); break;
-    case 29: // "render.background.color"
+    case KeyId::render_background_color:
       s.render.background.color = std::get<std::array<double, 3>>(value); break;
-    case 30: // "render.background.hdri"
+    case KeyId::render_background_hdri:
       s.render.background.hdri = std::get<std::basic_string<char>>(value); break;
-    case 31: // "render.effect.ambient_occlusion"
+    case KeyId::render_effect_ambient_occlusion:
       s.render.effect.ambient_occlusion = std::get<bool>(value); break;
-    case 32: // "render.effect.anti_aliasing"
+    case KeyId::render_effect_anti_aliasing:
       s.render.effect.anti_aliasing = std::get<bool>(value); break;
-    case 33: // "render.effect.tone_mapping"
+    case KeyId::render_effect_tone_mapping:
       s.render.effect.tone_mapping = std::get<bool>(value); break;
-    case 34: // "render.effect.translucency_support"
+    case KeyId::render_effect_translucency_support:
       s.render.effect.translucency_support = std::get<bool>(value); break;
-    case 35: // "render.grid.absolute"
+    case KeyId::render_grid_absolute:
       s.render.grid.absolute = std::get<bool>(value); break;
-    case 36: // "render.grid.enable"
+    case KeyId::render_grid_enable:
       s.render.grid.enable = std::get<bool>(value); break;
-    case 37: // "render.grid.subdivisions"
+    case KeyId::render_grid_subdivisions:
       s.render.grid.subdivisions = std::get<int>(value); break;
-    case 38: // "render.grid.unit"
+    case KeyId::render_grid_unit:
       s.render.grid.unit = std::get<double>(value); break;
-    case 39: // "render.line_width"
+    case KeyId::render_line_width:
       s.render.line_width = std::get<double>(value); break;
-    case 40: // "render.point_size"
+    case KeyId::render_point_size:
       s.render.point_size = std::get<double>(value); break;
-    case 41: // "render.raytracing.denoise"
+    case KeyId::render_raytracing_denoise:
       s.render.raytracing.denoise = std::get<bool>(value); break;
-    case 42: // "render.raytracing.enable"
+    case KeyId::render_raytracing_enable:
       s.render.raytracing.enable = std::get<bool>(value); break;
-    case 43: // "render.raytracing.samples"
+    case KeyId::render_raytracing_samples:
       s.render.raytracing.samples = std::get<int>(value); break;
-    case 44: // "render.show_edges"
+    case KeyId::render_show_edges:
       s.render.show_edges = std::get<bool>(value); break;
-    case 45: // "scene.animation.frame_rate"
+    case KeyId::scene_animation_frame_rate:
       s.scene.animation.frame_rate = std::get<double>(value); break;
-    case 46: // "scene.animation.index"
+    case KeyId::scene_animation_index:
       s.scene.animation.index = std::get<int>(value); break;
-    case 47: // "scene.animation.speed_factor"
+    case KeyId::scene_animation_speed_factor:
       s.scene.animation.speed_factor = std::get<double>(value); break;
-    case 48: // "scene.camera.index"
+    case KeyId::scene_camera_index:
       s.scene.camera.index = std::get<int>(value); break;
-    case 49: // "scene.up_direction"
+    case KeyId::scene_reader_options:
+      s.scene.reader_options = std::get<std::map<std::basic_string<char>, std::basic_string<char>>>(value); break;
+    case KeyId::scene_up_direction:
       s.scene.up_direction = std::get<std::array<double, 3>>(value); break;
-    case 50: // "ui.bar"
+    case KeyId::ui_bar:
       s.ui.bar = std::get<bool>(value); break;
-    case 51: // "ui.filename"
+    case KeyId::ui_filename:
       s.ui.filename = std::get<bool>(value); break;
-    case 52: // "ui.font_file"
+    case KeyId::ui_font_file:
       s.ui.font_file = std::get<std::basic_string<char>>(value); break;
-    case 53: // "ui.fps"
+    case KeyId::ui_fps:
       s.ui.fps = std::get<bool>(value); break;
-    case 54: // "ui.loader_progress"
+    case KeyId::ui_loader_progress:
       s.ui.loader_progress = std::get<bool>(value); break;
-    case 55: // "ui.metadata"
+    case KeyId::ui_metadata:
       s.ui.metadata = std::get<bool>(value); break;
-    default: throw std::invalid_argument(key); // unreachable
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-void unset(S& s, const K& key) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
+void set(S& s, std::string_view key, const V& value) {
+  return set(s, key_id(key), value);
+}
+
+void unset(S& s, KeyId id) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
       s.camera.azimuth_angle = std::nullopt; break;
-    case 2: // "camera.elevation_angle"
+    case KeyId::camera_elevation_angle:
       s.camera.elevation_angle = std::nullopt; break;
-    case 3: // "camera.focal_point"
+    case KeyId::camera_focal_point:
       s.camera.focal_point = std::nullopt; break;
-    case 4: // "camera.position"
+    case KeyId::camera_position:
       s.camera.position = std::nullopt; break;
-    case 6: // "camera.view_up"
+    case KeyId::camera_view_up:
       s.camera.view_up = std::nullopt; break;
-    case 38: // "render.grid.unit"
+    case KeyId::model_scivis_range:
+      s.model.scivis.range = std::nullopt; break;
+    case KeyId::render_grid_unit:
       s.render.grid.unit = std::nullopt; break;
-    case 52: // "ui.font_file"
+    case KeyId::ui_font_file:
       s.ui.font_file = std::nullopt; break;
-    default: throw non_optional_key(key);
+    default: throw non_optional_key(key_name(id));
+  }
+}
+
+void unset(S& s, std::string_view key) {
+  return unset(s, key_id(key));
+}
+
+const S& defaults() {
+  static const S s{};
+  return s;
+}
+
+void reset(S& s, KeyId id) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+      s.camera.azimuth_angle = defaults().camera.azimuth_angle; break;
+    case KeyId::camera_direction:
+      s.camera.direction = defaults().camera.direction; break;
+    case KeyId::camera_elevation_angle:
+      s.camera.elevation_angle = defaults().camera.elevation_angle; break;
+    case KeyId::camera_focal_point:
+      s.camera.focal_point = defaults().camera.focal_point; break;
+    case KeyId::camera_position:
+      s.camera.position = defaults().camera.position; break;
+    case KeyId::camera_view_angle:
+      s.camera.view_angle = defaults().camera.view_angle; break;
+    case KeyId::camera_view_up:
+      s.camera.view_up = defaults().camera.view_up; break;
+    case KeyId::camera_zoom_factor:
+      s.camera.zoom_factor = defaults().camera.zoom_factor; break;
+    case KeyId::interactor_axis:
+      s.interactor.axis = defaults().interactor.axis; break;
+    case KeyId::interactor_trackball:
+      s.interactor.trackball = defaults().interactor.trackball; break;
+    case KeyId::model_color_opacity:
+      s.model.color.opacity = defaults().model.color.opacity; break;
+    case KeyId::model_color_rgb:
+      s.model.color.rgb = defaults().model.color.rgb; break;
+    case KeyId::model_color_texture:
+      s.model.color.texture = defaults().model.color.texture; break;
+    case KeyId::model_emissive_factor:
+      s.model.emissive.factor = defaults().model.emissive.factor; break;
+    case KeyId::model_emissive_texture:
+      s.model.emissive.texture = defaults().model.emissive.texture; break;
+    case KeyId::model_matcap_texture:
+      s.model.matcap.texture = defaults().model.matcap.texture; break;
+    case KeyId::model_material_metallic:
+      s.model.material.metallic = defaults().model.material.metallic; break;
+    case KeyId::model_material_roughness:
+      s.model.material.roughness = defaults().model.material.roughness; break;
+    case KeyId::model_material_texture:
+      s.model.material.texture = defaults().model.material.texture; break;
+    case KeyId::model_normal_scale:
+      s.model.normal.scale = defaults().model.normal.scale; break;
+    case KeyId::model_normal_texture:
+      s.model.normal.texture = defaults().model.normal.texture; break;
+    case KeyId::model_point_sprites_enable:
+      s.model.point_sprites.enable = defaults().model.point_sprites.enable; break;
+    case KeyId::model_scivis_cells:
+      s.model.scivis.cells = defaults().model.scivis.cells; break;
+    case KeyId::model_scivis_colormap:
+      s.model.scivis.colormap = defaults().model.scivis.colormap; break;
+    case KeyId::model_scivis_component:
+      s.model.scivis.component = defaults().model.scivis.component; break;
+    case KeyId::model_scivis_range:
+      s.model.scivis.range = defaults().model.scivis.range; break;
+    case KeyId::model_volume_enable:
+      s.model.volume.enable = defaults().model.volume.enable; break;
+    case KeyId::model_volume_inverse:
+      s.model.volume.inverse = defaults().model.volume.inverse; break;
+    case KeyId::model_volume_opacity_map:
+      s.model.volume.opacity_map = defaults().model.volume.opacity_map; break;
+    case KeyId::render_background_blur_coc:
+      s.render.background.blur.coc = defaults().render.background.blur.coc; break;
+    case KeyId::render_background_blur_enable:
+      s.render.background.blur.enable = defaults().render.background.blur.enable; break;
+    case KeyId::render_background_color:
+      s.render.background.color = defaults().render.background.color; break;
+    case KeyId::render_background_hdri:
+      s.render.background.hdri = defaults().render.background.hdri; break;
+    case KeyId::render_effect_ambient_occlusion:
+      s.render.effect.ambient_occlusion = defaults().render.effect.ambient_occlusion; break;
+    case KeyId::render_effect_anti_aliasing:
+      s.render.effect.anti_aliasing = defaults().render.effect.anti_aliasing; break;
+    case KeyId::render_effect_tone_mapping:
+      s.render.effect.tone_mapping = defaults().render.effect.tone_mapping; break;
+    case KeyId::render_effect_translucency_support:
+      s.render.effect.translucency_support = defaults().render.effect.translucency_support; break;
+    case KeyId::render_grid_absolute:
+      s.render.grid.absolute = defaults().render.grid.absolute; break;
+    case KeyId::render_grid_enable:
+      s.render.grid.enable = defaults().render.grid.enable; break;
+    case KeyId::render_grid_subdivisions:
+      s.render.grid.subdivisions = defaults().render.grid.subdivisions; break;
+    case KeyId::render_grid_unit:
+      s.render.grid.unit = defaults().render.grid.unit; break;
+    case KeyId::render_line_width:
+      s.render.line_width = defaults().render.line_width; break;
+    case KeyId::render_point_size:
+      s.render.point_size = defaults().render.point_size; break;
+    case KeyId::render_raytracing_denoise:
+      s.render.raytracing.denoise = defaults().render.raytracing.denoise; break;
+    case KeyId::render_raytracing_enable:
+      s.render.raytracing.enable = defaults().render.raytracing.enable; break;
+    case KeyId::render_raytracing_samples:
+      s.render.raytracing.samples = defaults().render.raytracing.samples; break;
+    case KeyId::render_show_edges:
+      s.render.show_edges = defaults().render.show_edges; break;
+    case KeyId::scene_animation_frame_rate:
+      s.scene.animation.frame_rate = defaults().scene.animation.frame_rate; break;
+    case KeyId::scene_animation_index:
+      s.scene.animation.index = defaults().scene.animation.index; break;
+    case KeyId::scene_animation_speed_factor:
+      s.scene.animation.speed_factor = defaults().scene.animation.speed_factor; break;
+    case KeyId::scene_camera_index:
+      s.scene.camera.index = defaults().scene.camera.index; break;
+    case KeyId::scene_reader_options:
+      s.scene.reader_options = defaults().scene.reader_options; break;
+    case KeyId::scene_up_direction:
+      s.scene.up_direction = defaults().scene.up_direction; break;
+    case KeyId::ui_bar:
+      s.ui.bar = defaults().ui.bar; break;
+    case KeyId::ui_filename:
+      s.ui.filename = defaults().ui.filename; break;
+    case KeyId::ui_font_file:
+      s.ui.font_file = defaults().ui.font_file; break;
+    case KeyId::ui_fps:
+      s.ui.fps = defaults().ui.fps; break;
+    case KeyId::ui_loader_progress:
+      s.ui.loader_progress = defaults().ui.loader_progress; break;
+    case KeyId::ui_metadata:
+      s.ui.metadata = defaults().ui.metadata; break;
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+void reset(S& s, std::string_view key) {
+  return reset(s, key_id(key));
+}
+
+void reset_subtree(S& s, std::string_view prefix) {
+  const auto [first, last] = key_range(prefix);
+  for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i)
+    reset(s, static_cast<KeyId>(i));
+}
+
+KeySet non_default_mask(const S& s) {
+  const S& d = defaults();
+  KeySet m;
+  m[0] = s.camera.azimuth_angle != d.camera.azimuth_angle;
+  m[1] = s.camera.direction != d.camera.direction;
+  m[2] = s.camera.elevation_angle != d.camera.elevation_angle;
+  m[3] = s.camera.focal_point != d.camera.focal_point;
+  m[4] = s.camera.position != d.camera.position;
+  m[5] = s.camera.view_angle != d.camera.view_angle;
+  m[6] = s.camera.view_up != d.camera.view_up;
+  m[7] = s.camera.zoom_factor != d.camera.zoom_factor;
+  m[8] = s.interactor.axis != d.interactor.axis;
+  m[9] = s.interactor.trackball != d.interactor.trackball;
+  m[10] = s.model.color.opacity != d.model.color.opacity;
+  m[11] = s.model.color.rgb != d.model.color.rgb;
+  m[12] = s.model.color.texture != d.model.color.texture;
+  m[13] = s.model.emissive.factor != d.model.emissive.factor;
+  m[14] = s.model.emissive.texture != d.model.emissive.texture;
+  m[15] = s.model.matcap.texture != d.model.matcap.texture;
+  m[16] = s.model.material.metallic != d.model.material.metallic;
+  m[17] = s.model.material.roughness != d.model.material.roughness;
+  m[18] = s.model.material.texture != d.model.material.texture;
+  m[19] = s.model.normal.scale != d.model.normal.scale;
+  m[20] = s.model.normal.texture != d.model.normal.texture;
+  m[21] = s.model.point_sprites.enable != d.model.point_sprites.enable;
+  m[22] = s.model.scivis.cells != d.model.scivis.cells;
+  m[23] = s.model.scivis.colormap != d.model.scivis.colormap;
+  m[24] = s.model.scivis.component != d.model.scivis.component;
+  m[25] = s.model.scivis.range != d.model.scivis.range;
+  m[26] = s.model.volume.enable != d.model.volume.enable;
+  m[27] = s.model.volume.inverse != d.model.volume.inverse;
+  m[28] = s.model.volume.opacity_map != d.model.volume.opacity_map;
+  m[29] = s.render.background.blur.coc != d.render.background.blur.coc;
+  m[30] = s.render.background.blur.enable != d.render.background.blur.enable;
+  m[31] = s.render.background.color != d.render.background.color;
+  m[32] = s.render.background.hdri != d.render.background.hdri;
+  m[33] = s.render.effect.ambient_occlusion != d.render.effect.ambient_occlusion;
+  m[34] = s.render.effect.anti_aliasing != d.render.effect.anti_aliasing;
+  m[35] = s.render.effect.tone_mapping != d.render.effect.tone_mapping;
+  m[36] = s.render.effect.translucency_support != d.render.effect.translucency_support;
+  m[37] = s.render.grid.absolute != d.render.grid.absolute;
+  m[38] = s.render.grid.enable != d.render.grid.enable;
+  m[39] = s.render.grid.subdivisions != d.render.grid.subdivisions;
+  m[40] = s.render.grid.unit != d.render.grid.unit;
+  m[41] = s.render.line_width != d.render.line_width;
+  m[42] = s.render.point_size != d.render.point_size;
+  m[43] = s.render.raytracing.denoise != d.render.raytracing.denoise;
+  m[44] = s.render.raytracing.enable != d.render.raytracing.enable;
+  m[45] = s.render.raytracing.samples != d.render.raytracing.samples;
+  m[46] = s.render.show_edges != d.render.show_edges;
+  m[47] = s.scene.animation.frame_rate != d.scene.animation.frame_rate;
+  m[48] = s.scene.animation.index != d.scene.animation.index;
+  m[49] = s.scene.animation.speed_factor != d.scene.animation.speed_factor;
+  m[50] = s.scene.camera.index != d.scene.camera.index;
+  m[51] = s.scene.reader_options != d.scene.reader_options;
+  m[52] = s.scene.up_direction != d.scene.up_direction;
+  m[53] = s.ui.bar != d.ui.bar;
+  m[54] = s.ui.filename != d.ui.filename;
+  m[55] = s.ui.font_file != d.ui.font_file;
+  m[56] = s.ui.fps != d.ui.fps;
+  m[57] = s.ui.loader_progress != d.ui.loader_progress;
+  m[58] = s.ui.metadata != d.ui.metadata;
+  return m;
+}
+
+uint64_t field_fingerprint(const S& s, KeyId id) {
+  const uint64_t seed = fingerprint_seeds[static_cast<size_t>(id)];
+  switch(id){
+    case KeyId::camera_azimuth_angle: return field_hash(seed, s.camera.azimuth_angle);
+    case KeyId::camera_direction: return field_hash(seed, s.camera.direction);
+    case KeyId::camera_elevation_angle: return field_hash(seed, s.camera.elevation_angle);
+    case KeyId::camera_focal_point: return field_hash(seed, s.camera.focal_point);
+    case KeyId::camera_position: return field_hash(seed, s.camera.position);
+    case KeyId::camera_view_angle: return field_hash(seed, s.camera.view_angle);
+    case KeyId::camera_view_up: return field_hash(seed, s.camera.view_up);
+    case KeyId::camera_zoom_factor: return field_hash(seed, s.camera.zoom_factor);
+    case KeyId::interactor_axis: return field_hash(seed, s.interactor.axis);
+    case KeyId::interactor_trackball: return field_hash(seed, s.interactor.trackball);
+    case KeyId::model_color_opacity: return field_hash(seed, s.model.color.opacity);
+    case KeyId::model_color_rgb: return field_hash(seed, s.model.color.rgb);
+    case KeyId::model_color_texture: return field_hash(seed, s.model.color.texture);
+    case KeyId::model_emissive_factor: return field_hash(seed, s.model.emissive.factor);
+    case KeyId::model_emissive_texture: return field_hash(seed, s.model.emissive.texture);
+    case KeyId::model_matcap_texture: return field_hash(seed, s.model.matcap.texture);
+    case KeyId::model_material_metallic: return field_hash(seed, s.model.material.metallic);
+    case KeyId::model_material_roughness: return field_hash(seed, s.model.material.roughness);
+    case KeyId::model_material_texture: return field_hash(seed, s.model.material.texture);
+    case KeyId::model_normal_scale: return field_hash(seed, s.model.normal.scale);
+    case KeyId::model_normal_texture: return field_hash(seed, s.model.normal.texture);
+    case KeyId::model_point_sprites_enable: return field_hash(seed, s.model.point_sprites.enable);
+    case KeyId::model_scivis_cells: return field_hash(seed, s.model.scivis.cells);
+    case KeyId::model_scivis_colormap: return field_hash(seed, s.model.scivis.colormap);
+    case KeyId::model_scivis_component: return field_hash(seed, s.model.scivis.component);
+    case KeyId::model_scivis_range: return field_hash(seed, s.model.scivis.range);
+    case KeyId::model_volume_enable: return field_hash(seed, s.model.volume.enable);
+    case KeyId::model_volume_inverse: return field_hash(seed, s.model.volume.inverse);
+    case KeyId::model_volume_opacity_map: return field_hash(seed, s.model.volume.opacity_map);
+    case KeyId::render_background_blur_coc: return field_hash(seed, s.render.background.blur.coc);
+    case KeyId::render_background_blur_enable: return field_hash(seed, s.render.background.blur.enable);
+    case KeyId::render_background_color: return field_hash(seed, s.render.background.color);
+    case KeyId::render_background_hdri: return field_hash(seed, s.render.background.hdri);
+    case KeyId::render_effect_ambient_occlusion: return field_hash(seed, s.render.effect.ambient_occlusion);
+    case KeyId::render_effect_anti_aliasing: return field_hash(seed, s.render.effect.anti_aliasing);
+    case KeyId::render_effect_tone_mapping: return field_hash(seed, s.render.effect.tone_mapping);
+    case KeyId::render_effect_translucency_support: return field_hash(seed, s.render.effect.translucency_support);
+    case KeyId::render_grid_absolute: return field_hash(seed, s.render.grid.absolute);
+    case KeyId::render_grid_enable: return field_hash(seed, s.render.grid.enable);
+    case KeyId::render_grid_subdivisions: return field_hash(seed, s.render.grid.subdivisions);
+    case KeyId::render_grid_unit: return field_hash(seed, s.render.grid.unit);
+    case KeyId::render_line_width: return field_hash(seed, s.render.line_width);
+    case KeyId::render_point_size: return field_hash(seed, s.render.point_size);
+    case KeyId::render_raytracing_denoise: return field_hash(seed, s.render.raytracing.denoise);
+    case KeyId::render_raytracing_enable: return field_hash(seed, s.render.raytracing.enable);
+    case KeyId::render_raytracing_samples: return field_hash(seed, s.render.raytracing.samples);
+    case KeyId::render_show_edges: return field_hash(seed, s.render.show_edges);
+    case KeyId::scene_animation_frame_rate: return field_hash(seed, s.scene.animation.frame_rate);
+    case KeyId::scene_animation_index: return field_hash(seed, s.scene.animation.index);
+    case KeyId::scene_animation_speed_factor: return field_hash(seed, s.scene.animation.speed_factor);
+    case KeyId::scene_camera_index: return field_hash(seed, s.scene.camera.index);
+    case KeyId::scene_reader_options: return field_hash(seed, s.scene.reader_options);
+    case KeyId::scene_up_direction: return field_hash(seed, s.scene.up_direction);
+    case KeyId::ui_bar: return field_hash(seed, s.ui.bar);
+    case KeyId::ui_filename: return field_hash(seed, s.ui.filename);
+    case KeyId::ui_font_file: return field_hash(seed, s.ui.font_file);
+    case KeyId::ui_fps: return field_hash(seed, s.ui.fps);
+    case KeyId::ui_loader_progress: return field_hash(seed, s.ui.loader_progress);
+    case KeyId::ui_metadata: return field_hash(seed, s.ui.metadata);
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+uint64_t fingerprint(const S& s) {
+  uint64_t h = 0;
+  h ^= field_hash(fingerprint_seeds[0], s.camera.azimuth_angle);
+  h ^= field_hash(fingerprint_seeds[1], s.camera.direction);
+  h ^= field_hash(fingerprint_seeds[2], s.camera.elevation_angle);
+  h ^= field_hash(fingerprint_seeds[3], s.camera.focal_point);
+  h ^= field_hash(fingerprint_seeds[4], s.camera.position);
+  h ^= field_hash(fingerprint_seeds[5], s.camera.view_angle);
+  h ^= field_hash(fingerprint_seeds[6], s.camera.view_up);
+  h ^= field_hash(fingerprint_seeds[7], s.camera.zoom_factor);
+  h ^= field_hash(fingerprint_seeds[8], s.interactor.axis);
+  h ^= field_hash(fingerprint_seeds[9], s.interactor.trackball);
+  h ^= field_hash(fingerprint_seeds[10], s.model.color.opacity);
+  h ^= field_hash(fingerprint_seeds[11], s.model.color.rgb);
+  h ^= field_hash(fingerprint_seeds[12], s.model.color.texture);
+  h ^= field_hash(fingerprint_seeds[13], s.model.emissive.factor);
+  h ^= field_hash(fingerprint_seeds[14], s.model.emissive.texture);
+  h ^= field_hash(fingerprint_seeds[15], s.model.matcap.texture);
+  h ^= field_hash(fingerprint_seeds[16], s.model.material.metallic);
+  h ^= field_hash(fingerprint_seeds[17], s.model.material.roughness);
+  h ^= field_hash(fingerprint_seeds[18], s.model.material.texture);
+  h ^= field_hash(fingerprint_seeds[19], s.model.normal.scale);
+  h ^= field_hash(fingerprint_seeds[20], s.model.normal.texture);
+  h ^= field_hash(fingerprint_seeds[21], s.model.point_sprites.enable);
+  h ^= field_hash(fingerprint_seeds[22], s.model.scivis.cells);
+  h ^= field_hash(fingerprint_seeds[23], s.model.scivis.colormap);
+  h ^= field_hash(fingerprint_seeds[24], s.model.scivis.component);
+  h ^= field_hash(fingerprint_seeds[25], s.model.scivis.range);
+  h ^= field_hash(fingerprint_seeds[26], s.model.volume.enable);
+  h ^= field_hash(fingerprint_seeds[27], s.model.volume.inverse);
+  h ^= field_hash(fingerprint_seeds[28], s.model.volume.opacity_map);
+  h ^= field_hash(fingerprint_seeds[29], s.render.background.blur.coc);
+  h ^= field_hash(fingerprint_seeds[30], s.render.background.blur.enable);
+  h ^= field_hash(fingerprint_seeds[31], s.render.background.color);
+  h ^= field_hash(fingerprint_seeds[32], s.render.background.hdri);
+  h ^= field_hash(fingerprint_seeds[33], s.render.effect.ambient_occlusion);
+  h ^= field_hash(fingerprint_seeds[34], s.render.effect.anti_aliasing);
+  h ^= field_hash(fingerprint_seeds[35], s.render.effect.tone_mapping);
+  h ^= field_hash(fingerprint_seeds[36], s.render.effect.translucency_support);
+  h ^= field_hash(fingerprint_seeds[37], s.render.grid.absolute);
+  h ^= field_hash(fingerprint_seeds[38], s.render.grid.enable);
+  h ^= field_hash(fingerprint_seeds[39], s.render.grid.subdivisions);
+  h ^= field_hash(fingerprint_seeds[40], s.render.grid.unit);
+  h ^= field_hash(fingerprint_seeds[41], s.render.line_width);
+  h ^= field_hash(fingerprint_seeds[42], s.render.point_size);
+  h ^= field_hash(fingerprint_seeds[43], s.render.raytracing.denoise);
+  h ^= field_hash(fingerprint_seeds[44], s.render.raytracing.enable);
+  h ^= field_hash(fingerprint_seeds[45], s.render.raytracing.samples);
+  h ^= field_hash(fingerprint_seeds[46], s.render.show_edges);
+  h ^= field_hash(fingerprint_seeds[47], s.scene.animation.frame_rate);
+  h ^= field_hash(fingerprint_seeds[48], s.scene.animation.index);
+  h ^= field_hash(fingerprint_seeds[49], s.scene.animation.speed_factor);
+  h ^= field_hash(fingerprint_seeds[50], s.scene.camera.index);
+  h ^= field_hash(fingerprint_seeds[51], s.scene.reader_options);
+  h ^= field_hash(fingerprint_seeds[52], s.scene.up_direction);
+  h ^= field_hash(fingerprint_seeds[53], s.ui.bar);
+  h ^= field_hash(fingerprint_seeds[54], s.ui.filename);
+  h ^= field_hash(fingerprint_seeds[55], s.ui.font_file);
+  h ^= field_hash(fingerprint_seeds[56], s.ui.fps);
+  h ^= field_hash(fingerprint_seeds[57], s.ui.loader_progress);
+  h ^= field_hash(fingerprint_seeds[58], s.ui.metadata);
+  return h;
+}
+
+uint64_t fingerprint(const S& s, Impact mask) {
+  uint64_t h = 0;
+  if (key_impacts[8] & mask) h ^= field_hash(fingerprint_seeds[8], s.interactor.axis);
+  if (key_impacts[9] & mask) h ^= field_hash(fingerprint_seeds[9], s.interactor.trackball);
+  if (key_impacts[10] & mask) h ^= field_hash(fingerprint_seeds[10], s.model.color.opacity);
+  if (key_impacts[11] & mask) h ^= field_hash(fingerprint_seeds[11], s.model.color.rgb);
+  if (key_impacts[12] & mask) h ^= field_hash(fingerprint_seeds[12], s.model.color.texture);
+  if (key_impacts[13] & mask) h ^= field_hash(fingerprint_seeds[13], s.model.emissive.factor);
+  if (key_impacts[14] & mask) h ^= field_hash(fingerprint_seeds[14], s.model.emissive.texture);
+  if (key_impacts[15] & mask) h ^= field_hash(fingerprint_seeds[15], s.model.matcap.texture);
+  if (key_impacts[16] & mask) h ^= field_hash(fingerprint_seeds[16], s.model.material.metallic);
+  if (key_impacts[17] & mask) h ^= field_hash(fingerprint_seeds[17], s.model.material.roughness);
+  if (key_impacts[18] & mask) h ^= field_hash(fingerprint_seeds[18], s.model.material.texture);
+  if (key_impacts[19] & mask) h ^= field_hash(fingerprint_seeds[19], s.model.normal.scale);
+  if (key_impacts[20] & mask) h ^= field_hash(fingerprint_seeds[20], s.model.normal.texture);
+  if (key_impacts[21] & mask) h ^= field_hash(fingerprint_seeds[21], s.model.point_sprites.enable);
+  if (key_impacts[22] & mask) h ^= field_hash(fingerprint_seeds[22], s.model.scivis.cells);
+  if (key_impacts[23] & mask) h ^= field_hash(fingerprint_seeds[23], s.model.scivis.colormap);
+  if (key_impacts[24] & mask) h ^= field_hash(fingerprint_seeds[24], s.model.scivis.component);
+  if (key_impacts[25] & mask) h ^= field_hash(fingerprint_seeds[25], s.model.scivis.range);
+  if (key_impacts[26] & mask) h ^= field_hash(fingerprint_seeds[26], s.model.volume.enable);
+  if (key_impacts[27] & mask) h ^= field_hash(fingerprint_seeds[27], s.model.volume.inverse);
+  if (key_impacts[28] & mask) h ^= field_hash(fingerprint_seeds[28], s.model.volume.opacity_map);
+  if (key_impacts[29] & mask) h ^= field_hash(fingerprint_seeds[29], s.render.background.blur.coc);
+  if (key_impacts[30] & mask) h ^= field_hash(fingerprint_seeds[30], s.render.background.blur.enable);
+  if (key_impacts[31] & mask) h ^= field_hash(fingerprint_seeds[31], s.render.background.color);
+  if (key_impacts[32] & mask) h ^= field_hash(fingerprint_seeds[32], s.render.background.hdri);
+  if (key_impacts[33] & mask) h ^= field_hash(fingerprint_seeds[33], s.render.effect.ambient_occlusion);
+  if (key_impacts[34] & mask) h ^= field_hash(fingerprint_seeds[34], s.render.effect.anti_aliasing);
+  if (key_impacts[35] & mask) h ^= field_hash(fingerprint_seeds[35], s.render.effect.tone_mapping);
+  if (key_impacts[36] & mask) h ^= field_hash(fingerprint_seeds[36], s.render.effect.translucency_support);
+  if (key_impacts[37] & mask) h ^= field_hash(fingerprint_seeds[37], s.render.grid.absolute);
+  if (key_impacts[38] & mask) h ^= field_hash(fingerprint_seeds[38], s.render.grid.enable);
+  if (key_impacts[39] & mask) h ^= field_hash(fingerprint_seeds[39], s.render.grid.subdivisions);
+  if (key_impacts[40] & mask) h ^= field_hash(fingerprint_seeds[40], s.render.grid.unit);
+  if (key_impacts[41] & mask) h ^= field_hash(fingerprint_seeds[41], s.render.line_width);
+  if (key_impacts[42] & mask) h ^= field_hash(fingerprint_seeds[42], s.render.point_size);
+  if (key_impacts[43] & mask) h ^= field_hash(fingerprint_seeds[43], s.render.raytracing.denoise);
+  if (key_impacts[44] & mask) h ^= field_hash(fingerprint_seeds[44], s.render.raytracing.enable);
+  if (key_impacts[45] & mask) h ^= field_hash(fingerprint_seeds[45], s.render.raytracing.samples);
+  if (key_impacts[46] & mask) h ^= field_hash(fingerprint_seeds[46], s.render.show_edges);
+  if (key_impacts[47] & mask) h ^= field_hash(fingerprint_seeds[47], s.scene.animation.frame_rate);
+  if (key_impacts[48] & mask) h ^= field_hash(fingerprint_seeds[48], s.scene.animation.index);
+  if (key_impacts[49] & mask) h ^= field_hash(fingerprint_seeds[49], s.scene.animation.speed_factor);
+  if (key_impacts[50] & mask) h ^= field_hash(fingerprint_seeds[50], s.scene.camera.index);
+  if (key_impacts[51] & mask) h ^= field_hash(fingerprint_seeds[51], s.scene.reader_options);
+  if (key_impacts[52] & mask) h ^= field_hash(fingerprint_seeds[52], s.scene.up_direction);
+  if (key_impacts[53] & mask) h ^= field_hash(fingerprint_seeds[53], s.ui.bar);
+  if (key_impacts[54] & mask) h ^= field_hash(fingerprint_seeds[54], s.ui.filename);
+  if (key_impacts[55] & mask) h ^= field_hash(fingerprint_seeds[55], s.ui.font_file);
+  if (key_impacts[56] & mask) h ^= field_hash(fingerprint_seeds[56], s.ui.fps);
+  if (key_impacts[57] & mask) h ^= field_hash(fingerprint_seeds[57], s.ui.loader_progress);
+  if (key_impacts[58] & mask) h ^= field_hash(fingerprint_seeds[58], s.ui.metadata);
+  return h;
+}
+
+void set(S& s, KeyId id, const V& value, uint64_t& fingerprint) {
+  const uint64_t previous = field_fingerprint(s, id);
+  set(s, id, value);
+  fingerprint ^= previous ^ field_fingerprint(s, id);
+}
+
+void unset(S& s, KeyId id, uint64_t& fingerprint) {
+  const uint64_t previous = field_fingerprint(s, id);
+  unset(s, id);
+  fingerprint ^= previous ^ field_fingerprint(s, id);
+}
+
+void apply(S& s, const Diff& diff, uint64_t& fingerprint) {
+  for (const auto& [id, value] : diff)
+    if (value.has_value())
+      set(s, id, value.value(), fingerprint);
+    else
+      unset(s, id, fingerprint);
+}
+
+void apply(S& s, const Diff& diff, uint64_t& fingerprint, Impact mask) {
+  for (const auto& [id, value] : diff) {
+    const bool tracked = key_impact(id) & mask;
+    const uint64_t previous = tracked ? field_fingerprint(s, id) : 0;
+    if (value.has_value())
+      set(s, id, value.value());
+    else
+      unset(s, id);
+    if (tracked)
+      fingerprint ^= previous ^ field_fingerprint(s, id);
   }
 }
 
 Diff diff(const S& current, const S& previous) {
   Diff d;
-  if(current.camera.azimuth_angle != previous.camera.azimuth_angle) d[keys.camera.azimuth_angle] = current.camera.azimuth_angle;
-  if(current.camera.direction != previous.camera.direction) d[keys.camera.direction] = current.camera.direction;
-  if(current.camera.elevation_angle != previous.camera.elevation_angle) d[keys.camera.elevation_angle] = current.camera.elevation_angle;
-  if(current.camera.focal_point != previous.camera.focal_point) d[keys.camera.focal_point] = current.camera.focal_point;
-  if(current.camera.position != previous.camera.position) d[keys.camera.position] = current.camera.position;
-  if(current.camera.view_angle != previous.camera.view_angle) d[keys.camera.view_angle] = current.camera.view_angle;
-  if(current.camera.view_up != previous.camera.view_up) d[keys.camera.view_up] = current.camera.view_up;
-  if(current.camera.zoom_factor != previous.camera.zoom_factor) d[keys.camera.zoom_factor] = current.camera.zoom_factor;
-  if(current.interactor.axis != previous.interactor.axis) d[keys.interactor.axis] = current.interactor.axis;
-  if(current.interactor.trackball != previous.interactor.trackball) d[keys.interactor.trackball] = current.interactor.trackball;
-  if(current.model.color.opacity != previous.model.color.opacity) d[keys.model.color.opacity] = current.model.color.opacity;
-  if(current.model.color.rgb != previous.model.color.rgb) d[keys.model.color.rgb] = current.model.color.rgb;
-  if(current.model.color.texture != previous.model.color.texture) d[keys.model.color.texture] = current.model.color.texture;
-  if(current.model.emissive.factor != previous.model.emissive.factor) d[keys.model.emissive.factor] = current.model.emissive.factor;
-  if(current.model.emissive.texture != previous.model.emissive.texture) d[keys.model.emissive.texture] = current.model.emissive.texture;
-  if(current.model.matcap.texture != previous.model.matcap.texture) d[keys.model.matcap.texture] = current.model.matcap.texture;
-  if(current.model.material.metallic != previous.model.material.metallic) d[keys.model.material.metallic] = current.model.material.metallic;
-  if(current.model.material.roughness != previous.model.material.roughness) d[keys.model.material.roughness] = current.model.material.roughness;
-  if(current.model.material.texture != previous.model.material.texture) d[keys.model.material.texture] = current.model.material.texture;
-  if(current.model.normal.scale != previous.model.normal.scale) d[keys.model.normal.scale] = current.model.normal.scale;
-  if(current.model.normal.texture != previous.model.normal.texture) d[keys.model.normal.texture] = current.model.normal.texture;
-  if(current.model.point_sprites.enable != previous.model.point_sprites.enable) d[keys.model.point_sprites.enable] = current.model.point_sprites.enable;
-  if(current.model.scivis.cells != previous.model.scivis.cells) d[keys.model.scivis.cells] = current.model.scivis.cells;
-  if(current.model.scivis.colormap != previous.model.scivis.colormap) d[keys.model.scivis.colormap] = current.model.scivis.colormap;
-  if(current.model.scivis.component != previous.model.scivis.component) d[keys.model.scivis.component] = current.model.scivis.component;
-  if(current.model.volume.enable != previous.model.volume.enable) d[keys.model.volume.enable] = current.model.volume.enable;
-  if(current.model.volume.inverse != previous.model.volume.inverse) d[keys.model.volume.inverse] = current.model.volume.inverse;
-  if(current.render.background.blur.coc != previous.render.background.blur.coc) d[keys.render.background.blur.coc] = current.render.background.blur.coc;
-  if(current.render.background.blur.enable != previous.render.background.blur.enable) d[keys.render.background.blur.enable] = current.render.background.blur.enable;
-  if(current.render.background.color != previous.render.background.color) d[keys.render.background.color] = current.render.background.color;
-  if(current.render.background.hdri != previous.render.background.hdri) d[keys.render.background.hdri] = current.render.background.hdri;
-  if(current.render.effect.ambient_occlusion != previous.render.effect.ambient_occlusion) d[keys.render.effect.ambient_occlusion] = current.render.effect.ambient_occlusion;
-  if(current.render.effect.anti_aliasing != previous.render.effect.anti_aliasing) d[keys.render.effect.anti_aliasing] = current.render.effect.anti_aliasing;
-  if(current.render.effect.tone_mapping != previous.render.effect.tone_mapping) d[keys.render.effect.tone_mapping] = current.render.effect.tone_mapping;
-  if(current.render.effect.translucency_support != previous.render.effect.translucency_support) d[keys.render.effect.translucency_support] = current.render.effect.translucency_support;
-  if(current.render.grid.absolute != previous.render.grid.absolute) d[keys.render.grid.absolute] = current.render.grid.absolute;
-  if(current.render.grid.enable != previous.render.grid.enable) d[keys.render.grid.enable] = current.render.grid.enable;
-  if(current.render.grid.subdivisions != previous.render.grid.subdivisions) d[keys.render.grid.subdivisions] = current.render.grid.subdivisions;
-  if(current.render.grid.unit != previous.render.grid.unit) d[keys.render.grid.unit] = current.render.grid.unit;
-  if(current.render.line_width != previous.render.line_width) d[keys.render.line_width] = current.render.line_width;
-  if(current.render.point_size != previous.render.point_size) d[keys.render.point_size] = current.render.point_size;
-  if(current.render.raytracing.denoise != previous.render.raytracing.denoise) d[keys.render.raytracing.denoise] = current.render.raytracing.denoise;
-  if(current.render.raytracing.enable != previous.render.raytracing.enable) d[keys.render.raytracing.enable] = current.render.raytracing.enable;
-  if(current.render.raytracing.samples != previous.render.raytracing.samples) d[keys.render.raytracing.samples] = current.render.raytracing.samples;
-  if(current.render.show_edges != previous.render.show_edges) d[keys.render.show_edges] = current.render.show_edges;
-  if(current.scene.animation.frame_rate != previous.scene.animation.frame_rate) d[keys.scene.animation.frame_rate] = current.scene.animation.frame_rate;
-  if(current.scene.animation.index != previous.scene.animation.index) d[keys.scene.animation.index] = current.scene.animation.index;
-  if(current.scene.animation.speed_factor != previous.scene.animation.speed_factor) d[keys.scene.animation.speed_factor] = current.scene.animation.speed_factor;
-  if(current.scene.camera.index != previous.scene.camera.index) d[keys.scene.camera.index] = current.scene.camera.index;
-  if(current.scene.up_direction != previous.scene.up_direction) d[keys.scene.up_direction] = current.scene.up_direction;
-  if(current.ui.bar != previous.ui.bar) d[keys.ui.bar] = current.ui.bar;
-  if(current.ui.filename != previous.ui.filename) d[keys.ui.filename] = current.ui.filename;
-  if(current.ui.font_file != previous.ui.font_file) d[keys.ui.font_file] = current.ui.font_file;
-  if(current.ui.fps != previous.ui.fps) d[keys.ui.fps] = current.ui.fps;
-  if(current.ui.loader_progress != previous.ui.loader_progress) d[keys.ui.loader_progress] = current.ui.loader_progress;
-  if(current.ui.metadata != previous.ui.metadata) d[keys.ui.metadata] = current.ui.metadata;
+  if(current.camera.azimuth_angle != previous.camera.azimuth_angle) d[KeyId::camera_azimuth_angle] = current.camera.azimuth_angle;
+  if(current.camera.direction != previous.camera.direction) d[KeyId::camera_direction] = current.camera.direction;
+  if(current.camera.elevation_angle != previous.camera.elevation_angle) d[KeyId::camera_elevation_angle] = current.camera.elevation_angle;
+  if(current.camera.focal_point != previous.camera.focal_point) d[KeyId::camera_focal_point] = current.camera.focal_point;
+  if(current.camera.position != previous.camera.position) d[KeyId::camera_position] = current.camera.position;
+  if(current.camera.view_angle != previous.camera.view_angle) d[KeyId::camera_view_angle] = current.camera.view_angle;
+  if(current.camera.view_up != previous.camera.view_up) d[KeyId::camera_view_up] = current.camera.view_up;
+  if(current.camera.zoom_factor != previous.camera.zoom_factor) d[KeyId::camera_zoom_factor] = current.camera.zoom_factor;
+  if(current.interactor.axis != previous.interactor.axis) d[KeyId::interactor_axis] = current.interactor.axis;
+  if(current.interactor.trackball != previous.interactor.trackball) d[KeyId::interactor_trackball] = current.interactor.trackball;
+  if(current.model.color.opacity != previous.model.color.opacity) d[KeyId::model_color_opacity] = current.model.color.opacity;
+  if(current.model.color.rgb != previous.model.color.rgb) d[KeyId::model_color_rgb] = current.model.color.rgb;
+  if(current.model.color.texture != previous.model.color.texture) d[KeyId::model_color_texture] = current.model.color.texture;
+  if(current.model.emissive.factor != previous.model.emissive.factor) d[KeyId::model_emissive_factor] = current.model.emissive.factor;
+  if(current.model.emissive.texture != previous.model.emissive.texture) d[KeyId::model_emissive_texture] = current.model.emissive.texture;
+  if(current.model.matcap.texture != previous.model.matcap.texture) d[KeyId::model_matcap_texture] = current.model.matcap.texture;
+  if(current.model.material.metallic != previous.model.material.metallic) d[KeyId::model_material_metallic] = current.model.material.metallic;
+  if(current.model.material.roughness != previous.model.material.roughness) d[KeyId::model_material_roughness] = current.model.material.roughness;
+  if(current.model.material.texture != previous.model.material.texture) d[KeyId::model_material_texture] = current.model.material.texture;
+  if(current.model.normal.scale != previous.model.normal.scale) d[KeyId::model_normal_scale] = current.model.normal.scale;
+  if(current.model.normal.texture != previous.model.normal.texture) d[KeyId::model_normal_texture] = current.model.normal.texture;
+  if(current.model.point_sprites.enable != previous.model.point_sprites.enable) d[KeyId::model_point_sprites_enable] = current.model.point_sprites.enable;
+  if(current.model.scivis.cells != previous.model.scivis.cells) d[KeyId::model_scivis_cells] = current.model.scivis.cells;
+  if(current.model.scivis.colormap != previous.model.scivis.colormap) d[KeyId::model_scivis_colormap] = current.model.scivis.colormap;
+  if(current.model.scivis.component != previous.model.scivis.component) d[KeyId::model_scivis_component] = current.model.scivis.component;
+  if(current.model.scivis.range != previous.model.scivis.range) d[KeyId::model_scivis_range] = current.model.scivis.range;
+  if(current.model.volume.enable != previous.model.volume.enable) d[KeyId::model_volume_enable] = current.model.volume.enable;
+  if(current.model.volume.inverse != previous.model.volume.inverse) d[KeyId::model_volume_inverse] = current.model.volume.inverse;
+  if(current.model.volume.opacity_map != previous.model.volume.opacity_map) d[KeyId::model_volume_opacity_map] = current.model.volume.opacity_map;
+  if(current.render.background.blur.coc != previous.render.background.blur.coc) d[KeyId::render_background_blur_coc] = current.render.background.blur.coc;
+  if(current.render.background.blur.enable != previous.render.background.blur.enable) d[KeyId::render_background_blur_enable] = current.render.background.blur.enable;
+  if(current.render.background.color != previous.render.background.color) d[KeyId::render_background_color] = current.render.background.color;
+  if(current.render.background.hdri != previous.render.background.hdri) d[KeyId::render_background_hdri] = current.render.background.hdri;
+  if(current.render.effect.ambient_occlusion != previous.render.effect.ambient_occlusion) d[KeyId::render_effect_ambient_occlusion] = current.render.effect.ambient_occlusion;
+  if(current.render.effect.anti_aliasing != previous.render.effect.anti_aliasing) d[KeyId::render_effect_anti_aliasing] = current.render.effect.anti_aliasing;
+  if(current.render.effect.tone_mapping != previous.render.effect.tone_mapping) d[KeyId::render_effect_tone_mapping] = current.render.effect.tone_mapping;
+  if(current.render.effect.translucency_support != previous.render.effect.translucency_support) d[KeyId::render_effect_translucency_support] = current.render.effect.translucency_support;
+  if(current.render.grid.absolute != previous.render.grid.absolute) d[KeyId::render_grid_absolute] = current.render.grid.absolute;
+  if(current.render.grid.enable != previous.render.grid.enable) d[KeyId::render_grid_enable] = current.render.grid.enable;
+  if(current.render.grid.subdivisions != previous.render.grid.subdivisions) d[KeyId::render_grid_subdivisions] = current.render.grid.subdivisions;
+  if(current.render.grid.unit != previous.render.grid.unit) d[KeyId::render_grid_unit] = current.render.grid.unit;
+  if(current.render.line_width != previous.render.line_width) d[KeyId::render_line_width] = current.render.line_width;
+  if(current.render.point_size != previous.render.point_size) d[KeyId::render_point_size] = current.render.point_size;
+  if(current.render.raytracing.denoise != previous.render.raytracing.denoise) d[KeyId::render_raytracing_denoise] = current.render.raytracing.denoise;
+  if(current.render.raytracing.enable != previous.render.raytracing.enable) d[KeyId::render_raytracing_enable] = current.render.raytracing.enable;
+  if(current.render.raytracing.samples != previous.render.raytracing.samples) d[KeyId::render_raytracing_samples] = current.render.raytracing.samples;
+  if(current.render.show_edges != previous.render.show_edges) d[KeyId::render_show_edges] = current.render.show_edges;
+  if(current.scene.animation.frame_rate != previous.scene.animation.frame_rate) d[KeyId::scene_animation_frame_rate] = current.scene.animation.frame_rate;
+  if(current.scene.animation.index != previous.scene.animation.index) d[KeyId::scene_animation_index] = current.scene.animation.index;
+  if(current.scene.animation.speed_factor != previous.scene.animation.speed_factor) d[KeyId::scene_animation_speed_factor] = current.scene.animation.speed_factor;
+  if(current.scene.camera.index != previous.scene.camera.index) d[KeyId::scene_camera_index] = current.scene.camera.index;
+  if(current.scene.reader_options != previous.scene.reader_options) d[KeyId::scene_reader_options] = current.scene.reader_options;
+  if(current.scene.up_direction != previous.scene.up_direction) d[KeyId::scene_up_direction] = current.scene.up_direction;
+  if(current.ui.bar != previous.ui.bar) d[KeyId::ui_bar] = current.ui.bar;
+  if(current.ui.filename != previous.ui.filename) d[KeyId::ui_filename] = current.ui.filename;
+  if(current.ui.font_file != previous.ui.font_file) d[KeyId::ui_font_file] = current.ui.font_file;
+  if(current.ui.fps != previous.ui.fps) d[KeyId::ui_fps] = current.ui.fps;
+  if(current.ui.loader_progress != previous.ui.loader_progress) d[KeyId::ui_loader_progress] = current.ui.loader_progress;
+  if(current.ui.metadata != previous.ui.metadata) d[KeyId::ui_metadata] = current.ui.metadata;
+  return d;
+}
+
+Diff edit_diff(const S& current, const S& previous) {
+  Diff d;
+  if(current.camera.azimuth_angle != previous.camera.azimuth_angle) d[KeyId::camera_azimuth_angle] = current.camera.azimuth_angle;
+  if(current.camera.direction != previous.camera.direction) d[KeyId::camera_direction] = current.camera.direction;
+  if(current.camera.elevation_angle != previous.camera.elevation_angle) d[KeyId::camera_elevation_angle] = current.camera.elevation_angle;
+  if(current.camera.focal_point != previous.camera.focal_point) d[KeyId::camera_focal_point] = current.camera.focal_point;
+  if(current.camera.position != previous.camera.position) d[KeyId::camera_position] = current.camera.position;
+  if(current.camera.view_angle != previous.camera.view_angle) d[KeyId::camera_view_angle] = current.camera.view_angle;
+  if(current.camera.view_up != previous.camera.view_up) d[KeyId::camera_view_up] = current.camera.view_up;
+  if(current.camera.zoom_factor != previous.camera.zoom_factor) d[KeyId::camera_zoom_factor] = current.camera.zoom_factor;
+  if(current.interactor.axis != previous.interactor.axis) d[KeyId::interactor_axis] = current.interactor.axis;
+  if(current.interactor.trackball != previous.interactor.trackball) d[KeyId::interactor_trackball] = current.interactor.trackball;
+  if(current.model.color.opacity != previous.model.color.opacity) d[KeyId::model_color_opacity] = current.model.color.opacity;
+  if(current.model.color.rgb != previous.model.color.rgb) d[KeyId::model_color_rgb] = current.model.color.rgb;
+  if(current.model.color.texture != previous.model.color.texture) d[KeyId::model_color_texture] = current.model.color.texture;
+  if(current.model.emissive.factor != previous.model.emissive.factor) d[KeyId::model_emissive_factor] = current.model.emissive.factor;
+  if(current.model.emissive.texture != previous.model.emissive.texture) d[KeyId::model_emissive_texture] = current.model.emissive.texture;
+  if(current.model.matcap.texture != previous.model.matcap.texture) d[KeyId::model_matcap_texture] = current.model.matcap.texture;
+  if(current.model.material.metallic != previous.model.material.metallic) d[KeyId::model_material_metallic] = current.model.material.metallic;
+  if(current.model.material.roughness != previous.model.material.roughness) d[KeyId::model_material_roughness] = current.model.material.roughness;
+  if(current.model.material.texture != previous.model.material.texture) d[KeyId::model_material_texture] = current.model.material.texture;
+  if(current.model.normal.scale != previous.model.normal.scale) d[KeyId::model_normal_scale] = current.model.normal.scale;
+  if(current.model.normal.texture != previous.model.normal.texture) d[KeyId::model_normal_texture] = current.model.normal.texture;
+  if(current.model.point_sprites.enable != previous.model.point_sprites.enable) d[KeyId::model_point_sprites_enable] = current.model.point_sprites.enable;
+  if(current.model.scivis.cells != previous.model.scivis.cells) d[KeyId::model_scivis_cells] = current.model.scivis.cells;
+  if(current.model.scivis.colormap != previous.model.scivis.colormap) d[KeyId::model_scivis_colormap] = current.model.scivis.colormap;
+  if(current.model.scivis.component != previous.model.scivis.component) d[KeyId::model_scivis_component] = current.model.scivis.component;
+  if(current.model.scivis.range != previous.model.scivis.range) d[KeyId::model_scivis_range] = current.model.scivis.range;
+  if(current.model.volume.enable != previous.model.volume.enable) d[KeyId::model_volume_enable] = current.model.volume.enable;
+  if(current.model.volume.inverse != previous.model.volume.inverse) d[KeyId::model_volume_inverse] = current.model.volume.inverse;
+  if(current.model.volume.opacity_map != previous.model.volume.opacity_map) d[KeyId::model_volume_opacity_map] = diff_value<V>(current.model.volume.opacity_map, previous.model.volume.opacity_map);
+  if(current.render.background.blur.coc != previous.render.background.blur.coc) d[KeyId::render_background_blur_coc] = current.render.background.blur.coc;
+  if(current.render.background.blur.enable != previous.render.background.blur.enable) d[KeyId::render_background_blur_enable] = current.render.background.blur.enable;
+  if(current.render.background.color != previous.render.background.color) d[KeyId::render_background_color] = current.render.background.color;
+  if(current.render.background.hdri != previous.render.background.hdri) d[KeyId::render_background_hdri] = current.render.background.hdri;
+  if(current.render.effect.ambient_occlusion != previous.render.effect.ambient_occlusion) d[KeyId::render_effect_ambient_occlusion] = current.render.effect.ambient_occlusion;
+  if(current.render.effect.anti_aliasing != previous.render.effect.anti_aliasing) d[KeyId::render_effect_anti_aliasing] = current.render.effect.anti_aliasing;
+  if(current.render.effect.tone_mapping != previous.render.effect.tone_mapping) d[KeyId::render_effect_tone_mapping] = current.render.effect.tone_mapping;
+  if(current.render.effect.translucency_support != previous.render.effect.translucency_support) d[KeyId::render_effect_translucency_support] = current.render.effect.translucency_support;
+  if(current.render.grid.absolute != previous.render.grid.absolute) d[KeyId::render_grid_absolute] = current.render.grid.absolute;
+  if(current.render.grid.enable != previous.render.grid.enable) d[KeyId::render_grid_enable] = current.render.grid.enable;
+  if(current.render.grid.subdivisions != previous.render.grid.subdivisions) d[KeyId::render_grid_subdivisions] = current.render.grid.subdivisions;
+  if(current.render.grid.unit != previous.render.grid.unit) d[KeyId::render_grid_unit] = current.render.grid.unit;
+  if(current.render.line_width != previous.render.line_width) d[KeyId::render_line_width] = current.render.line_width;
+  if(current.render.point_size != previous.render.point_size) d[KeyId::render_point_size] = current.render.point_size;
+  if(current.render.raytracing.denoise != previous.render.raytracing.denoise) d[KeyId::render_raytracing_denoise] = current.render.raytracing.denoise;
+  if(current.render.raytracing.enable != previous.render.raytracing.enable) d[KeyId::render_raytracing_enable] = current.render.raytracing.enable;
+  if(current.render.raytracing.samples != previous.render.raytracing.samples) d[KeyId::render_raytracing_samples] = current.render.raytracing.samples;
+  if(current.render.show_edges != previous.render.show_edges) d[KeyId::render_show_edges] = current.render.show_edges;
+  if(current.scene.animation.frame_rate != previous.scene.animation.frame_rate) d[KeyId::scene_animation_frame_rate] = current.scene.animation.frame_rate;
+  if(current.scene.animation.index != previous.scene.animation.index) d[KeyId::scene_animation_index] = current.scene.animation.index;
+  if(current.scene.animation.speed_factor != previous.scene.animation.speed_factor) d[KeyId::scene_animation_speed_factor] = current.scene.animation.speed_factor;
+  if(current.scene.camera.index != previous.scene.camera.index) d[KeyId::scene_camera_index] = current.scene.camera.index;
+  if(current.scene.reader_options != previous.scene.reader_options) d[KeyId::scene_reader_options] = current.scene.reader_options;
+  if(current.scene.up_direction != previous.scene.up_direction) d[KeyId::scene_up_direction] = current.scene.up_direction;
+  if(current.ui.bar != previous.ui.bar) d[KeyId::ui_bar] = current.ui.bar;
+  if(current.ui.filename != previous.ui.filename) d[KeyId::ui_filename] = current.ui.filename;
+  if(current.ui.font_file != previous.ui.font_file) d[KeyId::ui_font_file] = current.ui.font_file;
+  if(current.ui.fps != previous.ui.fps) d[KeyId::ui_fps] = current.ui.fps;
+  if(current.ui.loader_progress != previous.ui.loader_progress) d[KeyId::ui_loader_progress] = current.ui.loader_progress;
+  if(current.ui.metadata != previous.ui.metadata) d[KeyId::ui_metadata] = current.ui.metadata;
   return d;
 }
 
 void apply(S& s, const Diff& diff) {
-  for (const auto item : diff)
-    if (item.second.has_value())
-      set(s, item.first, item.second.value());
+  for (const auto& [id, value] : diff)
+    if (value.has_value())
+      set(s, id, value.value());
     else
-      unset(s, item.first);
-}
-
-std::string type(const K& key) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
-    case 2: // "camera.elevation_angle"
-    case 5: // "camera.view_angle"
-    case 7: // "camera.zoom_factor"
-    case 10: // "model.color.opacity"
-    case 16: // "model.material.metallic"
-    case 17: // "model.material.roughness"
-    case 19: // "model.normal.scale"
-    case 27: // "render.background.blur.coc"
-    case 38: // "render.grid.unit"
-    case 39: // "render.line_width"
-    case 40: // "render.point_size"
-    case 45: // "scene.animation.frame_rate"
-    case 47: // "scene.animation.speed_factor"
+      unset(s, id);
+}
+
+expected<void> try_apply(S& s, const Diff& diff) {
+  for (const auto& [id, value] : diff) {
+    expected<void> checked;
+    switch(id){
+      case KeyId::camera_azimuth_angle:
+        checked = check_change(s.camera.azimuth_angle, value, key_name(id)); break;
+      case KeyId::camera_direction:
+        checked = check_change(s.camera.direction, value, key_name(id)); break;
+      case KeyId::camera_elevation_angle:
+        checked = check_change(s.camera.elevation_angle, value, key_name(id)); break;
+      case KeyId::camera_focal_point:
+        checked = check_change(s.camera.focal_point, value, key_name(id)); break;
+      case KeyId::camera_position:
+        checked = check_change(s.camera.position, value, key_name(id)); break;
+      case KeyId::camera_view_angle:
+        checked = check_change(s.camera.view_angle, value, key_name(id)); break;
+      case KeyId::camera_view_up:
+        checked = check_change(s.camera.view_up, value, key_name(id)); break;
+      case KeyId::camera_zoom_factor:
+        checked = check_change(s.camera.zoom_factor, value, key_name(id)); break;
+      case KeyId::interactor_axis:
+        checked = check_change(s.interactor.axis, value, key_name(id)); break;
+      case KeyId::interactor_trackball:
+        checked = check_change(s.interactor.trackball, value, key_name(id)); break;
+      case KeyId::model_color_opacity:
+        checked = check_change(s.model.color.opacity, value, key_name(id)); break;
+      case KeyId::model_color_rgb:
+        checked = check_change(s.model.color.rgb, value, key_name(id)); break;
+      case KeyId::model_color_texture:
+        checked = check_change(s.model.color.texture, value, key_name(id)); break;
+      case KeyId::model_emissive_factor:
+        checked = check_change(s.model.emissive.factor, value, key_name(id)); break;
+      case KeyId::model_emissive_texture:
+        checked = check_change(s.model.emissive.texture, value, key_name(id)); break;
+      case KeyId::model_matcap_texture:
+        checked = check_change(s.model.matcap.texture, value, key_name(id)); break;
+      case KeyId::model_material_metallic:
+        checked = check_change(s.model.material.metallic, value, key_name(id)); break;
+      case KeyId::model_material_roughness:
+        checked = check_change(s.model.material.roughness, value, key_name(id)); break;
+      case KeyId::model_material_texture:
+        checked = check_change(s.model.material.texture, value, key_name(id)); break;
+      case KeyId::model_normal_scale:
+        checked = check_change(s.model.normal.scale, value, key_name(id)); break;
+      case KeyId::model_normal_texture:
+        checked = check_change(s.model.normal.texture, value, key_name(id)); break;
+      case KeyId::model_point_sprites_enable:
+        checked = check_change(s.model.point_sprites.enable, value, key_name(id)); break;
+      case KeyId::model_scivis_cells:
+        checked = check_change(s.model.scivis.cells, value, key_name(id)); break;
+      case KeyId::model_scivis_colormap:
+        checked = check_change(s.model.scivis.colormap, value, key_name(id)); break;
+      case KeyId::model_scivis_component:
+        checked = check_change(s.model.scivis.component, value, key_name(id)); break;
+      case KeyId::model_scivis_range:
+        checked = check_change(s.model.scivis.range, value, key_name(id)); break;
+      case KeyId::model_volume_enable:
+        checked = check_change(s.model.volume.enable, value, key_name(id)); break;
+      case KeyId::model_volume_inverse:
+        checked = check_change(s.model.volume.inverse, value, key_name(id)); break;
+      case KeyId::model_volume_opacity_map:
+        checked = check_change(s.model.volume.opacity_map, value, key_name(id)); break;
+      case KeyId::render_background_blur_coc:
+        checked = check_change(s.render.background.blur.coc, value, key_name(id)); break;
+      case KeyId::render_background_blur_enable:
+        checked = check_change(s.render.background.blur.enable, value, key_name(id)); break;
+      case KeyId::render_background_color:
+        checked = check_change(s.render.background.color, value, key_name(id)); break;
+      case KeyId::render_background_hdri:
+        checked = check_change(s.render.background.hdri, value, key_name(id)); break;
+      case KeyId::render_effect_ambient_occlusion:
+        checked = check_change(s.render.effect.ambient_occlusion, value, key_name(id)); break;
+      case KeyId::render_effect_anti_aliasing:
+        checked = check_change(s.render.effect.anti_aliasing, value, key_name(id)); break;
+      case KeyId::render_effect_tone_mapping:
+        checked = check_change(s.render.effect.tone_mapping, value, key_name(id)); break;
+      case KeyId::render_effect_translucency_support:
+        checked = check_change(s.render.effect.translucency_support, value, key_name(id)); break;
+      case KeyId::render_grid_absolute:
+        checked = check_change(s.render.grid.absolute, value, key_name(id)); break;
+      case KeyId::render_grid_enable:
+        checked = check_change(s.render.grid.enable, value, key_name(id)); break;
+      case KeyId::render_grid_subdivisions:
+        checked = check_change(s.render.grid.subdivisions, value, key_name(id)); break;
+      case KeyId::render_grid_unit:
+        checked = check_change(s.render.grid.unit, value, key_name(id)); break;
+      case KeyId::render_line_width:
+        checked = check_change(s.render.line_width, value, key_name(id)); break;
+      case KeyId::render_point_size:
+        checked = check_change(s.render.point_size, value, key_name(id)); break;
+      case KeyId::render_raytracing_denoise:
+        checked = check_change(s.render.raytracing.denoise, value, key_name(id)); break;
+      case KeyId::render_raytracing_enable:
+        checked = check_change(s.render.raytracing.enable, value, key_name(id)); break;
+      case KeyId::render_raytracing_samples:
+        checked = check_change(s.render.raytracing.samples, value, key_name(id)); break;
+      case KeyId::render_show_edges:
+        checked = check_change(s.render.show_edges, value, key_name(id)); break;
+      case KeyId::scene_animation_frame_rate:
+        checked = check_change(s.scene.animation.frame_rate, value, key_name(id)); break;
+      case KeyId::scene_animation_index:
+        checked = check_change(s.scene.animation.index, value, key_name(id)); break;
+      case KeyId::scene_animation_speed_factor:
+        checked = check_change(s.scene.animation.speed_factor, value, key_name(id)); break;
+      case KeyId::scene_camera_index:
+        checked = check_change(s.scene.camera.index, value, key_name(id)); break;
+      case KeyId::scene_reader_options:
+        checked = check_change(s.scene.reader_options, value, key_name(id)); break;
+      case KeyId::scene_up_direction:
+        checked = check_change(s.scene.up_direction, value, key_name(id)); break;
+      case KeyId::ui_bar:
+        checked = check_change(s.ui.bar, value, key_name(id)); break;
+      case KeyId::ui_filename:
+        checked = check_change(s.ui.filename, value, key_name(id)); break;
+      case KeyId::ui_font_file:
+        checked = check_change(s.ui.font_file, value, key_name(id)); break;
+      case KeyId::ui_fps:
+        checked = check_change(s.ui.fps, value, key_name(id)); break;
+      case KeyId::ui_loader_progress:
+        checked = check_change(s.ui.loader_progress, value, key_name(id)); break;
+      case KeyId::ui_metadata:
+        checked = check_change(s.ui.metadata, value, key_name(id)); break;
+      default: return unexpected(conversion_error{conversion_errc::invalid_key, {}, {}});
+    }
+    if (!checked)
+      return checked;
+  }
+  apply(s, diff);
+  return {};
+}
+
+Diff compose(const Diff& first, const Diff& second) {
+  Diff d;
+  d.reserve(first.size() + second.size());
+  auto a = first.begin(), b = second.begin();
+  while (a != first.end() || b != second.end())
+    if (b == second.end() || (a != first.end() && a->first < b->first)) {
+      d[a->first] = a->second;
+      ++a;
+    } else {
+      if (a != first.end() && a->first == b->first)
+        d[b->first] = compose_values((a++)->second, b->second);
+      else
+        d[b->first] = b->second;
+      ++b;
+    }
+  return d;
+}
+
+Diff invert(const Diff& diff, const S& base) {
+  Diff d;
+  d.reserve(diff.size());
+  for (const auto& item : diff)
+    d[item.first] = invert_value(item.second, get(base, item.first));
+  return d;
+}
+
+Diff restrict(const Diff& diff, std::string_view prefix) {
+  const auto [first, last] = key_range(prefix);
+  Diff d;
+  for (auto it = std::lower_bound(diff.begin(), diff.end(), first,
+         [](const auto& item, KeyId id) { return item.first < id; });
+       it != diff.end() && it->first < last; ++it)
+    d[it->first] = it->second;
+  return d;
+}
+
+std::string type(KeyId id) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
       return "double";
-    case 1: // "camera.direction"
-    case 6: // "camera.view_up"
-    case 13: // "model.emissive.factor"
-    case 49: // "scene.up_direction"
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
       return "Vector3";
-    case 3: // "camera.focal_point"
-    case 4: // "camera.position"
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
       return "Point3";
-    case 8: // "interactor.axis"
-    case 9: // "interactor.trackball"
-    case 21: // "model.point_sprites.enable"
-    case 22: // "model.scivis.cells"
-    case 25: // "model.volume.enable"
-    case 26: // "model.volume.inverse"
-    case 28: // "render.background.blur.enable"
-    case 31: // "render.effect.ambient_occlusion"
-    case 32: // "render.effect.anti_aliasing"
-    case 33: // "render.effect.tone_mapping"
-    case 34: // "render.effect.translucency_support"
-    case 35: // "render.grid.absolute"
-    case 36: // "render.grid.enable"
-    case 41: // "render.raytracing.denoise"
-    case 42: // "render.raytracing.enable"
-    case 44: // "render.show_edges"
-    case 50: // "ui.bar"
-    case 51: // "ui.filename"
-    case 53: // "ui.fps"
-    case 54: // "ui.loader_progress"
-    case 55: // "ui.metadata"
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
       return "bool";
-    case 11: // "model.color.rgb"
-    case 29: // "render.background.color"
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
       return "Color";
-    case 12: // "model.color.texture"
-    case 14: // "model.emissive.texture"
-    case 15: // "model.matcap.texture"
-    case 18: // "model.material.texture"
-    case 20: // "model.normal.texture"
-    case 30: // "render.background.hdri"
-    case 52: // "ui.font_file"
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
       return "std::string";
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       return "Colormap";
-    case 24: // "model.scivis.component"
-    case 37: // "render.grid.subdivisions"
-    case 43: // "render.raytracing.samples"
-    case 46: // "scene.animation.index"
-    case 48: // "scene.camera.index"
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
       return "int";
-    default: throw std::invalid_argument(key); // unreachable
+    case KeyId::model_scivis_range:
+      return "std::pair<double, double>";
+    case KeyId::model_volume_opacity_map:
+      return "std::vector<double>";
+    case KeyId::scene_reader_options:
+      return "std::map<std::string, std::string>";
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-V from_string(const K& key, const std::string& value) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
-    case 2: // "camera.elevation_angle"
-    case 5: // "camera.view_angle"
-    case 7: // "camera.zoom_factor"
-    case 10: // "model.color.opacity"
-    case 16: // "model.material.metallic"
-    case 17: // "model.material.roughness"
-    case 19: // "model.normal.scale"
-    case 27: // "render.background.blur.coc"
-    case 38: // "render.grid.unit"
-    case 39: // "render.line_width"
-    case 40: // "render.point_size"
-    case 45: // "scene.animation.frame_rate"
-    case 47: // "scene.animation.speed_factor"
+std::string type(std::string_view key) {
+  return type(key_id(key));
+}
+
+V from_string(KeyId id, const std::string& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
       return options_ns::parse_double(value);
-    case 1: // "camera.direction"
-    case 6: // "camera.view_up"
-    case 13: // "model.emissive.factor"
-    case 49: // "scene.up_direction"
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
       return options_ns::parse_Vector3(value);
-    case 3: // "camera.focal_point"
-    case 4: // "camera.position"
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
       return options_ns::parse_Point3(value);
-    case 8: // "interactor.axis"
-    case 9: // "interactor.trackball"
-    case 21: // "model.point_sprites.enable"
-    case 22: // "model.scivis.cells"
-    case 25: // "model.volume.enable"
-    case 26: // "model.volume.inverse"
-    case 28: // "render.background.blur.enable"
-    case 31: // "render.effect.ambient_occlusion"
-    case 32: // "render.effect.anti_aliasing"
-    case 33: // "render.effect.tone_mapping"
-    case 34: // "render.effect.translucency_support"
-    case 35: // "render.grid.absolute"
-    case 36: // "render.grid.enable"
-    case 41: // "render.raytracing.denoise"
-    case 42: // "render.raytracing.enable"
-    case 44: // "render.show_edges"
-    case 50: // "ui.bar"
-    case 51: // "ui.filename"
-    case 53: // "ui.fps"
-    case 54: // "ui.loader_progress"
-    case 55: // "ui.metadata"
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
       return options_ns::parse_bool(value);
-    case 11: // "model.color.rgb"
-    case 29: // "render.background.color"
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
       return options_ns::parse_Color(value);
-    case 12: // "model.color.texture"
-    case 14: // "model.emissive.texture"
-    case 15: // "model.matcap.texture"
-    case 18: // "model.material.texture"
-    case 20: // "model.normal.texture"
-    case 30: // "render.background.hdri"
-    case 52: // "ui.font_file"
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
       return options_ns::parse_std_string(value);
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       return options_ns::parse_Colormap(value);
-    case 24: // "model.scivis.component"
-    case 37: // "render.grid.subdivisions"
-    case 43: // "render.raytracing.samples"
-    case 46: // "scene.animation.index"
-    case 48: // "scene.camera.index"
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
       return options_ns::parse_int(value);
-    default: throw std::invalid_argument(key); // unreachable
+    case KeyId::model_scivis_range:
+      return options_ns::parse_std_pair<double, double>(value);
+    case KeyId::model_volume_opacity_map:
+      return options_ns::parse_std_vector<double>(value);
+    case KeyId::scene_reader_options:
+      return options_ns::parse_std_map<std::string, std::string>(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-V from_json(const K& key, const json& value) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
-    case 2: // "camera.elevation_angle"
-    case 5: // "camera.view_angle"
-    case 7: // "camera.zoom_factor"
-    case 10: // "model.color.opacity"
-    case 16: // "model.material.metallic"
-    case 17: // "model.material.roughness"
-    case 19: // "model.normal.scale"
-    case 27: // "render.background.blur.coc"
-    case 38: // "render.grid.unit"
-    case 39: // "render.line_width"
-    case 40: // "render.point_size"
-    case 45: // "scene.animation.frame_rate"
-    case 47: // "scene.animation.speed_factor"
+V from_string(std::string_view key, const std::string& value) {
+  return from_string(key_id(key), value);
+}
+
+V from_json(KeyId id, const json& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
       return options_ns::json_to_double(value);
-    case 1: // "camera.direction"
-    case 6: // "camera.view_up"
-    case 13: // "model.emissive.factor"
-    case 49: // "scene.up_direction"
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
       return options_ns::json_to_Vector3(value);
-    case 3: // "camera.focal_point"
-    case 4: // "camera.position"
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
       return options_ns::json_to_Point3(value);
-    case 8: // "interactor.axis"
-    case 9: // "interactor.trackball"
-    case 21: // "model.point_sprites.enable"
-    case 22: // "model.scivis.cells"
-    case 25: // "model.volume.enable"
-    case 26: // "model.volume.inverse"
-    case 28: // "render.background.blur.enable"
-    case 31: // "render.effect.ambient_occlusion"
-    case 32: // "render.effect.anti_aliasing"
-    case 33: // "render.effect.tone_mapping"
-    case 34: // "render.effect.translucency_support"
-    case 35: // "render.grid.absolute"
-    case 36: // "render.grid.enable"
-    case 41: // "render.raytracing.denoise"
-    case 42: // "render.raytracing.enable"
-    case 44: // "render.show_edges"
-    case 50: // "ui.bar"
-    case 51: // "ui.filename"
-    case 53: // "ui.fps"
-    case 54: // "ui.loader_progress"
-    case 55: // "ui.metadata"
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
       return options_ns::json_to_bool(value);
-    case 11: // "model.color.rgb"
-    case 29: // "render.background.color"
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
       return options_ns::json_to_Color(value);
-    case 12: // "model.color.texture"
-    case 14: // "model.emissive.texture"
-    case 15: // "model.matcap.texture"
-    case 18: // "model.material.texture"
-    case 20: // "model.normal.texture"
-    case 30: // "render.background.hdri"
-    case 52: // "ui.font_file"
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
       return options_ns::json_to_std_string(value);
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       return options_ns::json_to_Colormap(value);
-    case 24: // "model.scivis.component"
-    case 37: // "render.grid.subdivisions"
-    case 43: // "render.raytracing.samples"
-    case 46: // "scene.animation.index"
-    case 48: // "scene.camera.index"
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
       return options_ns::json_to_int(value);
-    default: throw std::invalid_argument(key); // unreachable
+    case KeyId::model_scivis_range:
+      return options_ns::json_to_std_pair<double, double>(value);
+    case KeyId::model_volume_opacity_map:
+      return options_ns::json_to_std_vector<double>(value);
+    case KeyId::scene_reader_options:
+      return options_ns::json_to_std_map<std::string, std::string>(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+V from_json(std::string_view key, const json& value) {
+  return from_json(key_id(key), value);
+}
+
+expected<V> try_from_string(KeyId id, const std::string& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
+      return options_ns::try_parse_double(value);
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
+      return options_ns::try_parse_Vector3(value);
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
+      return options_ns::try_parse_Point3(value);
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
+      return options_ns::try_parse_bool(value);
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
+      return options_ns::try_parse_Color(value);
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
+      return options_ns::try_parse_std_string(value);
+    case KeyId::model_scivis_colormap:
+      return options_ns::try_parse_Colormap(value);
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
+      return options_ns::try_parse_int(value);
+    case KeyId::model_scivis_range:
+      return options_ns::try_parse_std_pair<double, double>(value);
+    case KeyId::model_volume_opacity_map:
+      return options_ns::try_parse_std_vector<double>(value);
+    case KeyId::scene_reader_options:
+      return options_ns::try_parse_std_map<std::string, std::string>(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
   }
 }
 
-std::string to_string(const K& key, const V& value) {
-  switch(key_index(key)){
-    case 0: // "camera.azimuth_angle"
-    case 2: // "camera.elevation_angle"
-    case 5: // "camera.view_angle"
-    case 7: // "camera.zoom_factor"
-    case 10: // "model.color.opacity"
-    case 16: // "model.material.metallic"
-    case 17: // "model.material.roughness"
-    case 19: // "model.normal.scale"
-    case 27: // "render.background.blur.coc"
-    case 38: // "render.grid.unit"
-    case 39: // "render.line_width"
-    case 40: // "render.point_size"
-    case 45: // "scene.animation.frame_rate"
-    case 47: // "scene.animation.speed_factor"
+expected<V> try_from_string(std::string_view key, const std::string& value) {
+  if (const auto id = find_key_id(key))
+    return try_from_string(*id, value);
+  return unexpected(conversion_error{conversion_errc::invalid_key, std::string(key), {}});
+}
+
+expected<V> try_from_json(KeyId id, const json& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
+      return options_ns::try_json_to_double(value);
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
+      return options_ns::try_json_to_Vector3(value);
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
+      return options_ns::try_json_to_Point3(value);
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
+      return options_ns::try_json_to_bool(value);
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
+      return options_ns::try_json_to_Color(value);
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
+      return options_ns::try_json_to_std_string(value);
+    case KeyId::model_scivis_colormap:
+      return options_ns::try_json_to_Colormap(value);
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
+      return options_ns::try_json_to_int(value);
+    case KeyId::model_scivis_range:
+      return options_ns::try_json_to_std_pair<double, double>(value);
+    case KeyId::model_volume_opacity_map:
+      return options_ns::try_json_to_std_vector<double>(value);
+    case KeyId::scene_reader_options:
+      return options_ns::try_json_to_std_map<std::string, std::string>(value);
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+expected<V> try_from_json(std::string_view key, const json& value) {
+  if (const auto id = find_key_id(key))
+    return try_from_json(*id, value);
+  return unexpected(conversion_error{conversion_errc::invalid_key, std::string(key), {}});
+}
+
+std::string to_string(KeyId id, const V& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
       return options_ns::format_double(std::get<double>(value));
-    case 1: // "camera.direction"
-    case 6: // "camera.view_up"
-    case 13: // "model.emissive.factor"
-    case 49: // "scene.up_direction"
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
       return options_ns::format_Vector3(std::get<std::array<double, 3>>(value));
-    case 3: // "camera.focal_point"
-    case 4: // "camera.position"
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
       return options_ns::format_Point3(std::get<std::array<double, 3>>(value));
-    case 8: // "interactor.axis"
-    case 9: // "interactor.trackball"
-    case 21: // "model.point_sprites.enable"
-    case 22: // "model.scivis.cells"
-    case 25: // "model.volume.enable"
-    case 26: // "model.volume.inverse"
-    case 28: // "render.background.blur.enable"
-    case 31: // "render.effect.ambient_occlusion"
-    case 32: // "render.effect.anti_aliasing"
-    case 33: // "render.effect.tone_mapping"
-    case 34: // "render.effect.translucency_support"
-    case 35: // "render.grid.absolute"
-    case 36: // "render.grid.enable"
-    case 41: // "render.raytracing.denoise"
-    case 42: // "render.raytracing.enable"
-    case 44: // "render.show_edges"
-    case 50: // "ui.bar"
-    case 51: // "ui.filename"
-    case 53: // "ui.fps"
-    case 54: // "ui.loader_progress"
-    case 55: // "ui.metadata"
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
       return options_ns::format_bool(std::get<bool>(value));
-    case 11: // "model.color.rgb"
-    case 29: // "render.background.color"
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
       return options_ns::format_Color(std::get<std::array<double, 3>>(value));
-    case 12: // "model.color.texture"
-    case 14: // "model.emissive.texture"
-    case 15: // "model.matcap.texture"
-    case 18: // "model.material.texture"
-    case 20: // "model.normal.texture"
-    case 30: // "render.background.hdri"
-    case 52: // "ui.font_file"
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
       return options_ns::format_std_string(std::get<std::basic_string<char>>(value));
-    case 23: // "model.scivis.colormap"
+    case KeyId::model_scivis_colormap:
       return options_ns::format_Colormap(std::get<Colormap_t>(value));
-    case 24: // "model.scivis.component"
-    case 37: // "render.grid.subdivisions"
-    case 43: // "render.raytracing.samples"
-    case 46: // "scene.animation.index"
-    case 48: // "scene.camera.index"
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
       return options_ns::format_int(std::get<int>(value));
-    default: throw std::invalid_argument(key); // unreachable
+    case KeyId::model_scivis_range:
+      return options_ns::format_std_pair<double, double>(std::get<std::pair<double, double>>(value));
+    case KeyId::model_volume_opacity_map:
+      if (const auto e = std::get_if<vector_edit<double>>(&value)) return options_ns::format_std_vector<double>(*e); else return options_ns::format_std_vector<double>(std::get<std::vector<double>>(value));
+    case KeyId::scene_reader_options:
+      return options_ns::format_std_map<std::string, std::string>(std::get<std::map<std::basic_string<char>, std::basic_string<char>>>(value));
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+std::string to_string(std::string_view key, const V& value) {
+  return to_string(key_id(key), value);
+}
+
+json to_json(KeyId id, const V& value) {
+  switch(id){
+    case KeyId::camera_azimuth_angle:
+    case KeyId::camera_elevation_angle:
+    case KeyId::camera_view_angle:
+    case KeyId::camera_zoom_factor:
+    case KeyId::model_color_opacity:
+    case KeyId::model_material_metallic:
+    case KeyId::model_material_roughness:
+    case KeyId::model_normal_scale:
+    case KeyId::render_background_blur_coc:
+    case KeyId::render_grid_unit:
+    case KeyId::render_line_width:
+    case KeyId::render_point_size:
+    case KeyId::scene_animation_frame_rate:
+    case KeyId::scene_animation_speed_factor:
+      return options_ns::double_to_json(std::get<double>(value));
+    case KeyId::camera_direction:
+    case KeyId::camera_view_up:
+    case KeyId::model_emissive_factor:
+    case KeyId::scene_up_direction:
+      return options_ns::Vector3_to_json(std::get<std::array<double, 3>>(value));
+    case KeyId::camera_focal_point:
+    case KeyId::camera_position:
+      return options_ns::Point3_to_json(std::get<std::array<double, 3>>(value));
+    case KeyId::interactor_axis:
+    case KeyId::interactor_trackball:
+    case KeyId::model_point_sprites_enable:
+    case KeyId::model_scivis_cells:
+    case KeyId::model_volume_enable:
+    case KeyId::model_volume_inverse:
+    case KeyId::render_background_blur_enable:
+    case KeyId::render_effect_ambient_occlusion:
+    case KeyId::render_effect_anti_aliasing:
+    case KeyId::render_effect_tone_mapping:
+    case KeyId::render_effect_translucency_support:
+    case KeyId::render_grid_absolute:
+    case KeyId::render_grid_enable:
+    case KeyId::render_raytracing_denoise:
+    case KeyId::render_raytracing_enable:
+    case KeyId::render_show_edges:
+    case KeyId::ui_bar:
+    case KeyId::ui_filename:
+    case KeyId::ui_fps:
+    case KeyId::ui_loader_progress:
+    case KeyId::ui_metadata:
+      return options_ns::bool_to_json(std::get<bool>(value));
+    case KeyId::model_color_rgb:
+    case KeyId::render_background_color:
+      return options_ns::Color_to_json(std::get<std::array<double, 3>>(value));
+    case KeyId::model_color_texture:
+    case KeyId::model_emissive_texture:
+    case KeyId::model_matcap_texture:
+    case KeyId::model_material_texture:
+    case KeyId::model_normal_texture:
+    case KeyId::render_background_hdri:
+    case KeyId::ui_font_file:
+      return options_ns::std_string_to_json(std::get<std::basic_string<char>>(value));
+    case KeyId::model_scivis_colormap:
+      return options_ns::Colormap_to_json(std::get<Colormap_t>(value));
+    case KeyId::model_scivis_component:
+    case KeyId::render_grid_subdivisions:
+    case KeyId::render_raytracing_samples:
+    case KeyId::scene_animation_index:
+    case KeyId::scene_camera_index:
+      return options_ns::int_to_json(std::get<int>(value));
+    case KeyId::model_scivis_range:
+      return options_ns::std_pair_to_json<double, double>(std::get<std::pair<double, double>>(value));
+    case KeyId::model_volume_opacity_map:
+      if (const auto e = std::get_if<vector_edit<double>>(&value)) return options_ns::std_vector_to_json<double>(*e); else return options_ns::std_vector_to_json<double>(std::get<std::vector<double>>(value));
+    case KeyId::scene_reader_options:
+      return options_ns::std_map_to_json<std::string, std::string>(std::get<std::map<std::basic_string<char>, std::basic_string<char>>>(value));
+    default: throw std::out_of_range("invalid key id"); // unreachable
+  }
+}
+
+json to_json(std::string_view key, const V& value) {
+  return to_json(key_id(key), value);
+}
+
+const cli_flag* find_cli_flag(std::string_view name) noexcept {
+  const size_t n = cli_flags.size();
+  const int32_t seed = cli_hash_seeds[key_hash(0, name) % n];
+  const size_t slot = seed < 0 ? -seed - 1 : key_hash(seed, name) % n;
+  const cli_flag& flag = cli_flags[cli_hash_slots[slot]];
+  return flag.name == name ? &flag : nullptr;
+}
+
+const cli_flag* find_cli_flag(char short_name) noexcept {
+  for (const auto& flag : cli_flags)
+    if (flag.short_name == short_name)
+      return &flag;
+  return nullptr;
+}
+
+cli_args parse_cli(int argc, const char* const* argv, const S& defaults, std::string_view unset, std::string_view reset) {
+  cli_args args;
+  const auto set_value = [&](const cli_flag& flag, std::string_view value) {
+    if (value == unset)
+      args.diff[flag.id] = std::nullopt;
+    else if (value == reset)
+      args.diff[flag.id] = get(defaults, flag.id);
+    else
+      args.diff[flag.id] = from_string(flag.id, std::string(value));
+  };
+  const auto missing_value = [](std::string_view arg) {
+    return std::invalid_argument("missing value for " + std::string(arg));
+  };
+  bool options_ended = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (options_ended || arg.size() < 2 || arg[0] != '-') {
+      args.unmatched.push_back(arg);
+    } else if (arg == "--") {
+      options_ended = true;
+    } else if (arg[1] == '-') {
+      const size_t eq = arg.find('=');
+      const std::string_view name = arg.substr(2, eq - 2);
+      const cli_flag* flag = find_cli_flag(name);
+      if (name == "help")
+        args.help = true;
+      else if (!flag)
+        args.unmatched.push_back(arg);
+      else if (eq != arg.npos)
+        set_value(*flag, arg.substr(eq + 1));
+      else if (flag->is_switch)
+        set_value(*flag, "true");
+      else if (i + 1 < argc)
+        set_value(*flag, argv[++i]);
+      else
+        throw missing_value(arg);
+    } else {
+      for (size_t j = 1; j < arg.size(); ++j) {
+        const cli_flag* flag = find_cli_flag(arg[j]);
+        const std::string_view rest = arg.substr(j + 1);
+        if (arg[j] == 'h') {
+          args.help = true;
+          continue;
+        } else if (!flag) {
+          args.unmatched.push_back(arg);
+        } else if (rest.starts_with('=')) {
+          set_value(*flag, rest.substr(1));
+        } else if (flag->is_switch) {
+          set_value(*flag, "true");
+          continue;
+        } else if (!rest.empty()) {
+          set_value(*flag, rest);
+        } else if (i + 1 < argc) {
+          set_value(*flag, argv[++i]);
+        } else {
+          throw missing_value(arg);
+        }
+        break;
+      }
+    }
+  }
+  return args;
+}
+
+std::string cli_help(const S& defaults) {
+  const auto names = [](const cli_flag& flag) {
+    std::string s = flag.short_name ? std::string{'-', flag.short_name} + ", "
+                                    : std::string("    ");
+    s.append("--").append(flag.name);
+    if (!flag.is_switch)
+      s.append("=").append(flag.metavar);
+    return s;
+  };
+  size_t width = std::string_view("-h, --help").size();
+  for (const auto& flag : cli_flags)
+    width = std::max(width, names(flag).size());
+  const auto row = [&](const std::string& names, std::string_view help) {
+    return "  " + names + std::string(width + 2 - names.size(), ' ') +
+           std::string(help);
+  };
+  std::string help = row("-h, --help", "Print usage") + "\n";
+  std::string_view group;
+  for (const auto& flag : cli_flags) {
+    if (flag.group != group) {
+      group = flag.group;
+      help.append("\n ").append(group).append(" options:\n");
+    }
+    help += row(names(flag), flag.help);
+    if (const auto value = get(defaults, flag.id))
+      help.append(" (default: ").append(to_string(flag.id, *value)).append(")");
+    help += "\n";
   }
+  return help;
 }
 
 } // namespace options_ns::f3d_options_io
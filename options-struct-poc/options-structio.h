@@ -1,15 +1,26 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "options.h"
 #include "options-io.h"
+#include "options-containers.h"
+#include "options-hash.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -20,60 +31,444 @@ typedef std::string K; // Key
 typedef std::variant<
   bool
 > V; // Value
-typedef std::map<K, std::optional<V>> Diff;
 
-const struct keys {
-  const K watch = "watch";
-} keys;
+inline constexpr struct keys {
+  std::string_view watch = "watch";
+} keys = {};
+
+/** Dense key identifiers, in key order. */
+enum class KeyId : uint16_t {
+  watch, // "watch"
+};
+
+/** Set of keys, one bit per `KeyId`. */
+typedef std::bitset<1> KeySet;
+
+/** Impact of changing a value, from the `@tags` of the fields
+documentation. */
+typedef uint32_t Impact;
+namespace impact {
+constexpr Impact none = 0;
+} // namespace impact
+
+constexpr std::array<Impact, 1> key_impacts = {
+  impact::none, // "watch"
+};
+
+/** Get the impact of changing the value of a key. */
+constexpr Impact key_impact(KeyId id) {
+  return key_impacts[static_cast<size_t>(id)];
+}
+
+/** Get the identifier of a key, if it exists. */
+std::optional<KeyId> find_key_id(std::string_view key) noexcept;
+
+/** Get the identifier of a key.
+Throws `invalid_key` exception on unknown key. */
+KeyId key_id(std::string_view key);
+
+/** Get the key of an identifier. */
+std::string_view key_name(KeyId id);
+
+/** Get the `[first, last)` range of identifiers of a key and of the keys
+nested under it. */
+std::pair<KeyId, KeyId> key_range(std::string_view prefix) noexcept;
+
+/** Map of changes from keys to values, an empty value meaning unset.
+Entries are kept sorted by `KeyId` in a single contiguous array. */
+class Diff {
+public:
+  typedef KeyId key_type;
+  typedef std::optional<V> mapped_type;
+  typedef std::pair<KeyId, std::optional<V>> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  /** Insert an empty value for `id` if there is none. */
+  std::pair<iterator, bool> try_emplace(KeyId id) {
+    if (items.empty() || items.back().first < id)
+      return {items.insert(items.end(), {id, std::nullopt}), true};
+    const auto it = lower_bound(id);
+    if (it != items.end() && it->first == id)
+      return {it, false};
+    return {items.insert(it, {id, std::nullopt}), true};
+  }
+  std::pair<iterator, bool> try_emplace(std::string_view key) {
+    return try_emplace(key_id(key));
+  }
+
+  std::optional<V>& operator[](KeyId id) { return try_emplace(id).first->second; }
+  std::optional<V>& operator[](std::string_view key) {
+    return (*this)[key_id(key)];
+  }
+
+  const std::optional<V>& at(KeyId id) const {
+    const auto it = find(id);
+    if (it == items.end())
+      throw std::out_of_range("key not in diff: " + std::string(key_name(id)));
+    return it->second;
+  }
+  const std::optional<V>& at(std::string_view key) const {
+    return at(key_id(key));
+  }
+
+  iterator find(KeyId id) {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(KeyId id) const {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(std::string_view key) const {
+    const auto id = find_key_id(key);
+    return id ? find(*id) : items.end();
+  }
+
+  /** Identifier of a key, if it is one. */
+  static std::optional<KeyId> key(std::string_view key) noexcept {
+    return find_key_id(key);
+  }
+
+  size_t count(KeyId id) const { return find(id) != items.end(); }
+  size_t count(std::string_view key) const { return find(key) != items.end(); }
+
+  size_t erase(KeyId id) {
+    const auto it = find(id);
+    if (it == items.end())
+      return 0;
+    items.erase(it);
+    return 1;
+  }
+
+  iterator begin() { return items.begin(); }
+  iterator end() { return items.end(); }
+  const_iterator begin() const { return items.begin(); }
+  const_iterator end() const { return items.end(); }
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+  void clear() { items.clear(); }
+  void reserve(size_t n) { items.reserve(n); }
+
+  /** Combined impact of the changed keys. */
+  Impact impact() const {
+    Impact mask = 0;
+    for (const auto& item : items)
+      mask |= key_impact(item.first);
+    return mask;
+  }
+
+  bool operator==(const Diff& other) const = default;
+
+private:
+  std::vector<value_type> items;
+
+  iterator lower_bound(KeyId id) {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+  const_iterator lower_bound(KeyId id) const {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+};
+
+/** Get a value by key. */
+std::optional<V> get(const S& s, KeyId id);
 
 /** Get a value by key.
 Throws `invalid_key` exception on unknown key. */
-std::optional<V> get(const S& s, const K& key);
+std::optional<V> get(const S& s, std::string_view key);
+
+/** Set a value by key. */
+void set(S& s, KeyId id, const V& value);
 
 /** Set a value by key.
 Throws `invalid_key` exception on unknown key. */
-void set(S& s, const K& key, const V& value);
+void set(S& s, std::string_view key, const V& value);
+
+/** Unset an optional value by key.
+Throws `non_optional_key` exception on non-optional key. */
+void unset(S& s, KeyId id);
 
 /** Unset an optional value by key.
 Throws `invalid_key` exception on unknown key.
 Throws `non_optional_key` exception on non-optional key. */
-void unset(S& s, const K& key);
+void unset(S& s, std::string_view key);
+
+/** The default instance, constructed once from the member initializers. */
+const S& defaults();
+
+/** Reset a value to its default by key. */
+void reset(S& s, KeyId id);
+
+/** Reset a value to its default by key.
+Throws `invalid_key` exception on unknown key. */
+void reset(S& s, std::string_view key);
+
+/** Reset the values of a key and the keys nested under it to their defaults. */
+void reset_subtree(S& s, std::string_view prefix);
+
+/** Get the keys whose values differ from their defaults, without
+building a diff. */
+KeySet non_default_mask(const S& s);
+
+/** Hash of the value of a key, `fingerprint(s)` is the XOR of those of all
+the keys. */
+uint64_t field_fingerprint(const S& s, KeyId id);
+
+/** Stable 64 bits hash of the values of an instance, for cache keys.
+Values are hashed in canonical form (see options-hash.h) and keys by
+name, so equal instances hash the same across runs and builds. */
+uint64_t fingerprint(const S& s);
+
+/** Fingerprint of the values of the keys whose impact intersects `mask`,
+eg. `impact::render` to key what depends on rendering only. */
+uint64_t fingerprint([[maybe_unused]] const S& s, [[maybe_unused]] Impact mask);
+
+/** Set a value by key, updating `fingerprint` (of `s`) without rehashing
+the other keys. */
+void set(S& s, KeyId id, const V& value, uint64_t& fingerprint);
+
+/** Unset an optional value by key, updating `fingerprint` (of `s`)
+without rehashing the other keys. */
+void unset(S& s, KeyId id, uint64_t& fingerprint);
+
+/** Apply a diff, updating `fingerprint` (of `s`) for the changed keys only.
+If an unset throws, `fingerprint` matches the partially applied `s`. */
+void apply(S& s, const Diff& diff, uint64_t& fingerprint);
+
+/** Apply a diff, updating `fingerprint` (of `s` and `mask`, see
+`fingerprint(s, mask)`) for the changed keys only. */
+void apply(S& s, const Diff& diff, uint64_t& fingerprint, Impact mask);
 
-/** Construct a `key->variant` map of differences between two instances. */
+/** Construct a `key->variant` map of differences between two instances.
+The diff holds the current values, it can be applied to any instance
+and written with `to_string`/`to_json` then parsed back. */
 Diff diff(const S& current, const S& previous);
 
+/** Construct a diff like `diff`, holding a `vector_edit` of `previous` for
+vectors when it carries less than half their elements, for histories
+and observers. Edits are positional: the diff is only valid applied to
+`previous` (or an equal instance), and edits are written for display
+only, they are not parsed back. */
+Diff edit_diff(const S& current, const S& previous);
+
 /** apply a diff (`key->variant` map) to an instance.
-Throws `invalid_key` exception on unknown key.
 Throws `non_optional_key` exception on non-optional key. */
 void apply(S& s, const Diff& diff);
 
+/** Apply a diff like `apply`, returning an error without changing `s`
+if it unsets a non-optional key (`non_optional_key`), holds a value
+of the wrong type for its key (`wrong_type`) or an edit that does not
+fit (`invalid_edit`). */
+expected<void> try_apply(S& s, const Diff& diff);
+
+/** Combine two diffs into one equivalent to applying `first` then `second`. */
+Diff compose(const Diff& first, const Diff& second);
+
+/** Construct the diff that undoes applying `diff` to `base`. */
+Diff invert(const Diff& diff, const S& base);
+
+/** Extract the part of a diff about a key and the keys nested under it. */
+Diff restrict(const Diff& diff, std::string_view prefix);
+
+/** Retrieve the type name of a value by key.
+Possible return values are: `"bool"`. */
+std::string type(KeyId id);
+
 /** Retrieve the type name of a value by key.
 Possible return values are: `"bool"`.
 Throws `invalid_key` exception on unknown key. */
-std::string type(const K& key);
+std::string type(std::string_view key);
+
+/** Parse a value for a given key from `std::string`. */
+V from_string(KeyId id, const std::string& value);
 
 /** Parse a value for a given key from `std::string`.
 Throws `invalid_key` exception on unknown key. */
-V from_string(const K& key, const std::string& value);
+V from_string(std::string_view key, const std::string& value);
+
+/** Parse a value for a given key from `json`. */
+V from_json(KeyId id, const json& value);
 
 /** Parse a value for a given key from `json`.
 Throws `invalid_key` exception on unknown key. */
-V from_json(const K& key, const json& value);
+V from_json(std::string_view key, const json& value);
+
+/** Parse a value for a given key from `std::string`, without throwing. */
+expected<V> try_from_string(KeyId id, const std::string& value);
+
+/** Parse a value for a given key from `std::string`, without throwing.
+Returns an `invalid_key` error (holding a copy of `key`) on unknown
+key. */
+expected<V> try_from_string(std::string_view key, const std::string& value);
+
+/** Parse a value for a given key from `json`, without throwing. */
+expected<V> try_from_json(KeyId id, const json& value);
+
+/** Parse a value for a given key from `json`, without throwing.
+Returns an `invalid_key` error (holding a copy of `key`) on unknown
+key. */
+expected<V> try_from_json(std::string_view key, const json& value);
+
+/** Format a value for a given key to `std::string`. */
+std::string to_string(KeyId id, const V& value);
 
 /** Format a value for a given key to `std::string`.
 Throws `invalid_key` exception on unknown key. */
-std::string to_string(const K& key, const V& value);
+std::string to_string(std::string_view key, const V& value);
+
+/** Format a value for a given key to `json`. */
+json to_json(KeyId id, const V& value);
+
+/** Format a value for a given key to `json`.
+Throws `invalid_key` exception on unknown key. */
+json to_json(std::string_view key, const V& value);
+
+/** An instance that records which fields are modified through it, so the
+changes can be retrieved in time proportional to their number. */
+class Tracked {
+public:
+  Tracked() = default;
+  explicit Tracked(const S& s) : s(s) {}
+
+  const S& value() const { return s; }
+
+  void set(KeyId id, const V& value) {
+    ::options_ns::app_options_io::set(s, id, value);
+    mark(id);
+  }
+  void set(std::string_view key, const V& value) { set(key_id(key), value); }
+
+  void unset(KeyId id) {
+    ::options_ns::app_options_io::unset(s, id);
+    mark(id);
+  }
+  void unset(std::string_view key) { unset(key_id(key)); }
+
+  void apply(const Diff& diff) {
+    for (const auto& [id, value] : diff)
+      if (value.has_value())
+        set(id, value.value());
+      else
+        unset(id);
+  }
+
+  bool changed(KeyId id) const {
+    const size_t i = static_cast<size_t>(id);
+    return dirty[i / 64] & (uint64_t(1) << (i % 64));
+  }
+
+  /** Retrieve the current values of the fields modified since the last call
+  and reset the tracking. */
+  Diff take_changes() {
+    Diff changes;
+    for (size_t w = 0; w < dirty.size(); ++w)
+      for (uint64_t bits = std::exchange(dirty[w], 0); bits; bits &= bits - 1) {
+        const auto id = static_cast<KeyId>(w * 64 + std::countr_zero(bits));
+        changes[id] = ::options_ns::app_options_io::get(s, id);
+      }
+    return changes;
+  }
+
+  void clear_changes() { dirty.fill(0); }
+
+private:
+  S s;
+  std::array<uint64_t, 1> dirty = {};
+
+  void mark(KeyId id) {
+    const size_t i = static_cast<size_t>(id);
+    dirty[i / 64] |= uint64_t(1) << (i % 64);
+  }
+};
+
+/** Compile-time access to the field of a key. */
+template <KeyId id> struct field;
+
+template <> struct field<KeyId::watch> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.watch; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.watch;
+  }
+};
+
+/** Get a reference to a field by compile-time key. */
+template <KeyId id>
+constexpr typename field<id>::type& get(S& s) noexcept {
+  return field<id>::get(s);
+}
+template <KeyId id>
+constexpr const typename field<id>::type& get(const S& s) noexcept {
+  return field<id>::get(s);
+}
+
+/** Description of a field, from the parsed struct. */
+struct field_info {
+  KeyId id;
+  std::string_view key;
+  std::string_view type;
+  std::string_view canonical_type;
+  bool is_optional;
+  bool has_default;
+  Impact impact;
+  std::string_view doc; // comment, without markers
+};
+
+/** Descriptions of the fields, in key order (indexed by `KeyId`). */
+inline constexpr std::array<field_info, 1> field_infos = {{
+  {
+    KeyId::watch,
+    "watch",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::watch)],
+    "",
+  },
+}};
 
+template <KeyId id> using key_constant = std::integral_constant<KeyId, id>;
+
+/** Call `f(key, value)` for each field, in key order, with `key` a
+`key_constant` (its `value` being the `KeyId`, usable as a template argument
+or to index `field_infos` at compile-time) and `value` a reference to the
+field. The calls are expanded at compile-time. */
+template <typename F> constexpr void for_each_field(S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+template <typename F> constexpr void for_each_field(const S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+
+/** Call `f(key, a_value, b_value)` for each field of two instances. */
+template <typename F>
+constexpr void for_each_field(const S& a, const S& b, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(a),
+       get<static_cast<KeyId>(i)>(b)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
 class invalid_key : public std::out_of_range {
 public:
-  explicit invalid_key(const K& key):
-    std::out_of_range("invalid key: " + key) {}
+  explicit invalid_key(std::string_view key):
+    std::out_of_range("invalid key: " + std::string(key)) {}
 };
 
 class non_optional_key : public std::out_of_range {
 public:
-  explicit non_optional_key(const K& key):
-    std::out_of_range("non-optional key: " + key) {}
+  explicit non_optional_key(std::string_view key):
+    std::out_of_range("non-optional key: " + std::string(key)) {}
 };
 
 
@@ -91,159 +486,1709 @@ typedef std::variant<
   double,
   int,
   std::array<double, 3> /* Color, Point3, Vector3 */,
-  std::basic_string<char> /* std::string */
+  std::basic_string<char> /* std::string */,
+  std::map<std::basic_string<char>, std::basic_string<char>> /* std::map<std::string, std::string> */,
+  std::pair<double, double>,
+  std::vector<double>,
+  vector_edit<double>
 > V; // Value
-typedef std::map<K, std::optional<V>> Diff;
-
-const struct keys {
-  const struct camera {
-    const K azimuth_angle = "camera.azimuth_angle";
-    const K direction = "camera.direction";
-    const K elevation_angle = "camera.elevation_angle";
-    const K focal_point = "camera.focal_point";
-    const K position = "camera.position";
-    const K view_angle = "camera.view_angle";
-    const K view_up = "camera.view_up";
-    const K zoom_factor = "camera.zoom_factor";
+
+inline constexpr struct keys {
+  struct camera {
+    std::string_view azimuth_angle = "camera.azimuth_angle";
+    std::string_view direction = "camera.direction";
+    std::string_view elevation_angle = "camera.elevation_angle";
+    std::string_view focal_point = "camera.focal_point";
+    std::string_view position = "camera.position";
+    std::string_view view_angle = "camera.view_angle";
+    std::string_view view_up = "camera.view_up";
+    std::string_view zoom_factor = "camera.zoom_factor";
   } camera;
-  const struct interactor {
-    const K axis = "interactor.axis";
-    const K trackball = "interactor.trackball";
+  struct interactor {
+    std::string_view axis = "interactor.axis";
+    std::string_view trackball = "interactor.trackball";
   } interactor;
-  const struct model {
-    const struct color {
-      const K opacity = "model.color.opacity";
-      const K rgb = "model.color.rgb";
-      const K texture = "model.color.texture";
+  struct model {
+    struct color {
+      std::string_view opacity = "model.color.opacity";
+      std::string_view rgb = "model.color.rgb";
+      std::string_view texture = "model.color.texture";
     } color;
-    const struct emissive {
-      const K factor = "model.emissive.factor";
-      const K texture = "model.emissive.texture";
+    struct emissive {
+      std::string_view factor = "model.emissive.factor";
+      std::string_view texture = "model.emissive.texture";
     } emissive;
-    const struct matcap {
-      const K texture = "model.matcap.texture";
+    struct matcap {
+      std::string_view texture = "model.matcap.texture";
     } matcap;
-    const struct material {
-      const K metallic = "model.material.metallic";
-      const K roughness = "model.material.roughness";
-      const K texture = "model.material.texture";
+    struct material {
+      std::string_view metallic = "model.material.metallic";
+      std::string_view roughness = "model.material.roughness";
+      std::string_view texture = "model.material.texture";
     } material;
-    const struct normal {
-      const K scale = "model.normal.scale";
-      const K texture = "model.normal.texture";
+    struct normal {
+      std::string_view scale = "model.normal.scale";
+      std::string_view texture = "model.normal.texture";
     } normal;
-    const struct point_sprites {
-      const K enable = "model.point_sprites.enable";
+    struct point_sprites {
+      std::string_view enable = "model.point_sprites.enable";
     } point_sprites;
-    const struct scivis {
-      const K cells = "model.scivis.cells";
-      const K colormap = "model.scivis.colormap";
-      const K component = "model.scivis.component";
+    struct scivis {
+      std::string_view cells = "model.scivis.cells";
+      std::string_view colormap = "model.scivis.colormap";
+      std::string_view component = "model.scivis.component";
+      std::string_view range = "model.scivis.range";
     } scivis;
-    const struct volume {
-      const K enable = "model.volume.enable";
-      const K inverse = "model.volume.inverse";
+    struct volume {
+      std::string_view enable = "model.volume.enable";
+      std::string_view inverse = "model.volume.inverse";
+      std::string_view opacity_map = "model.volume.opacity_map";
     } volume;
   } model;
-  const struct render {
-    const struct background {
-      const struct blur {
-        const K coc = "render.background.blur.coc";
-        const K enable = "render.background.blur.enable";
+  struct render {
+    struct background {
+      struct blur {
+        std::string_view coc = "render.background.blur.coc";
+        std::string_view enable = "render.background.blur.enable";
       } blur;
-      const K color = "render.background.color";
-      const K hdri = "render.background.hdri";
+      std::string_view color = "render.background.color";
+      std::string_view hdri = "render.background.hdri";
     } background;
-    const struct effect {
-      const K ambient_occlusion = "render.effect.ambient_occlusion";
-      const K anti_aliasing = "render.effect.anti_aliasing";
-      const K tone_mapping = "render.effect.tone_mapping";
-      const K translucency_support = "render.effect.translucency_support";
+    struct effect {
+      std::string_view ambient_occlusion = "render.effect.ambient_occlusion";
+      std::string_view anti_aliasing = "render.effect.anti_aliasing";
+      std::string_view tone_mapping = "render.effect.tone_mapping";
+      std::string_view translucency_support = "render.effect.translucency_support";
     } effect;
-    const struct grid {
-      const K absolute = "render.grid.absolute";
-      const K enable = "render.grid.enable";
-      const K subdivisions = "render.grid.subdivisions";
-      const K unit = "render.grid.unit";
+    struct grid {
+      std::string_view absolute = "render.grid.absolute";
+      std::string_view enable = "render.grid.enable";
+      std::string_view subdivisions = "render.grid.subdivisions";
+      std::string_view unit = "render.grid.unit";
     } grid;
-    const K line_width = "render.line_width";
-    const K point_size = "render.point_size";
-    const struct raytracing {
-      const K denoise = "render.raytracing.denoise";
-      const K enable = "render.raytracing.enable";
-      const K samples = "render.raytracing.samples";
+    std::string_view line_width = "render.line_width";
+    std::string_view point_size = "render.point_size";
+    struct raytracing {
+      std::string_view denoise = "render.raytracing.denoise";
+      std::string_view enable = "render.raytracing.enable";
+      std::string_view samples = "render.raytracing.samples";
     } raytracing;
-    const K show_edges = "render.show_edges";
+    std::string_view show_edges = "render.show_edges";
   } render;
-  const struct scene {
-    const struct animation {
-      const K frame_rate = "scene.animation.frame_rate";
-      const K index = "scene.animation.index";
-      const K speed_factor = "scene.animation.speed_factor";
+  struct scene {
+    struct animation {
+      std::string_view frame_rate = "scene.animation.frame_rate";
+      std::string_view index = "scene.animation.index";
+      std::string_view speed_factor = "scene.animation.speed_factor";
     } animation;
-    const struct camera {
-      const K index = "scene.camera.index";
+    struct camera {
+      std::string_view index = "scene.camera.index";
     } camera;
-    const K up_direction = "scene.up_direction";
+    std::string_view reader_options = "scene.reader_options";
+    std::string_view up_direction = "scene.up_direction";
   } scene;
-  const struct ui {
-    const K bar = "ui.bar";
-    const K filename = "ui.filename";
-    const K font_file = "ui.font_file";
-    const K fps = "ui.fps";
-    const K loader_progress = "ui.loader_progress";
-    const K metadata = "ui.metadata";
+  struct ui {
+    std::string_view bar = "ui.bar";
+    std::string_view filename = "ui.filename";
+    std::string_view font_file = "ui.font_file";
+    std::string_view fps = "ui.fps";
+    std::string_view loader_progress = "ui.loader_progress";
+    std::string_view metadata = "ui.metadata";
   } ui;
-} keys;
+} keys = {};
+
+/** Dense key identifiers, in key order. */
+enum class KeyId : uint16_t {
+  camera_azimuth_angle, // "camera.azimuth_angle"
+  camera_direction, // "camera.direction"
+  camera_elevation_angle, // "camera.elevation_angle"
+  camera_focal_point, // "camera.focal_point"
+  camera_position, // "camera.position"
+  camera_view_angle, // "camera.view_angle"
+  camera_view_up, // "camera.view_up"
+  camera_zoom_factor, // "camera.zoom_factor"
+  interactor_axis, // "interactor.axis"
+  interactor_trackball, // "interactor.trackball"
+  model_color_opacity, // "model.color.opacity"
+  model_color_rgb, // "model.color.rgb"
+  model_color_texture, // "model.color.texture"
+  model_emissive_factor, // "model.emissive.factor"
+  model_emissive_texture, // "model.emissive.texture"
+  model_matcap_texture, // "model.matcap.texture"
+  model_material_metallic, // "model.material.metallic"
+  model_material_roughness, // "model.material.roughness"
+  model_material_texture, // "model.material.texture"
+  model_normal_scale, // "model.normal.scale"
+  model_normal_texture, // "model.normal.texture"
+  model_point_sprites_enable, // "model.point_sprites.enable"
+  model_scivis_cells, // "model.scivis.cells"
+  model_scivis_colormap, // "model.scivis.colormap"
+  model_scivis_component, // "model.scivis.component"
+  model_scivis_range, // "model.scivis.range"
+  model_volume_enable, // "model.volume.enable"
+  model_volume_inverse, // "model.volume.inverse"
+  model_volume_opacity_map, // "model.volume.opacity_map"
+  render_background_blur_coc, // "render.background.blur.coc"
+  render_background_blur_enable, // "render.background.blur.enable"
+  render_background_color, // "render.background.color"
+  render_background_hdri, // "render.background.hdri"
+  render_effect_ambient_occlusion, // "render.effect.ambient_occlusion"
+  render_effect_anti_aliasing, // "render.effect.anti_aliasing"
+  render_effect_tone_mapping, // "render.effect.tone_mapping"
+  render_effect_translucency_support, // "render.effect.translucency_support"
+  render_grid_absolute, // "render.grid.absolute"
+  render_grid_enable, // "render.grid.enable"
+  render_grid_subdivisions, // "render.grid.subdivisions"
+  render_grid_unit, // "render.grid.unit"
+  render_line_width, // "render.line_width"
+  render_point_size, // "render.point_size"
+  render_raytracing_denoise, // "render.raytracing.denoise"
+  render_raytracing_enable, // "render.raytracing.enable"
+  render_raytracing_samples, // "render.raytracing.samples"
+  render_show_edges, // "render.show_edges"
+  scene_animation_frame_rate, // "scene.animation.frame_rate"
+  scene_animation_index, // "scene.animation.index"
+  scene_animation_speed_factor, // "scene.animation.speed_factor"
+  scene_camera_index, // "scene.camera.index"
+  scene_reader_options, // "scene.reader_options"
+  scene_up_direction, // "scene.up_direction"
+  ui_bar, // "ui.bar"
+  ui_filename, // "ui.filename"
+  ui_font_file, // "ui.font_file"
+  ui_fps, // "ui.fps"
+  ui_loader_progress, // "ui.loader_progress"
+  ui_metadata, // "ui.metadata"
+};
+
+/** Set of keys, one bit per `KeyId`. */
+typedef std::bitset<59> KeySet;
+
+/** Impact of changing a value, from the `@tags` of the fields
+documentation. */
+typedef uint32_t Impact;
+namespace impact {
+constexpr Impact none = 0;
+constexpr Impact load = 1 << 0;
+constexpr Impact render = 1 << 1;
+} // namespace impact
+
+constexpr std::array<Impact, 59> key_impacts = {
+  impact::none, // "camera.azimuth_angle"
+  impact::none, // "camera.direction"
+  impact::none, // "camera.elevation_angle"
+  impact::none, // "camera.focal_point"
+  impact::none, // "camera.position"
+  impact::none, // "camera.view_angle"
+  impact::none, // "camera.view_up"
+  impact::none, // "camera.zoom_factor"
+  impact::render, // "interactor.axis"
+  impact::render, // "interactor.trackball"
+  impact::render, // "model.color.opacity"
+  impact::render, // "model.color.rgb"
+  impact::render, // "model.color.texture"
+  impact::render, // "model.emissive.factor"
+  impact::render, // "model.emissive.texture"
+  impact::render, // "model.matcap.texture"
+  impact::render, // "model.material.metallic"
+  impact::render, // "model.material.roughness"
+  impact::render, // "model.material.texture"
+  impact::render, // "model.normal.scale"
+  impact::render, // "model.normal.texture"
+  impact::render, // "model.point_sprites.enable"
+  impact::render, // "model.scivis.cells"
+  impact::render, // "model.scivis.colormap"
+  impact::render, // "model.scivis.component"
+  impact::render, // "model.scivis.range"
+  impact::render, // "model.volume.enable"
+  impact::render, // "model.volume.inverse"
+  impact::render, // "model.volume.opacity_map"
+  impact::render, // "render.background.blur.coc"
+  impact::render, // "render.background.blur.enable"
+  impact::render, // "render.background.color"
+  impact::render, // "render.background.hdri"
+  impact::render, // "render.effect.ambient_occlusion"
+  impact::render, // "render.effect.anti_aliasing"
+  impact::render, // "render.effect.tone_mapping"
+  impact::render, // "render.effect.translucency_support"
+  impact::render, // "render.grid.absolute"
+  impact::render, // "render.grid.enable"
+  impact::render, // "render.grid.subdivisions"
+  impact::render, // "render.grid.unit"
+  impact::render, // "render.line_width"
+  impact::render, // "render.point_size"
+  impact::render, // "render.raytracing.denoise"
+  impact::render, // "render.raytracing.enable"
+  impact::render, // "render.raytracing.samples"
+  impact::render, // "render.show_edges"
+  impact::render, // "scene.animation.frame_rate"
+  impact::load, // "scene.animation.index"
+  impact::render, // "scene.animation.speed_factor"
+  impact::load, // "scene.camera.index"
+  impact::load, // "scene.reader_options"
+  impact::load, // "scene.up_direction"
+  impact::render, // "ui.bar"
+  impact::render, // "ui.filename"
+  impact::render, // "ui.font_file"
+  impact::render, // "ui.fps"
+  impact::load, // "ui.loader_progress"
+  impact::render, // "ui.metadata"
+};
+
+/** Get the impact of changing the value of a key. */
+constexpr Impact key_impact(KeyId id) {
+  return key_impacts[static_cast<size_t>(id)];
+}
+
+/** Get the identifier of a key, if it exists. */
+std::optional<KeyId> find_key_id(std::string_view key) noexcept;
+
+/** Get the identifier of a key.
+Throws `invalid_key` exception on unknown key. */
+KeyId key_id(std::string_view key);
+
+/** Get the key of an identifier. */
+std::string_view key_name(KeyId id);
+
+/** Get the `[first, last)` range of identifiers of a key and of the keys
+nested under it. */
+std::pair<KeyId, KeyId> key_range(std::string_view prefix) noexcept;
+
+/** Map of changes from keys to values, an empty value meaning unset.
+Entries are kept sorted by `KeyId` in a single contiguous array. */
+class Diff {
+public:
+  typedef KeyId key_type;
+  typedef std::optional<V> mapped_type;
+  typedef std::pair<KeyId, std::optional<V>> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  /** Insert an empty value for `id` if there is none. */
+  std::pair<iterator, bool> try_emplace(KeyId id) {
+    if (items.empty() || items.back().first < id)
+      return {items.insert(items.end(), {id, std::nullopt}), true};
+    const auto it = lower_bound(id);
+    if (it != items.end() && it->first == id)
+      return {it, false};
+    return {items.insert(it, {id, std::nullopt}), true};
+  }
+  std::pair<iterator, bool> try_emplace(std::string_view key) {
+    return try_emplace(key_id(key));
+  }
+
+  std::optional<V>& operator[](KeyId id) { return try_emplace(id).first->second; }
+  std::optional<V>& operator[](std::string_view key) {
+    return (*this)[key_id(key)];
+  }
+
+  const std::optional<V>& at(KeyId id) const {
+    const auto it = find(id);
+    if (it == items.end())
+      throw std::out_of_range("key not in diff: " + std::string(key_name(id)));
+    return it->second;
+  }
+  const std::optional<V>& at(std::string_view key) const {
+    return at(key_id(key));
+  }
+
+  iterator find(KeyId id) {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(KeyId id) const {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(std::string_view key) const {
+    const auto id = find_key_id(key);
+    return id ? find(*id) : items.end();
+  }
+
+  /** Identifier of a key, if it is one. */
+  static std::optional<KeyId> key(std::string_view key) noexcept {
+    return find_key_id(key);
+  }
+
+  size_t count(KeyId id) const { return find(id) != items.end(); }
+  size_t count(std::string_view key) const { return find(key) != items.end(); }
+
+  size_t erase(KeyId id) {
+    const auto it = find(id);
+    if (it == items.end())
+      return 0;
+    items.erase(it);
+    return 1;
+  }
+
+  iterator begin() { return items.begin(); }
+  iterator end() { return items.end(); }
+  const_iterator begin() const { return items.begin(); }
+  const_iterator end() const { return items.end(); }
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+  void clear() { items.clear(); }
+  void reserve(size_t n) { items.reserve(n); }
+
+  /** Combined impact of the changed keys. */
+  Impact impact() const {
+    Impact mask = 0;
+    for (const auto& item : items)
+      mask |= key_impact(item.first);
+    return mask;
+  }
+
+  bool operator==(const Diff& other) const = default;
+
+private:
+  std::vector<value_type> items;
+
+  iterator lower_bound(KeyId id) {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+  const_iterator lower_bound(KeyId id) const {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+};
+
+/** Command line flag of a key, from the `@cli([c,]name)` tags of the
+fields documentation. */
+struct cli_flag {
+  std::string_view name; // used as `--name`
+  char short_name; // used as `-c`, 0 if none
+  bool is_switch; // bool value, `true` if not given
+  KeyId id;
+  std::string_view group;
+  std::string_view metavar;
+  std::string_view help;
+};
+
+inline constexpr std::array<cli_flag, 15> cli_flags = {{
+  {"camera-direction", 0, false, KeyId::camera_direction, "camera", "Vector3", "Set the camera direction"},
+  {"camera-focus", 0, false, KeyId::camera_focal_point, "camera", "Point3", "Set the camera focal point"},
+  {"camera-position", 0, false, KeyId::camera_position, "camera", "Point3", "Set the camera position"},
+  {"camera-zoom-factor", 0, false, KeyId::camera_zoom_factor, "camera", "double", "zoom factor relative to the autozoom on data"},
+  {"colormap", 0, false, KeyId::model_scivis_colormap, "model", "Colormap", "Set a custom colormap for the coloring"},
+  {"range", 0, false, KeyId::model_scivis_range, "model", "std::pair<double, double>", "Set a custom range for the coloring, as min,max"},
+  {"background-color", 'b', false, KeyId::render_background_color, "render", "Color", "Set the window background color"},
+  {"ambient-occlusion", 0, true, KeyId::render_effect_ambient_occlusion, "render", "bool", "Enable ambient occlusion"},
+  {"anti-aliasing", 0, true, KeyId::render_effect_anti_aliasing, "render", "bool", "Enable anti-aliasing"},
+  {"tone-mapping", 0, true, KeyId::render_effect_tone_mapping, "render", "bool", "Enable generic filmic Tone Mapping Pass"},
+  {"translucency", 0, true, KeyId::render_effect_translucency_support, "render", "bool", "Enable translucency support"},
+  {"grid", 'g', true, KeyId::render_grid_enable, "render", "bool", "Show a grid aligned with the horizontal (orthogonal to the Up direction) plane"},
+  {"grid-unit", 0, false, KeyId::render_grid_unit, "render", "double", "Set the size of the unit square for the grid"},
+  {"up", 0, false, KeyId::scene_up_direction, "scene", "Vector3", "Define the Up direction"},
+  {"font", 0, false, KeyId::ui_font_file, "ui", "std::string", "Use the provided FreeType compatible font file to display text"},
+}};
+
+/** Result of parsing command line arguments. */
+struct cli_args {
+  Diff diff;
+  std::vector<std::string_view> unmatched; // positional and unknown
+  bool help = false; // `-h` or `--help` was given
+};
+
+/** Get a value by key. */
+std::optional<V> get(const S& s, KeyId id);
 
 /** Get a value by key.
 Throws `invalid_key` exception on unknown key. */
-std::optional<V> get(const S& s, const K& key);
+std::optional<V> get(const S& s, std::string_view key);
+
+/** Set a value by key. */
+void set(S& s, KeyId id, const V& value);
 
 /** Set a value by key.
 Throws `invalid_key` exception on unknown key. */
-void set(S& s, const K& key, const V& value);
+void set(S& s, std::string_view key, const V& value);
+
+/** Unset an optional value by key.
+Throws `non_optional_key` exception on non-optional key. */
+void unset(S& s, KeyId id);
 
 /** Unset an optional value by key.
 Throws `invalid_key` exception on unknown key.
 Throws `non_optional_key` exception on non-optional key. */
-void unset(S& s, const K& key);
+void unset(S& s, std::string_view key);
+
+/** The default instance, constructed once from the member initializers. */
+const S& defaults();
+
+/** Reset a value to its default by key. */
+void reset(S& s, KeyId id);
+
+/** Reset a value to its default by key.
+Throws `invalid_key` exception on unknown key. */
+void reset(S& s, std::string_view key);
+
+/** Reset the values of a key and the keys nested under it to their defaults. */
+void reset_subtree(S& s, std::string_view prefix);
+
+/** Get the keys whose values differ from their defaults, without
+building a diff. */
+KeySet non_default_mask(const S& s);
+
+/** Hash of the value of a key, `fingerprint(s)` is the XOR of those of all
+the keys. */
+uint64_t field_fingerprint(const S& s, KeyId id);
+
+/** Stable 64 bits hash of the values of an instance, for cache keys.
+Values are hashed in canonical form (see options-hash.h) and keys by
+name, so equal instances hash the same across runs and builds. */
+uint64_t fingerprint(const S& s);
+
+/** Fingerprint of the values of the keys whose impact intersects `mask`,
+eg. `impact::render` to key what depends on rendering only. */
+uint64_t fingerprint(const S& s, Impact mask);
+
+/** Set a value by key, updating `fingerprint` (of `s`) without rehashing
+the other keys. */
+void set(S& s, KeyId id, const V& value, uint64_t& fingerprint);
+
+/** Unset an optional value by key, updating `fingerprint` (of `s`)
+without rehashing the other keys. */
+void unset(S& s, KeyId id, uint64_t& fingerprint);
 
-/** Construct a `key->variant` map of differences between two instances. */
+/** Apply a diff, updating `fingerprint` (of `s`) for the changed keys only.
+If an unset throws, `fingerprint` matches the partially applied `s`. */
+void apply(S& s, const Diff& diff, uint64_t& fingerprint);
+
+/** Apply a diff, updating `fingerprint` (of `s` and `mask`, see
+`fingerprint(s, mask)`) for the changed keys only. */
+void apply(S& s, const Diff& diff, uint64_t& fingerprint, Impact mask);
+
+/** Construct a `key->variant` map of differences between two instances.
+The diff holds the current values, it can be applied to any instance
+and written with `to_string`/`to_json` then parsed back. */
 Diff diff(const S& current, const S& previous);
 
+/** Construct a diff like `diff`, holding a `vector_edit` of `previous` for
+vectors when it carries less than half their elements, for histories
+and observers. Edits are positional: the diff is only valid applied to
+`previous` (or an equal instance), and edits are written for display
+only, they are not parsed back. */
+Diff edit_diff(const S& current, const S& previous);
+
 /** apply a diff (`key->variant` map) to an instance.
-Throws `invalid_key` exception on unknown key.
 Throws `non_optional_key` exception on non-optional key. */
 void apply(S& s, const Diff& diff);
 
+/** Apply a diff like `apply`, returning an error without changing `s`
+if it unsets a non-optional key (`non_optional_key`), holds a value
+of the wrong type for its key (`wrong_type`) or an edit that does not
+fit (`invalid_edit`). */
+expected<void> try_apply(S& s, const Diff& diff);
+
+/** Combine two diffs into one equivalent to applying `first` then `second`. */
+Diff compose(const Diff& first, const Diff& second);
+
+/** Construct the diff that undoes applying `diff` to `base`. */
+Diff invert(const Diff& diff, const S& base);
+
+/** Extract the part of a diff about a key and the keys nested under it. */
+Diff restrict(const Diff& diff, std::string_view prefix);
+
 /** Retrieve the type name of a value by key.
-Possible return values are: `"Color"`, `"Colormap"`, `"Point3"`, `"Vector3"`, `"bool"`, `"double"`, `"int"`, `"std::string"`.
+Possible return values are: `"Color"`, `"Colormap"`, `"Point3"`, `"Vector3"`, `"bool"`, `"double"`, `"int"`, `"std::map<std::string, std::string>"`, `"std::pair<double, double>"`, `"std::string"`, `"std::vector<double>"`. */
+std::string type(KeyId id);
+
+/** Retrieve the type name of a value by key.
+Possible return values are: `"Color"`, `"Colormap"`, `"Point3"`, `"Vector3"`, `"bool"`, `"double"`, `"int"`, `"std::map<std::string, std::string>"`, `"std::pair<double, double>"`, `"std::string"`, `"std::vector<double>"`.
 Throws `invalid_key` exception on unknown key. */
-std::string type(const K& key);
+std::string type(std::string_view key);
+
+/** Parse a value for a given key from `std::string`. */
+V from_string(KeyId id, const std::string& value);
 
 /** Parse a value for a given key from `std::string`.
 Throws `invalid_key` exception on unknown key. */
-V from_string(const K& key, const std::string& value);
+V from_string(std::string_view key, const std::string& value);
+
+/** Parse a value for a given key from `json`. */
+V from_json(KeyId id, const json& value);
 
 /** Parse a value for a given key from `json`.
 Throws `invalid_key` exception on unknown key. */
-V from_json(const K& key, const json& value);
+V from_json(std::string_view key, const json& value);
+
+/** Parse a value for a given key from `std::string`, without throwing. */
+expected<V> try_from_string(KeyId id, const std::string& value);
+
+/** Parse a value for a given key from `std::string`, without throwing.
+Returns an `invalid_key` error (holding a copy of `key`) on unknown
+key. */
+expected<V> try_from_string(std::string_view key, const std::string& value);
+
+/** Parse a value for a given key from `json`, without throwing. */
+expected<V> try_from_json(KeyId id, const json& value);
+
+/** Parse a value for a given key from `json`, without throwing.
+Returns an `invalid_key` error (holding a copy of `key`) on unknown
+key. */
+expected<V> try_from_json(std::string_view key, const json& value);
+
+/** Format a value for a given key to `std::string`. */
+std::string to_string(KeyId id, const V& value);
 
 /** Format a value for a given key to `std::string`.
 Throws `invalid_key` exception on unknown key. */
-std::string to_string(const K& key, const V& value);
+std::string to_string(std::string_view key, const V& value);
+
+/** Format a value for a given key to `json`. */
+json to_json(KeyId id, const V& value);
+
+/** Format a value for a given key to `json`.
+Throws `invalid_key` exception on unknown key. */
+json to_json(std::string_view key, const V& value);
+
+/** Find a flag by name (without `--`). */
+const cli_flag* find_cli_flag(std::string_view name) noexcept;
+
+/** Find a flag by short name. */
+const cli_flag* find_cli_flag(char short_name) noexcept;
+
+/** Parse command line arguments into a diff, `argv[0]` being the program
+name.
+Values are given as `--name=value`, `--name value`, `-c value`, `-cvalue`,
+`-c=value`, switches may be grouped (`-abc`). `unset` and `reset` values
+unset a key or set it to its value in `defaults`.
+Throws `std::invalid_argument` on missing values, and the exceptions of
+`from_string()` on invalid ones. */
+cli_args parse_cli(int argc, const char* const* argv, const S& defaults, std::string_view unset, std::string_view reset);
+
+/** Help text of the flags, with their values in `defaults`. */
+std::string cli_help(const S& defaults);
+
+/** An instance that records which fields are modified through it, so the
+changes can be retrieved in time proportional to their number. */
+class Tracked {
+public:
+  Tracked() = default;
+  explicit Tracked(const S& s) : s(s) {}
+
+  const S& value() const { return s; }
+
+  void set(KeyId id, const V& value) {
+    ::options_ns::f3d_options_io::set(s, id, value);
+    mark(id);
+  }
+  void set(std::string_view key, const V& value) { set(key_id(key), value); }
+
+  void unset(KeyId id) {
+    ::options_ns::f3d_options_io::unset(s, id);
+    mark(id);
+  }
+  void unset(std::string_view key) { unset(key_id(key)); }
+
+  void apply(const Diff& diff) {
+    for (const auto& [id, value] : diff)
+      if (value.has_value())
+        set(id, value.value());
+      else
+        unset(id);
+  }
+
+  bool changed(KeyId id) const {
+    const size_t i = static_cast<size_t>(id);
+    return dirty[i / 64] & (uint64_t(1) << (i % 64));
+  }
+
+  /** Retrieve the current values of the fields modified since the last call
+  and reset the tracking. */
+  Diff take_changes() {
+    Diff changes;
+    for (size_t w = 0; w < dirty.size(); ++w)
+      for (uint64_t bits = std::exchange(dirty[w], 0); bits; bits &= bits - 1) {
+        const auto id = static_cast<KeyId>(w * 64 + std::countr_zero(bits));
+        changes[id] = ::options_ns::f3d_options_io::get(s, id);
+      }
+    return changes;
+  }
+
+  void clear_changes() { dirty.fill(0); }
+
+private:
+  S s;
+  std::array<uint64_t, 1> dirty = {};
+
+  void mark(KeyId id) {
+    const size_t i = static_cast<size_t>(id);
+    dirty[i / 64] |= uint64_t(1) << (i % 64);
+  }
+};
+
+/** Compile-time access to the field of a key. */
+template <KeyId id> struct field;
+
+template <> struct field<KeyId::camera_azimuth_angle> {
+  typedef std::optional<double> type;
+  static constexpr type& get(S& s) noexcept { return s.camera.azimuth_angle; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.azimuth_angle;
+  }
+};
+template <> struct field<KeyId::camera_direction> {
+  typedef Vector3 type;
+  static constexpr type& get(S& s) noexcept { return s.camera.direction; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.direction;
+  }
+};
+template <> struct field<KeyId::camera_elevation_angle> {
+  typedef std::optional<double> type;
+  static constexpr type& get(S& s) noexcept { return s.camera.elevation_angle; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.elevation_angle;
+  }
+};
+template <> struct field<KeyId::camera_focal_point> {
+  typedef std::optional<Point3> type;
+  static constexpr type& get(S& s) noexcept { return s.camera.focal_point; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.focal_point;
+  }
+};
+template <> struct field<KeyId::camera_position> {
+  typedef std::optional<Point3> type;
+  static constexpr type& get(S& s) noexcept { return s.camera.position; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.position;
+  }
+};
+template <> struct field<KeyId::camera_view_angle> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.camera.view_angle; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.view_angle;
+  }
+};
+template <> struct field<KeyId::camera_view_up> {
+  typedef std::optional<Vector3> type;
+  static constexpr type& get(S& s) noexcept { return s.camera.view_up; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.view_up;
+  }
+};
+template <> struct field<KeyId::camera_zoom_factor> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.camera.zoom_factor; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.camera.zoom_factor;
+  }
+};
+template <> struct field<KeyId::interactor_axis> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.interactor.axis; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.interactor.axis;
+  }
+};
+template <> struct field<KeyId::interactor_trackball> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.interactor.trackball; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.interactor.trackball;
+  }
+};
+template <> struct field<KeyId::model_color_opacity> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.model.color.opacity; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.color.opacity;
+  }
+};
+template <> struct field<KeyId::model_color_rgb> {
+  typedef Color type;
+  static constexpr type& get(S& s) noexcept { return s.model.color.rgb; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.color.rgb;
+  }
+};
+template <> struct field<KeyId::model_color_texture> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.model.color.texture; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.color.texture;
+  }
+};
+template <> struct field<KeyId::model_emissive_factor> {
+  typedef Vector3 type;
+  static constexpr type& get(S& s) noexcept { return s.model.emissive.factor; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.emissive.factor;
+  }
+};
+template <> struct field<KeyId::model_emissive_texture> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.model.emissive.texture; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.emissive.texture;
+  }
+};
+template <> struct field<KeyId::model_matcap_texture> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.model.matcap.texture; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.matcap.texture;
+  }
+};
+template <> struct field<KeyId::model_material_metallic> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.model.material.metallic; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.material.metallic;
+  }
+};
+template <> struct field<KeyId::model_material_roughness> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.model.material.roughness; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.material.roughness;
+  }
+};
+template <> struct field<KeyId::model_material_texture> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.model.material.texture; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.material.texture;
+  }
+};
+template <> struct field<KeyId::model_normal_scale> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.model.normal.scale; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.normal.scale;
+  }
+};
+template <> struct field<KeyId::model_normal_texture> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.model.normal.texture; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.normal.texture;
+  }
+};
+template <> struct field<KeyId::model_point_sprites_enable> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.model.point_sprites.enable; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.point_sprites.enable;
+  }
+};
+template <> struct field<KeyId::model_scivis_cells> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.model.scivis.cells; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.scivis.cells;
+  }
+};
+template <> struct field<KeyId::model_scivis_colormap> {
+  typedef Colormap type;
+  static constexpr type& get(S& s) noexcept { return s.model.scivis.colormap; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.scivis.colormap;
+  }
+};
+template <> struct field<KeyId::model_scivis_component> {
+  typedef int type;
+  static constexpr type& get(S& s) noexcept { return s.model.scivis.component; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.scivis.component;
+  }
+};
+template <> struct field<KeyId::model_scivis_range> {
+  typedef std::optional<std::pair<double, double>> type;
+  static constexpr type& get(S& s) noexcept { return s.model.scivis.range; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.scivis.range;
+  }
+};
+template <> struct field<KeyId::model_volume_enable> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.model.volume.enable; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.volume.enable;
+  }
+};
+template <> struct field<KeyId::model_volume_inverse> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.model.volume.inverse; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.volume.inverse;
+  }
+};
+template <> struct field<KeyId::model_volume_opacity_map> {
+  typedef std::vector<double> type;
+  static constexpr type& get(S& s) noexcept { return s.model.volume.opacity_map; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.model.volume.opacity_map;
+  }
+};
+template <> struct field<KeyId::render_background_blur_coc> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.render.background.blur.coc; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.background.blur.coc;
+  }
+};
+template <> struct field<KeyId::render_background_blur_enable> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.background.blur.enable; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.background.blur.enable;
+  }
+};
+template <> struct field<KeyId::render_background_color> {
+  typedef Color type;
+  static constexpr type& get(S& s) noexcept { return s.render.background.color; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.background.color;
+  }
+};
+template <> struct field<KeyId::render_background_hdri> {
+  typedef std::string type;
+  static constexpr type& get(S& s) noexcept { return s.render.background.hdri; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.background.hdri;
+  }
+};
+template <> struct field<KeyId::render_effect_ambient_occlusion> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.effect.ambient_occlusion; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.effect.ambient_occlusion;
+  }
+};
+template <> struct field<KeyId::render_effect_anti_aliasing> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.effect.anti_aliasing; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.effect.anti_aliasing;
+  }
+};
+template <> struct field<KeyId::render_effect_tone_mapping> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.effect.tone_mapping; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.effect.tone_mapping;
+  }
+};
+template <> struct field<KeyId::render_effect_translucency_support> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.effect.translucency_support; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.effect.translucency_support;
+  }
+};
+template <> struct field<KeyId::render_grid_absolute> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.grid.absolute; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.grid.absolute;
+  }
+};
+template <> struct field<KeyId::render_grid_enable> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.grid.enable; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.grid.enable;
+  }
+};
+template <> struct field<KeyId::render_grid_subdivisions> {
+  typedef int type;
+  static constexpr type& get(S& s) noexcept { return s.render.grid.subdivisions; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.grid.subdivisions;
+  }
+};
+template <> struct field<KeyId::render_grid_unit> {
+  typedef std::optional<double> type;
+  static constexpr type& get(S& s) noexcept { return s.render.grid.unit; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.grid.unit;
+  }
+};
+template <> struct field<KeyId::render_line_width> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.render.line_width; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.line_width;
+  }
+};
+template <> struct field<KeyId::render_point_size> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.render.point_size; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.point_size;
+  }
+};
+template <> struct field<KeyId::render_raytracing_denoise> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.raytracing.denoise; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.raytracing.denoise;
+  }
+};
+template <> struct field<KeyId::render_raytracing_enable> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.raytracing.enable; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.raytracing.enable;
+  }
+};
+template <> struct field<KeyId::render_raytracing_samples> {
+  typedef int type;
+  static constexpr type& get(S& s) noexcept { return s.render.raytracing.samples; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.raytracing.samples;
+  }
+};
+template <> struct field<KeyId::render_show_edges> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.render.show_edges; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.render.show_edges;
+  }
+};
+template <> struct field<KeyId::scene_animation_frame_rate> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.scene.animation.frame_rate; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.animation.frame_rate;
+  }
+};
+template <> struct field<KeyId::scene_animation_index> {
+  typedef int type;
+  static constexpr type& get(S& s) noexcept { return s.scene.animation.index; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.animation.index;
+  }
+};
+template <> struct field<KeyId::scene_animation_speed_factor> {
+  typedef double type;
+  static constexpr type& get(S& s) noexcept { return s.scene.animation.speed_factor; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.animation.speed_factor;
+  }
+};
+template <> struct field<KeyId::scene_camera_index> {
+  typedef int type;
+  static constexpr type& get(S& s) noexcept { return s.scene.camera.index; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.camera.index;
+  }
+};
+template <> struct field<KeyId::scene_reader_options> {
+  typedef std::map<std::string, std::string> type;
+  static constexpr type& get(S& s) noexcept { return s.scene.reader_options; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.reader_options;
+  }
+};
+template <> struct field<KeyId::scene_up_direction> {
+  typedef Vector3 type;
+  static constexpr type& get(S& s) noexcept { return s.scene.up_direction; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.scene.up_direction;
+  }
+};
+template <> struct field<KeyId::ui_bar> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.ui.bar; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.bar;
+  }
+};
+template <> struct field<KeyId::ui_filename> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.ui.filename; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.filename;
+  }
+};
+template <> struct field<KeyId::ui_font_file> {
+  typedef std::optional<std::string> type;
+  static constexpr type& get(S& s) noexcept { return s.ui.font_file; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.font_file;
+  }
+};
+template <> struct field<KeyId::ui_fps> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.ui.fps; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.fps;
+  }
+};
+template <> struct field<KeyId::ui_loader_progress> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.ui.loader_progress; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.loader_progress;
+  }
+};
+template <> struct field<KeyId::ui_metadata> {
+  typedef bool type;
+  static constexpr type& get(S& s) noexcept { return s.ui.metadata; }
+  static constexpr const type& get(const S& s) noexcept {
+    return s.ui.metadata;
+  }
+};
+
+/** Get a reference to a field by compile-time key. */
+template <KeyId id>
+constexpr typename field<id>::type& get(S& s) noexcept {
+  return field<id>::get(s);
+}
+template <KeyId id>
+constexpr const typename field<id>::type& get(const S& s) noexcept {
+  return field<id>::get(s);
+}
+
+/** Description of a field, from the parsed struct. */
+struct field_info {
+  KeyId id;
+  std::string_view key;
+  std::string_view type;
+  std::string_view canonical_type;
+  bool is_optional;
+  bool has_default;
+  Impact impact;
+  std::string_view doc; // comment, without markers
+};
+
+/** Descriptions of the fields, in key order (indexed by `KeyId`). */
+inline constexpr std::array<field_info, 59> field_infos = {{
+  {
+    KeyId::camera_azimuth_angle,
+    "camera.azimuth_angle",
+    "double",
+    "double",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::camera_azimuth_angle)],
+    "additional azimuth angle.\nApply an azimuth transformation to the camera, in degrees, added after\nother camera options.",
+  },
+  {
+    KeyId::camera_direction,
+    "camera.direction",
+    "Vector3",
+    "std::array<double, 3>",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::camera_direction)],
+    "Set the camera *direction*.\n@cli(camera-direction)",
+  },
+  {
+    KeyId::camera_elevation_angle,
+    "camera.elevation_angle",
+    "double",
+    "double",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::camera_elevation_angle)],
+    "additional elevation angle.\nApply an elevation transformation to the camera, in degrees, added after\nother camera options.",
+  },
+  {
+    KeyId::camera_focal_point,
+    "camera.focal_point",
+    "Point3",
+    "std::array<double, 3>",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::camera_focal_point)],
+    "Set the camera *focal point*.\n@cli(camera-focus)",
+  },
+  {
+    KeyId::camera_position,
+    "camera.position",
+    "Point3",
+    "std::array<double, 3>",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::camera_position)],
+    "Set the camera *position*.\n@cli(camera-position)",
+  },
+  {
+    KeyId::camera_view_angle,
+    "camera.view_angle",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::camera_view_angle)],
+    "camera view angle in degrees.\na strictly positive value.",
+  },
+  {
+    KeyId::camera_view_up,
+    "camera.view_up",
+    "Vector3",
+    "std::array<double, 3>",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::camera_view_up)],
+    "",
+  },
+  {
+    KeyId::camera_zoom_factor,
+    "camera.zoom_factor",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::camera_zoom_factor)],
+    "zoom factor relative to the autozoom on data.\n a strictly positive value.\n@cli(camera-zoom-factor)",
+  },
+  {
+    KeyId::interactor_axis,
+    "interactor.axis",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::interactor_axis)],
+    "Show *axes* as a trihedron in the scene.\n@render",
+  },
+  {
+    KeyId::interactor_trackball,
+    "interactor.trackball",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::interactor_trackball)],
+    "Enable trackball interaction.\n@render",
+  },
+  {
+    KeyId::model_color_opacity,
+    "model.color.opacity",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_color_opacity)],
+    "Set *opacity* on the geometry. Usually used with Depth Peeling option.\nMultiplied with the `model.color.texture` when present.\n@render",
+  },
+  {
+    KeyId::model_color_rgb,
+    "model.color.rgb",
+    "Color",
+    "std::array<double, 3>",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_color_rgb)],
+    "Set a *color* on the geometry. Multiplied with the\n`model.color.texture` when present.\n@render",
+  },
+  {
+    KeyId::model_color_texture,
+    "model.color.texture",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_color_texture)],
+    "Path to a texture file that sets the color of the object. Will be\nmultiplied with rgb and opacity.\n@render",
+  },
+  {
+    KeyId::model_emissive_factor,
+    "model.emissive.factor",
+    "Vector3",
+    "std::array<double, 3>",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_emissive_factor)],
+    "Multiply the emissive color when an emissive texture is present.\n@render",
+  },
+  {
+    KeyId::model_emissive_texture,
+    "model.emissive.texture",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_emissive_texture)],
+    "Path to a texture file that sets the emitted light of the object.\nMultiplied with the `model.emissive.factor`.\n@render",
+  },
+  {
+    KeyId::model_matcap_texture,
+    "model.matcap.texture",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_matcap_texture)],
+    "Path to a texture file containing a material capture. All other model\noptions for surfaces are ignored if this is set.\n@render",
+  },
+  {
+    KeyId::model_material_metallic,
+    "model.material.metallic",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_material_metallic)],
+    "Set the *metallic coefficient* on the geometry.\nValue should be between `0.0` and `1.0`.\nMultiplied with the `model.material.texture` when present.\n@render",
+  },
+  {
+    KeyId::model_material_roughness,
+    "model.material.roughness",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_material_roughness)],
+    "Set the *roughness coefficient* on the geometry (0.0-1.0). Multiplied\nwith the `model.material.texture` when present.\n@render",
+  },
+  {
+    KeyId::model_material_texture,
+    "model.material.texture",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_material_texture)],
+    "Path to a texture file that sets the Occlusion, Roughness and Metallic\nvalues of the object. Multiplied with the `model.material.roughness`\nand `model.material.metallic`, set both of them to 1.0 to get a true\nresult.\n@render",
+  },
+  {
+    KeyId::model_normal_scale,
+    "model.normal.scale",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_normal_scale)],
+    "Normal scale affects the strength of the normal deviation from the\nnormal texture.\n@render",
+  },
+  {
+    KeyId::model_normal_texture,
+    "model.normal.texture",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_normal_texture)],
+    "Path to a texture file that sets the normal map of the object.\n@render",
+  },
+  {
+    KeyId::model_point_sprites_enable,
+    "model.point_sprites.enable",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_point_sprites_enable)],
+    "Show sphere *points sprites* instead of the geometry.\n@render",
+  },
+  {
+    KeyId::model_scivis_cells,
+    "model.scivis.cells",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_scivis_cells)],
+    "Color the data with value found *on the cells* instead of points\n@render",
+  },
+  {
+    KeyId::model_scivis_colormap,
+    "model.scivis.colormap",
+    "Colormap",
+    "Colormap_t",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_scivis_colormap)],
+    "Set a *custom colormap for the coloring*.\nThis is the name of a built-in palette (`viridis`, `plasma`,\n`inferno`, `magma`, `cividis`, `coolwarm`, `grayscale`, `redblue`,\n`frenchflag`), the path of a file listing colors, or a\ncomma-separated list of colors.\n@render @cli(colormap)",
+  },
+  {
+    KeyId::model_scivis_component,
+    "model.scivis.component",
+    "int",
+    "int",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_scivis_component)],
+    "Specify the component to color with. -1 means *magnitude*. -2 means\n*direct values*.\n@render",
+  },
+  {
+    KeyId::model_scivis_range,
+    "model.scivis.range",
+    "std::pair<double, double>",
+    "std::pair<double, double>",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_scivis_range)],
+    "Set a *custom range for the coloring*, as `min,max`.\n@render @cli(range)",
+  },
+  {
+    KeyId::model_volume_enable,
+    "model.volume.enable",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_volume_enable)],
+    "Enable *volume rendering*. It is only available for 3D image data\n(vti, dcm, nrrd, mhd files) and will display nothing with other default\nscene formats.\n@render",
+  },
+  {
+    KeyId::model_volume_inverse,
+    "model.volume.inverse",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::model_volume_inverse)],
+    "Inverse the linear opacity function.\n@render",
+  },
+  {
+    KeyId::model_volume_opacity_map,
+    "model.volume.opacity_map",
+    "std::vector<double>",
+    "std::vector<double>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::model_volume_opacity_map)],
+    "Opacities evenly spaced over the coloring range, replacing the linear\nopacity function when not empty.\n@render",
+  },
+  {
+    KeyId::render_background_blur_coc,
+    "render.background.blur.coc",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_background_blur_coc)],
+    "Blur background circle of confusion radius.\n@render",
+  },
+  {
+    KeyId::render_background_blur_enable,
+    "render.background.blur.enable",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_background_blur_enable)],
+    "Blur background when using a HDRI.\n@render",
+  },
+  {
+    KeyId::render_background_color,
+    "render.background.color",
+    "Color",
+    "std::array<double, 3>",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_background_color)],
+    "Set the window *background color*.\nIgnored if *hdri* is set.\n@render @cli(b,background-color)",
+  },
+  {
+    KeyId::render_background_hdri,
+    "render.background.hdri",
+    "std::string",
+    "std::basic_string<char>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::render_background_hdri)],
+    "Set the *HDRI* image used to create the environment.\nThe environment act as a light source and is reflected on the material.\nValid file format are hdr, exr, png, jpg, pnm, tiff, bmp. Override the\ncolor.\n@render",
+  },
+  {
+    KeyId::render_effect_ambient_occlusion,
+    "render.effect.ambient_occlusion",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_effect_ambient_occlusion)],
+    "Enable *ambient occlusion*. This is a technique providing approximate\nshadows, used to improve the depth perception of the object.\nImplemented using SSAO\n@render @cli(ambient-occlusion)",
+  },
+  {
+    KeyId::render_effect_anti_aliasing,
+    "render.effect.anti_aliasing",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_effect_anti_aliasing)],
+    "Enable *anti-aliasing*. This technique is used to reduce aliasing,\nimplemented using FXAA.\n@render @cli(anti-aliasing)",
+  },
+  {
+    KeyId::render_effect_tone_mapping,
+    "render.effect.tone_mapping",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_effect_tone_mapping)],
+    "Enable generic filmic *Tone Mapping Pass*.\nThis technique is used to map colors properly to the monitor colors.\n@render @cli(tone-mapping)",
+  },
+  {
+    KeyId::render_effect_translucency_support,
+    "render.effect.translucency_support",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_effect_translucency_support)],
+    "Enable *translucency support*. This is a technique used to correctly\nrender translucent objects, implemented using depth peeling\n@render @cli(translucency)",
+  },
+  {
+    KeyId::render_grid_absolute,
+    "render.grid.absolute",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_grid_absolute)],
+    "Position the grid at the *absolute origin* of the model's coordinate\nsystem instead of below the model.\n@render",
+  },
+  {
+    KeyId::render_grid_enable,
+    "render.grid.enable",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_grid_enable)],
+    "Show *a grid* aligned with the horizontal (orthogonal to the Up\ndirection) plane.\n@render @cli(g,grid)",
+  },
+  {
+    KeyId::render_grid_subdivisions,
+    "render.grid.subdivisions",
+    "int",
+    "int",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_grid_subdivisions)],
+    "Set the number of subdivisions for the grid.\n@render",
+  },
+  {
+    KeyId::render_grid_unit,
+    "render.grid.unit",
+    "double",
+    "double",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::render_grid_unit)],
+    "Set the size of the *unit square* for the grid. If set to non-positive\n(the default) a suitable value will be automatically computed.\n@render @cli(grid-unit)",
+  },
+  {
+    KeyId::render_line_width,
+    "render.line_width",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_line_width)],
+    "Set the *width* of lines when showing edges.\n@render",
+  },
+  {
+    KeyId::render_point_size,
+    "render.point_size",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_point_size)],
+    "Set the *size* of points when showing vertices and point sprites.\n@render",
+  },
+  {
+    KeyId::render_raytracing_denoise,
+    "render.raytracing.denoise",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_raytracing_denoise)],
+    "*Denoise* the raytracing rendering.\n@render",
+  },
+  {
+    KeyId::render_raytracing_enable,
+    "render.raytracing.enable",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_raytracing_enable)],
+    "Enable *raytracing*. Requires the raytracing module to be enabled.\n@render",
+  },
+  {
+    KeyId::render_raytracing_samples,
+    "render.raytracing.samples",
+    "int",
+    "int",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_raytracing_samples)],
+    "The number of *samples per pixel*.\n@render",
+  },
+  {
+    KeyId::render_show_edges,
+    "render.show_edges",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::render_show_edges)],
+    "Show the *cell edges*\n@render",
+  },
+  {
+    KeyId::scene_animation_frame_rate,
+    "scene.animation.frame_rate",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::scene_animation_frame_rate)],
+    "Set the animation frame rate used to play the animation interactively.\n\n@render",
+  },
+  {
+    KeyId::scene_animation_index,
+    "scene.animation.index",
+    "int",
+    "int",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::scene_animation_index)],
+    "Select the animation to load.\nAny negative value means all animations (glTF only).\nThe default scene always has at most one animation.\n@load",
+  },
+  {
+    KeyId::scene_animation_speed_factor,
+    "scene.animation.speed_factor",
+    "double",
+    "double",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::scene_animation_speed_factor)],
+    "Set the animation speed factor to slow, speed up or even invert\nanimation.\n@render",
+  },
+  {
+    KeyId::scene_camera_index,
+    "scene.camera.index",
+    "int",
+    "int",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::scene_camera_index)],
+    "Select the scene camera to use when available in the file.\nAny negative value means automatic camera.\nThe default scene always uses automatic camera.\n@load",
+  },
+  {
+    KeyId::scene_reader_options,
+    "scene.reader_options",
+    "std::map<std::string, std::string>",
+    "std::map<std::basic_string<char>, std::basic_string<char>>",
+    false,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::scene_reader_options)],
+    "Options passed to the readers, as `name=value` pairs.\n@load",
+  },
+  {
+    KeyId::scene_up_direction,
+    "scene.up_direction",
+    "Vector3",
+    "std::array<double, 3>",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::scene_up_direction)],
+    "Define the Up direction\n@load @cli(up)",
+  },
+  {
+    KeyId::ui_bar,
+    "ui.bar",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::ui_bar)],
+    "Show *scalar bar* of the coloring by data array.\n@render",
+  },
+  {
+    KeyId::ui_filename,
+    "ui.filename",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::ui_filename)],
+    "Display the *filename info content* on top of the window.\n@render",
+  },
+  {
+    KeyId::ui_font_file,
+    "ui.font_file",
+    "std::string",
+    "std::basic_string<char>",
+    true,
+    false,
+    key_impacts[static_cast<size_t>(KeyId::ui_font_file)],
+    "Use the provided FreeType compatible font file to display text.\nCan be useful to display non-ASCII filenames.\n@render @cli(font)",
+  },
+  {
+    KeyId::ui_fps,
+    "ui.fps",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::ui_fps)],
+    "Display a *frame per second counter*.\n@render",
+  },
+  {
+    KeyId::ui_loader_progress,
+    "ui.loader_progress",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::ui_loader_progress)],
+    "Show a *progress bar* when loading the file.\n@load",
+  },
+  {
+    KeyId::ui_metadata,
+    "ui.metadata",
+    "bool",
+    "bool",
+    false,
+    true,
+    key_impacts[static_cast<size_t>(KeyId::ui_metadata)],
+    "Display the *metadata*.\n@render",
+  },
+}};
+
+template <KeyId id> using key_constant = std::integral_constant<KeyId, id>;
+
+/** Call `f(key, value)` for each field, in key order, with `key` a
+`key_constant` (its `value` being the `KeyId`, usable as a template argument
+or to index `field_infos` at compile-time) and `value` a reference to the
+field. The calls are expanded at compile-time. */
+template <typename F> constexpr void for_each_field(S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+template <typename F> constexpr void for_each_field(const S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
 
+/** Call `f(key, a_value, b_value)` for each field of two instances. */
+template <typename F>
+constexpr void for_each_field(const S& a, const S& b, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(a),
+       get<static_cast<KeyId>(i)>(b)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
 class invalid_key : public std::out_of_range {
 public:
-  explicit invalid_key(const K& key):
-    std::out_of_range("invalid key: " + key) {}
+  explicit invalid_key(std::string_view key):
+    std::out_of_range("invalid key: " + std::string(key)) {}
 };
 
 class non_optional_key : public std::out_of_range {
 public:
-  explicit non_optional_key(const K& key):
-    std::out_of_range("non-optional key: " + key) {}
+  explicit non_optional_key(std::string_view key):
+    std::out_of_range("non-optional key: " + std::string(key)) {}
 };
 
 
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <initializer_list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -12,8 +16,45 @@ typedef std::array<double, 3> Color;
 typedef std::array<double, 3> Vector3;
 typedef std::array<double, 3> Point3;
 
+/* immutable array of colors, shared by the copies of a table */
+class ColorTable {
+public:
+  ColorTable() = default;
+  ColorTable(std::initializer_list<Color> colors)
+      : ColorTable(std::vector<Color>(colors)) {}
+  explicit ColorTable(std::vector<Color> colors) {
+    const auto owner =
+        std::make_shared<const std::vector<Color>>(std::move(colors));
+    first = std::shared_ptr<const Color>(owner, owner->data());
+    count = owner->size();
+  }
+  /* `count` colors owned by `colors` (or static if it owns nothing) */
+  ColorTable(std::shared_ptr<const Color> colors, size_t count)
+      : first(std::move(colors)), count(count) {}
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  const Color &operator[](size_t i) const { return first.get()[i]; }
+  const Color *data() const { return first.get(); }
+  const Color *begin() const { return first.get(); }
+  const Color *end() const { return first.get() + count; }
+
+  /* the colors, for sharing them with other tables */
+  const std::shared_ptr<const Color> &shared() const { return first; }
+
+  bool operator==(const ColorTable &other) const {
+    return count == other.count &&
+           (first == other.first || std::equal(begin(), end(), other.begin()));
+  }
+  bool operator!=(const ColorTable &other) const { return !(*this == other); }
+
+private:
+  std::shared_ptr<const Color> first;
+  size_t count = 0;
+};
+
 struct Colormap_t {
-  std::vector<Color> colors;
+  ColorTable colors;
   std::string name;
 
   bool operator==(const struct Colormap_t &other) const {
@@ -69,18 +110,32 @@ struct f3d_options {
     } camera;
 
     /** Define the Up direction
-     * @load
+     * @load @cli(up)
      */
     Vector3 up_direction = {0., +1., 0.};
 
+    /** Options passed to the readers, as `name=value` pairs.
+     * @load
+     */
+    std::map<std::string, std::string> reader_options;
+
   } scene;
 
   /** Initial camera parameters*/
   struct camera {
+    /** Set the camera *focal point*.
+     * @cli(camera-focus)
+     */
     std::optional<Point3> focal_point;
 
+    /** Set the camera *position*.
+     * @cli(camera-position)
+     */
     std::optional<Point3> position;
 
+    /** Set the camera *direction*.
+     * @cli(camera-direction)
+     */
     Vector3 direction = {-1., -1., -1.};
 
     std::optional<Vector3> view_up;
@@ -92,6 +147,7 @@ struct f3d_options {
 
     /** zoom factor relative to the autozoom on data.
      *  a strictly positive value.
+     * @cli(camera-zoom-factor)
      */
     double zoom_factor = 0.9;
 
@@ -215,15 +271,15 @@ struct f3d_options {
       bool cells = false;
 
       /** Set a *custom colormap for the coloring*.
-       * This is a list of colors in the format
-       * `val1,red1,green1,blue1,...,valN,redN,greenN,blueN` where all
-       values
-       * are in the range (0,1).
-       * @render
+       * This is the name of a built-in palette (`viridis`, `plasma`,
+       * `inferno`, `magma`, `cividis`, `coolwarm`, `grayscale`, `redblue`,
+       * `frenchflag`), the path of a file listing colors, or a
+       * comma-separated list of colors.
+       * @render @cli(colormap)
        */
       Colormap colormap = {
           .colors = {Color({0., 0., 0.}), Color({1., 1., 1.})},
-          .name = "default",
+          .name = "grayscale",
       };
 
       /** Specify the component to color with. -1 means *magnitude*. -2 means
@@ -239,11 +295,10 @@ struct f3d_options {
       //      //   */
       //  std::string array_name = "<reserved>";
 
-      // TODO pair<double, double>?
-      //  /** Set a *custom range for the coloring*.
-      //   * @render
-      //      //   */
-      //  vector<double> range;
+      /** Set a *custom range for the coloring*, as `min,max`.
+       * @render @cli(range)
+       */
+      std::optional<std::pair<double, double>> range;
 
     } scivis;
 
@@ -268,6 +323,12 @@ struct f3d_options {
        */
       bool inverse = false;
 
+      /** Opacities evenly spaced over the coloring range, replacing the linear
+       * opacity function when not empty.
+       * @render
+       */
+      std::vector<double> opacity_map;
+
     } volume;
 
   } model;
@@ -279,26 +340,26 @@ struct f3d_options {
     struct effect {
       /** Enable *translucency support*. This is a technique used to correctly
        * render translucent objects, implemented using depth peeling
-       * @render
+       * @render @cli(translucency)
        */
       bool translucency_support = false;
 
       /** Enable *anti-aliasing*. This technique is used to reduce aliasing,
        * implemented using FXAA.
-       * @render
+       * @render @cli(anti-aliasing)
        */
       bool anti_aliasing = false;
 
       /** Enable *ambient occlusion*. This is a technique providing approximate
        * shadows, used to improve the depth perception of the object.
        * Implemented using SSAO
-       * @render
+       * @render @cli(ambient-occlusion)
        */
       bool ambient_occlusion = false;
 
       /** Enable generic filmic *Tone Mapping Pass*.
        * This technique is used to map colors properly to the monitor colors.
-       * @render
+       * @render @cli(tone-mapping)
        */
       bool tone_mapping = false;
 
@@ -322,7 +383,7 @@ struct f3d_options {
     struct grid {
       /** Show *a grid* aligned with the horizontal (orthogonal to the Up
        * direction) plane.
-       * @render
+       * @render @cli(g,grid)
        */
       bool enable = false;
 
@@ -334,7 +395,7 @@ struct f3d_options {
 
       /** Set the size of the *unit square* for the grid. If set to non-positive
        * (the default) a suitable value will be automatically computed.
-       * @render
+       * @render @cli(grid-unit)
        */
       std::optional<double> unit;
 
@@ -366,7 +427,7 @@ struct f3d_options {
     struct background {
       /** Set the window *background color*.
        * Ignored if *hdri* is set.
-       * @render
+       * @render @cli(b,background-color)
        */
       Color color = {0.2, 0.2, 0.2};
 
@@ -409,7 +470,7 @@ struct f3d_options {
 
     /** Use the provided FreeType compatible font file to display text.
      * Can be useful to display non-ASCII filenames.
-     * @render
+     * @render @cli(font)
      */
     std::optional<std::string> font_file;
 
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstdio>
+#include <regex>
+#include <stdexcept>
+#include <string>
+
+#include "options.h"
+
+/* The std::regex parsers of Vector3, Point3 and Color that the scanners of
+  options-io.cpp replaced, kept as the reference grammar for the differential
+  test and for the benchmark. Errors are std::invalid_argument (and the
+  std::out_of_range of std::stod) with the messages of the time.
+  The `regex_parsers` functions build their regexes once, for the test; the
+  `regex_parsers::per_call` ones build them on every call like the replaced
+  code did, for the benchmark. */
+namespace regex_parsers {
+
+inline const std::string re_lbrackets = "[\\[\\{\\(]";
+inline const std::string re_rbrackets = "[\\]\\}\\)]";
+inline const std::string re_number =
+    "[+-]?(?:\\d+(?:[.]\\d*)?(?:[eE][+-]?\\d+)?|[.]\\d+(?:[eE][+-]?\\d+)?)";
+inline const std::string re_array3double =
+    "(" + re_lbrackets + ")?\\s*(" + re_number + ")\\s*,?\\s*(" + re_number +
+    ")\\s*,?\\s*(" + re_number + ")\\s*(" + re_rbrackets + ")?";
+
+inline std::regex array3_regex() {
+  return std::regex(re_array3double, std::regex_constants::icase);
+}
+inline std::regex axis_regex() {
+  return std::regex("(([+-]?)(x))?(([+-]?)(y))?(([+-]?)(z))?",
+                    std::regex_constants::icase);
+}
+inline std::regex hex_regex() {
+  return std::regex("#([0-9a-f]{6})", std::regex_constants::icase);
+}
+
+/* the parsers, given their regexes */
+namespace detail {
+
+inline std::array<double, 3> parse_array_double3(const std::string &s,
+                                                 const std::regex &pattern) {
+  std::smatch match;
+  if (std::regex_match(s, match, pattern)) {
+    if ((match[1] == "(" and match[5] != ")") ||
+        (match[1] == "[" and match[5] != "]") ||
+        (match[1] == "{" and match[5] != "}") ||
+        (match[1] == "" and match[5] != ""))
+      throw std::invalid_argument("mismatched brackets");
+    return {std::stod(match[2]), std::stod(match[3]), std::stod(match[4])};
+  }
+  throw std::invalid_argument("not a number triple");
+}
+
+/* `array3` is only called if `s` is not an axis */
+template <typename Array3>
+Vector3 parse_Vector3(const std::string &s, const std::regex &pattern,
+                      Array3 &&array3) {
+  std::smatch match;
+  if (std::regex_match(s, match, pattern)) {
+    int sign = 1;
+    if (match[2] == "-")
+      sign = -1;
+    else if (match[2] == "+")
+      sign = +1;
+
+    double x = match[3] == "" ? 0 : sign;
+
+    if (match[5] == "-")
+      sign = -1;
+    else if (match[5] == "+")
+      sign = +1;
+
+    double y = match[6] == "" ? 0 : sign;
+
+    if (match[8] == "-")
+      sign = -1;
+    else if (match[8] == "+")
+      sign = +1;
+
+    double z = match[9] == "" ? 0 : sign;
+
+    return {x, y, z};
+  }
+  try {
+    return parse_array_double3(s, array3());
+  } catch (std::invalid_argument &e) {
+    throw std::invalid_argument("cannot parse Vector3 (" +
+                                std::string(e.what()) + ")");
+  }
+}
+
+inline Point3 parse_Point3(const std::string &s, const std::regex &array3) {
+  try {
+    return parse_array_double3(s, array3);
+  } catch (std::invalid_argument &e) {
+    throw std::invalid_argument("cannot parse Point3 (" +
+                                std::string(e.what()) + ")");
+  }
+}
+
+/* `array3` is only called if `s` is not a hex color */
+template <typename Array3>
+Color parse_Color(const std::string &s, const std::regex &hexPattern,
+                  Array3 &&array3) {
+  std::smatch match;
+  if (std::regex_match(s, match, hexPattern)) {
+    int r = 0, g = 0, b = 0;
+    std::sscanf(match[1].str().c_str(), "%02x%02x%02x", &r, &g, &b);
+    return {r / 255., g / 255., b / 255.};
+  }
+
+  try {
+    return parse_array_double3(s, array3());
+  } catch (std::invalid_argument &e) {
+    throw std::invalid_argument("cannot parse Color (" + std::string(e.what()) +
+                                ")");
+  }
+}
+
+inline const std::regex &cached_array3_regex() {
+  static const std::regex pattern = array3_regex();
+  return pattern;
+}
+
+} // namespace detail
+
+inline Vector3 parse_Vector3(const std::string &s) {
+  static const std::regex pattern = axis_regex();
+  return detail::parse_Vector3(s, pattern, detail::cached_array3_regex);
+}
+
+inline Point3 parse_Point3(const std::string &s) {
+  return detail::parse_Point3(s, detail::cached_array3_regex());
+}
+
+inline Color parse_Color(const std::string &s) {
+  static const std::regex pattern = hex_regex();
+  return detail::parse_Color(s, pattern, detail::cached_array3_regex);
+}
+
+namespace per_call {
+
+inline Vector3 parse_Vector3(const std::string &s) {
+  return detail::parse_Vector3(s, axis_regex(), array3_regex);
+}
+
+inline Point3 parse_Point3(const std::string &s) {
+  return detail::parse_Point3(s, array3_regex());
+}
+
+inline Color parse_Color(const std::string &s) {
+  return detail::parse_Color(s, hex_regex(), array3_regex);
+}
+
+} // namespace per_call
+
+} // namespace regex_parsers
@@ -8,7 +8,7 @@ import re
 from dataclasses import dataclass
 from functools import lru_cache
 from pathlib import Path
-from typing import Any, Callable, Iterable, Iterator, Union
+from typing import Any, Callable, Iterable, Iterator, Union, cast
 
 
 def main():
@@ -30,12 +30,38 @@ def main():
         action="append",
         metavar="type;from_type;type_to_%",
     )
+    parser.add_argument(
+        "--try-parse",
+        action="append",
+        metavar="type;try_from_type;try_type_to_%",
+        help="like --parse for functions returning `expected<T>` instead of"
+        " throwing, also enables `try_apply`",
+    )
     parser.add_argument(
         "--format",
         action="append",
         metavar="type;to_type;type_from_%",
     )
+    parser.add_argument(
+        "--fingerprint",
+        action="store_true",
+        help="generate `fingerprint()` and `set`/`unset`/`apply` overloads"
+        " maintaining one, hashing values with `field_hash()` (options-hash.h)",
+    )
     parser.add_argument("--key-sep", default="/")
+    parser.add_argument(
+        "--key-lookup",
+        choices=["perfect-hash", "lower-bound"],
+        default="perfect-hash",
+        help="how keys are looked up by the generated code",
+    )
+    parser.add_argument(
+        "--dispatch",
+        choices=["switch", "table"],
+        default="switch",
+        help="how the generated functions find the field of a key: a `switch`"
+        " per function, or a `table` of field descriptors shared by all",
+    )
     parser.add_argument(
         "--key", dest="key_overides", action="append", metavar="a.b.c=C"
     )
@@ -63,10 +89,13 @@ def main():
                 id = ".".join(identifiers[: i + 1])
                 yield key_overides.get(id, identifiers[i])
 
-        return ".".join(f())
+        return args.key_sep.join(f())
 
     parsers = [CustomIO.From_str(a) for a in args.parse] if args.parse else []
     formatters = [CustomIO.From_str(a) for a in args.format] if args.format else []
+    try_parsers = (
+        [CustomIO.From_str(a) for a in args.try_parse] if args.try_parse else []
+    )
 
     struct_json_path = Path(args.struct_json)
     struct_json = json.load(open(struct_json_path))
@@ -94,7 +123,42 @@ def main():
                 for k, v in struct_json1.items()
                 if "type" in v
             )
-            functions = list(cpp_functions(sorted_vars, parsers, formatters))
+            key_functions = list(
+                key_cpp_functions(sorted_vars, args.key_lookup, args.key_sep)
+            )
+            functions = list(
+                cpp_functions(
+                    sorted_vars,
+                    parsers,
+                    formatters,
+                    try_parsers,
+                    args.dispatch,
+                    args.fingerprint,
+                )
+            )
+            field_table = (
+                list(
+                    field_table_code(
+                        sorted_vars,
+                        parsers,
+                        formatters,
+                        try_parsers,
+                        args.fingerprint,
+                    )
+                )
+                if args.dispatch == "table"
+                else []
+            )
+            flags = cli_flags(sorted_vars, args.key_sep)
+            cli_parser = next((p for p in parsers if p.type == "std::string"), None)
+            cli_formatter = next(
+                (f for f in formatters if f.type == "std::string"), None
+            )
+            if flags and cli_parser and cli_formatter:
+                functions += cli_functions(flags, cli_parser, cli_formatter)
+            elif flags:
+                logging.warning("no std::string parse/format, @cli tags ignored")
+                flags = []
 
             f_incl.write("\n")
             f_incl.write("\n")
@@ -103,7 +167,9 @@ def main():
                 sorted_vars,
                 struct_qual_name,
                 gen_namespace,
+                key_functions,
                 functions,
+                flags,
             ):
                 f_incl.write(line)
                 f_incl.write("\n")
@@ -111,7 +177,15 @@ def main():
             f_impl.write("\n")
             f_impl.write("\n")
             f_impl.write("/" * 80 + "\n")
-            for line in generate_impl(sorted_vars, gen_namespace, functions):
+            for line in generate_impl(
+                sorted_vars,
+                gen_namespace,
+                [*key_functions, *functions],
+                args.key_lookup,
+                flags,
+                field_table,
+                args.fingerprint,
+            ):
                 f_impl.write(line)
                 f_impl.write("\n")
 
@@ -121,13 +195,22 @@ def incl_preamble(includes: list[str]):
     yield ""
 
     for h in (
+        "<algorithm>",
         "<array>",
+        "<bit>",
+        "<bitset>",
+        "<cstddef>",
+        "<cstdint>",
         "<functional>",
         "<map>",
         "<optional>",
         "<stdexcept>",
         "<string>",
+        "<string_view>",
+        "<type_traits>",
+        "<utility>",
         "<variant>",
+        "<vector>",
     ):
         yield f"#include {h}"
     yield ""
@@ -140,7 +223,9 @@ def generate_incl(
     sorted_vars: list[KeyedVar],
     struct_name: str,
     namespace: str,
+    key_functions: list[CppFunc],
     functions: list[CppFunc],
+    flags: list[CliFlag],
 ):
     if namespace:
         yield f"namespace {namespace} {{"
@@ -149,31 +234,55 @@ def generate_incl(
     types: dict[str, set[str]] = {}
     for v in sorted_vars:
         types.setdefault(v.var.canonical_type, set()).add(v.var.type)
+        if element := v.var.vector_element:
+            edit = f"vector_edit<{element}>"
+            types.setdefault(edit, set()).add(edit)
     types2 = [(f"  {k}", ", ".join(sorted(v))) for k, v in sorted(types.items())]
     types3 = ",\n".join(k if k.strip() == v else f"{k} /* {v} */" for k, v in types2)
 
     yield f"typedef ::{struct_name} S; // Struct"
     yield "typedef std::string K; // Key"
     yield f"typedef std::variant<\n{types3}\n> V; // Value"
-    yield "typedef std::map<K, std::optional<V>> Diff;"
     yield ""
 
     yield keys_struct_code(sorted_vars, "keys")
     yield ""
 
+    yield "/** Dense key identifiers, in key order. */"
+    yield f"enum class KeyId : uint16_t {{"
+    for v in sorted_vars:
+        yield f"  {v.enum}, // {json.dumps(v.key)}"
+    yield "};"
+    yield ""
+    yield "/** Set of keys, one bit per `KeyId`. */"
+    yield f"typedef std::bitset<{len(sorted_vars)}> KeySet;"
+    yield ""
+
+    yield from impact_code(sorted_vars)
+
+    for f in key_functions:
+        yield from f.declaration
+    yield DIFF_CLASS_CODE
+
+    if flags:
+        yield from cli_flags_code(flags)
+
     for f in functions:
-        if f.comment:
-            yield f"/** {f.comment} */"
-        yield f"{f.signature};"
-        yield ""
+        yield from f.declaration
+
+    yield tracked_class_code(namespace, len(sorted_vars))
+
+    yield from field_traits_code(sorted_vars)
+
+    yield from field_metadata_code(sorted_vars)
 
     for name, what in [
-        ("invalid_key", '"invalid key: " + key'),
-        ("non_optional_key", '"non-optional key: " + key'),
+        ("invalid_key", '"invalid key: " + std::string(key)'),
+        ("non_optional_key", '"non-optional key: " + std::string(key)'),
     ]:
         yield f"class {name} : public std::out_of_range {{"
         yield "public:"
-        yield f"  explicit {name}(const K& key):"
+        yield f"  explicit {name}(std::string_view key):"
         yield f"    std::out_of_range({what}) {{}}"
         yield "};"
         yield ""
@@ -193,31 +302,47 @@ def generate_impl(
     sorted_vars: list[KeyedVar],
     namespace: str,
     functions: list[CppFunc],
+    key_lookup: str = "perfect-hash",
+    flags: list[CliFlag] = [],
+    field_table: list[str] = [],
+    fingerprint: bool = False,
 ):
-
-    lookup = CppFunc(
-        "inline size_t key_index(const K& key)",
-        [
-            "const auto lower = std::lower_bound("
-            "sorted_keys.begin(), sorted_keys.end(), key);",
-            "if (lower == sorted_keys.end() || *lower != key)",
-            "  throw invalid_key(key);",
-            "else",
-            "  return std::distance(sorted_keys.begin(), lower);",
-        ],
-    )
-
     if namespace:
         yield f"namespace {namespace} {{"
         yield ""
 
-    yield f"const std::array<K, {len(sorted_vars)}> sorted_keys = {{"
+    yield f"constexpr std::array<std::string_view, {len(sorted_vars)}> sorted_keys = {{"
     for i, v in enumerate(sorted_vars):
         yield f"  keys.{v.id}, // {i} {json.dumps(v.key)}"
     yield "};"
     yield ""
 
-    for f in [lookup, *functions]:
+    if fingerprint:
+        yield "/* hashes of `sorted_keys`, see `structio.py:fingerprint_seed()` */"
+        yield (
+            f"constexpr std::array<uint64_t, {len(sorted_vars)}> fingerprint_seeds = {{"
+        )
+        for v in sorted_vars:
+            yield f"  0x{fingerprint_seed(v.key):016X}, // {json.dumps(v.key)}"
+        yield "};"
+        yield ""
+
+    if (key_lookup == "perfect-hash" and sorted_vars) or flags:
+        yield from KEY_HASH_CODE.splitlines()
+        yield ""
+    if key_lookup == "perfect-hash" and sorted_vars:
+        yield "/* perfect hash of `sorted_keys`, see `structio.py:perfect_hash()` */"
+        yield from perfect_hash_code("key_hash", [v.key for v in sorted_vars])
+        yield ""
+    if flags:
+        yield "/* perfect hash of the names of `cli_flags` */"
+        yield from perfect_hash_code("cli_hash", [f.name for f in flags])
+        yield ""
+    if field_table:
+        yield from field_table
+        yield ""
+
+    for f in functions:
         yield f"{f.signature} {{"
         yield f.body
         yield "}"
@@ -227,14 +352,182 @@ def generate_impl(
         yield f"}} // namespace {namespace}"
 
 
+def key_hash(seed: int, key: str):
+    """32 bits FNV-1a, `seed` replaces the offset basis when non-zero.
+    Must match the generated C++ `key_hash`."""
+    h = seed if seed else 0x811C9DC5
+    for c in key.encode():
+        h = ((h ^ c) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def fingerprint_seed(key: str):
+    """64 bits FNV-1a, same as `options_ns::hash_bytes`. Seeds depend on the
+    key only so adding or removing keys keeps the hashes of the others."""
+    h = 0xCBF29CE484222325
+    for c in key.encode():
+        h = ((h ^ c) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def perfect_hash(keys: list[str]):
+    """Compute a minimal perfect hash of `keys` using "hash and displace".
+    Returns `(seeds, slots)`: `seeds[key_hash(0, key) % n]` is either a
+    positive seed for a second `key_hash` or a negative value directly encoding
+    the slot as `-slot - 1`, `slots[slot]` is the index of the key in `keys`."""
+    n = len(keys)
+    buckets: list[list[int]] = [[] for _ in range(n)]
+    for i, key in enumerate(keys):
+        buckets[key_hash(0, key) % n].append(i)
+
+    seeds = [0] * n
+    slots: list[int | None] = [None] * n
+    singles: list[list[int]] = []
+    for bucket in sorted(buckets, key=len, reverse=True):
+        if len(bucket) <= 1:
+            if bucket:
+                singles.append(bucket)
+            continue
+        seed = 1
+        while True:
+            candidates = [key_hash(seed, keys[i]) % n for i in bucket]
+            if len(set(candidates)) == len(candidates) and all(
+                slots[c] is None for c in candidates
+            ):
+                break
+            seed += 1
+            if seed >= 0x7FFFFFFF:
+                raise ValueError("could not find a perfect hash")
+        seeds[key_hash(0, keys[bucket[0]]) % n] = seed
+        for slot, i in zip(candidates, bucket):
+            slots[slot] = i
+
+    free = [slot for slot, i in enumerate(slots) if i is None]
+    for bucket, slot in zip(singles, free):
+        seeds[key_hash(0, keys[bucket[0]]) % n] = -slot - 1
+        slots[slot] = bucket[0]
+
+    return seeds, cast(list[int], slots)
+
+
+KEY_HASH_CODE = """\
+constexpr uint32_t key_hash(uint32_t seed, std::string_view key) {
+  uint32_t h = seed ? seed : 0x811c9dc5u;
+  for (const unsigned char c : key)
+    h = (h ^ c) * 0x01000193u;
+  return h;
+}"""
+
+
+def perfect_hash_code(name: str, keys: list[str]):
+    seeds, slots = perfect_hash(keys)
+
+    def rows(values: list[int], per_row: int = 12):
+        for i in range(0, len(values), per_row):
+            yield "  " + ", ".join(str(v) for v in values[i : i + per_row]) + ","
+
+    yield f"constexpr std::array<int32_t, {len(keys)}> {name}_seeds = {{"
+    yield from rows(seeds)
+    yield "};"
+    yield f"constexpr std::array<uint16_t, {len(keys)}> {name}_slots = {{"
+    yield from rows(slots)
+    yield "};"
+
+
+def throws(invlaid_key: bool = True, non_optional_key: bool = False):
+    comment = ""
+    if invlaid_key:
+        comment += "\nThrows `invalid_key` exception on unknown key."
+    if non_optional_key:
+        comment += "\nThrows `non_optional_key` exception on non-optional key."
+    return comment
+
+
+def key_cpp_functions(sorted_vars: list[KeyedVar], key_lookup: str, key_sep: str):
+    if key_lookup == "perfect-hash" and sorted_vars:
+        lookup = [
+            "const size_t n = sorted_keys.size();",
+            "const int32_t seed = key_hash_seeds[key_hash(0, key) % n];",
+            "const size_t slot = seed < 0 ? -seed - 1 : key_hash(seed, key) % n;",
+            "const size_t index = key_hash_slots[slot];",
+            "if (sorted_keys[index] != key)",
+            "  return std::nullopt;",
+            "else",
+            "  return static_cast<KeyId>(index);",
+        ]
+    else:
+        lookup = [
+            "const auto lower = std::lower_bound("
+            "sorted_keys.begin(), sorted_keys.end(), key);",
+            "if (lower == sorted_keys.end() || *lower != key)",
+            "  return std::nullopt;",
+            "else",
+            "  return static_cast<KeyId>(std::distance(sorted_keys.begin(), lower));",
+        ]
+    yield CppFunc(
+        "std::optional<KeyId> find_key_id(std::string_view key) noexcept",
+        lookup,
+        "Get the identifier of a key, if it exists.",
+    )
+
+    yield CppFunc(
+        "KeyId key_id(std::string_view key)",
+        [
+            "if (const auto id = find_key_id(key))",
+            "  return *id;",
+            "else",
+            "  throw invalid_key(key);",
+        ],
+        "Get the identifier of a key." + throws(invlaid_key=True),
+    )
+
+    yield CppFunc(
+        "std::string_view key_name(KeyId id)",
+        ["return sorted_keys.at(static_cast<size_t>(id));"],
+        "Get the key of an identifier.",
+    )
+
+    yield CppFunc(
+        "std::pair<KeyId, KeyId> key_range(std::string_view prefix) noexcept",
+        [
+            "const auto begin = sorted_keys.begin();",
+            "if (prefix.empty())",
+            "  return {KeyId(0), KeyId(sorted_keys.size())};",
+            "if (const auto id = find_key_id(prefix))",
+            "  return {*id, KeyId(static_cast<size_t>(*id) + 1)};",
+            f"const std::string_view sep = {json.dumps(key_sep)};",
+            "const auto first = std::partition_point(begin, sorted_keys.end(),",
+            "  [&](std::string_view key) {",
+            "    const int c = key.compare(0, prefix.size(), prefix);",
+            "    return c < 0 || (c == 0 && key.substr(prefix.size()) < sep);",
+            "  });",
+            "const auto last = std::partition_point(first, sorted_keys.end(),",
+            "  [&](std::string_view key) {",
+            "    return key.starts_with(prefix) &&",
+            "      key.substr(prefix.size()).starts_with(sep);",
+            "  });",
+            "return {KeyId(first - begin), KeyId(last - begin)};",
+        ],
+        "Get the `[first, last)` range of identifiers of a key and of the keys"
+        "\nnested under it.",
+    )
+
+
 def cpp_functions(
     sorted_vars: list[KeyedVar],
     parsers: Iterable[CustomIO],
     formatters: Iterable[CustomIO],
+    try_parsers: Iterable[CustomIO] = (),
+    dispatch: str = "switch",
+    fingerprint: bool = False,
 ):
+    table = dispatch == "table"
+    desc = "fields[static_cast<size_t>(id)]"
+    has_edits = any(v.var.vector_element for v in sorted_vars)
+
     def keys_switch(
         f: Callable[[KeyedVar], str],
-        default: str = "throw std::invalid_argument(key); // unreachable",
+        default: str = 'throw std::out_of_range("invalid key id"); // unreachable',
         only_optionals: bool = False,
     ):
         branches: dict[str, set[int]] = {}
@@ -243,10 +536,10 @@ def cpp_functions(
                 branches.setdefault(f(var), set()).add(i)
 
         def lines():
-            yield "switch(key_index(key)){"
+            yield "switch(id){"
             for branch, indices in branches.items():
                 for i in sorted(indices):
-                    yield f"  case {i}: // {json.dumps(sorted_vars[i].key)}"
+                    yield f"  case KeyId::{sorted_vars[i].enum}:"
                 yield f"    {branch}"
             if default:
                 yield f"  default: {default}"
@@ -254,101 +547,650 @@ def cpp_functions(
 
         return list(lines())
 
-    def throws(invlaid_key: bool = True, non_optional_key: bool = False):
-        comment = ""
-        if invlaid_key:
-            comment += "\nThrows `invalid_key` exception on unknown key."
-        if non_optional_key:
-            comment += "\nThrows `non_optional_key` exception on non-optional key."
-        return comment
+    def by_id_and_key(signature: str, impl: list[str], comment: str, call: str):
+        """yield a `KeyId` function and its `K` overload forwarding to it"""
+        yield CppFunc(
+            signature.format(key="KeyId id"), impl, comment.replace(throws(), "")
+        )
+        yield CppFunc(
+            signature.format(key="std::string_view key"),
+            [f"return {call.format(key='key_id(key)')};"],
+            comment,
+        )
 
-    yield CppFunc(
-        "std::optional<V> get(const S& s, const K& key)",
-        keys_switch(lambda o: f"return s.{o.id};"),
+    yield from by_id_and_key(
+        "std::optional<V> get(const S& s, {key})",
+        (
+            [f"return {desc}.ops->get(field_of(s, id));"]
+            if table
+            else keys_switch(lambda o: f"return s.{o.id};")
+        ),
         "Get a value by key." + throws(invlaid_key=True),
+        "get(s, {key})",
     )
 
-    yield CppFunc(
-        "void set(S& s, const K& key, const V& value)",
-        keys_switch(
-            lambda o: f"s.{o.id} = std::get<{o.var.canonical_type}>(value); break;"
+    yield from by_id_and_key(
+        "void set(S& s, {key}, const V& value)",
+        (
+            [f"{desc}.ops->set(field_of(s, id), value);"]
+            if table
+            else keys_switch(
+                lambda o: (
+                    f"assign_value(s.{o.id}, value); break;"
+                    if o.var.vector_element
+                    else f"s.{o.id} = std::get<{o.var.canonical_type}>(value);"
+                    " break;"
+                )
+            )
         ),
         "Set a value by key." + throws(invlaid_key=True),
+        "set(s, {key}, value)",
     )
 
-    yield CppFunc(
-        "void unset(S& s, const K& key)",
-        keys_switch(
-            lambda o: f"s.{o.id} = std::nullopt; break;",
-            default="throw non_optional_key(key);",
-            only_optionals=True,
+    yield from by_id_and_key(
+        "void unset(S& s, {key})",
+        (
+            [
+                f"if (!{desc}.optional)",
+                "  throw non_optional_key(key_name(id));",
+                f"{desc}.ops->unset(field_of(s, id));",
+            ]
+            if table
+            else keys_switch(
+                lambda o: f"s.{o.id} = std::nullopt; break;",
+                default="throw non_optional_key(key_name(id));",
+                only_optionals=True,
+            )
         ),
         "Unset an optional value by key."
         + throws(invlaid_key=True, non_optional_key=True),
+        "unset(s, {key})",
     )
 
     yield CppFunc(
-        "Diff diff(const S& current, const S& previous)",
+        "const S& defaults()",
+        ["static const S s{};", "return s;"],
+        "The default instance, constructed once from the member initializers.",
+    )
+
+    yield from by_id_and_key(
+        "void reset(S& s, {key})",
+        (
+            [f"{desc}.ops->assign(field_of(s, id), field_of(defaults(), id));"]
+            if table
+            else keys_switch(lambda o: f"s.{o.id} = defaults().{o.id}; break;")
+        ),
+        "Reset a value to its default by key." + throws(invlaid_key=True),
+        "reset(s, {key})",
+    )
+
+    yield CppFunc(
+        "void reset_subtree(S& s, std::string_view prefix)",
         [
+            "const auto [first, last] = key_range(prefix);",
+            "for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i)",
+            "  reset(s, static_cast<KeyId>(i));",
+        ],
+        "Reset the values of a key and the keys nested under it to their defaults.",
+    )
+
+    yield CppFunc(
+        "KeySet non_default_mask(const S& s)",
+        (
+            [
+                "KeySet m;",
+                "for (size_t i = 0; i < fields.size(); ++i) {",
+                "  const auto id = static_cast<KeyId>(i);",
+                "  m[i] = !fields[i].ops->equal(field_of(s, id), field_of(defaults(), id));",
+                "}",
+                "return m;",
+            ]
+            if table
+            else [
+                "const S& d = defaults();",
+                "KeySet m;",
+                *(
+                    f"m[{i}] = s.{v.id} != d.{v.id};"
+                    for i, v in enumerate(sorted_vars)
+                ),
+                "return m;",
+            ]
+        ),
+        "Get the keys whose values differ from their defaults, without"
+        "\nbuilding a diff.",
+    )
+
+    if fingerprint:
+        yield from fingerprint_functions(sorted_vars, table)
+
+    def diff_body(edits: bool):
+        """differences as values, or as `vector_edit`s for small changes of
+        vectors if `edits`"""
+        if table:
+            value = "ops.diff" if edits else "ops.get"
+            arguments = (
+                "field_of(current, id), field_of(previous, id)"
+                if edits
+                else "field_of(current, id)"
+            )
+            return [
+                "Diff d;",
+                "for (size_t i = 0; i < fields.size(); ++i) {",
+                "  const auto id = static_cast<KeyId>(i);",
+                "  const auto& ops = *fields[i].ops;",
+                "  if (!ops.equal(field_of(current, id), field_of(previous, id)))",
+                f"    d[id] = {value}({arguments});",
+                "}",
+                "return d;",
+            ]
+        return [
             "Diff d;",
             *(
                 f"if(current.{v.id} != previous.{v.id})"
-                f" d[keys.{v.id}] = current.{v.id};"
+                + (
+                    f" d[KeyId::{v.enum}] ="
+                    f" diff_value<V>(current.{v.id}, previous.{v.id});"
+                    if edits and v.var.vector_element
+                    else f" d[KeyId::{v.enum}] = current.{v.id};"
+                )
                 for v in sorted_vars
             ),
             "return d;",
-        ],
-        "Construct a `key->variant` map of differences between two instances.",
+        ]
+
+    yield CppFunc(
+        "Diff diff(const S& current, const S& previous)",
+        diff_body(edits=False),
+        "Construct a `key->variant` map of differences between two instances."
+        "\nThe diff holds the current values, it can be applied to any instance"
+        "\nand written with `to_string`/`to_json` then parsed back.",
+    )
+
+    yield CppFunc(
+        "Diff edit_diff(const S& current, const S& previous)",
+        diff_body(edits=True),
+        "Construct a diff like `diff`, holding a `vector_edit` of `previous` for"
+        "\nvectors when it carries less than half their elements, for histories"
+        "\nand observers. Edits are positional: the diff is only valid applied to"
+        "\n`previous` (or an equal instance), and edits are written for display"
+        "\nonly, they are not parsed back.",
     )
 
     yield CppFunc(
         "void apply(S& s, const Diff& diff)",
         [
-            "for (const auto item : diff)",
-            "  if (item.second.has_value())",
-            "    set(s, item.first, item.second.value());",
+            "for (const auto& [id, value] : diff)",
+            "  if (value.has_value())",
+            "    set(s, id, value.value());",
             "  else",
-            "    unset(s, item.first);",
+            "    unset(s, id);",
         ],
         "apply a diff (`key->variant` map) to an instance."
-        + throws(invlaid_key=True, non_optional_key=True),
+        + throws(invlaid_key=False, non_optional_key=True),
+    )
+
+    if try_parsers:
+        yield CppFunc(
+            "expected<void> try_apply(S& s, const Diff& diff)",
+            [
+                *(
+                    [
+                        "for (const auto& [id, value] : diff)",
+                        "  if (const auto checked = "
+                        f"{desc}.ops->check(field_of(s, id), value, key_name(id));",
+                        "      !checked)",
+                        "    return checked;",
+                    ]
+                    if table
+                    else [
+                        "for (const auto& [id, value] : diff) {",
+                        "  expected<void> checked;",
+                        *(
+                            "  " + line
+                            for line in keys_switch(
+                                lambda o: f"checked = check_change(s.{o.id}, value,"
+                                " key_name(id)); break;",
+                                default="return unexpected(conversion_error{"
+                                "conversion_errc::invalid_key, {}, {}});",
+                            )
+                        ),
+                        "  if (!checked)",
+                        "    return checked;",
+                        "}",
+                    ]
+                ),
+                "apply(s, diff);",
+                "return {};",
+            ],
+            "Apply a diff like `apply`, returning an error without changing `s`"
+            "\nif it unsets a non-optional key (`non_optional_key`), holds a value"
+            "\nof the wrong type for its key (`wrong_type`) or an edit that does not"
+            "\nfit (`invalid_edit`).",
+        )
+
+    yield CppFunc(
+        "Diff compose(const Diff& first, const Diff& second)",
+        [
+            "Diff d;",
+            "d.reserve(first.size() + second.size());",
+            "auto a = first.begin(), b = second.begin();",
+            "while (a != first.end() || b != second.end())",
+            "  if (b == second.end() || (a != first.end() && a->first < b->first)) {",
+            "    d[a->first] = a->second;",
+            "    ++a;",
+            "  } else {",
+            *(
+                [
+                    "    if (a != first.end() && a->first == b->first)",
+                    "      d[b->first] = compose_values((a++)->second, b->second);",
+                    "    else",
+                    "      d[b->first] = b->second;",
+                ]
+                if has_edits
+                else [
+                    "    if (a != first.end() && a->first == b->first)",
+                    "      ++a;",
+                    "    d[b->first] = b->second;",
+                ]
+            ),
+            "    ++b;",
+            "  }",
+            "return d;",
+        ],
+        "Combine two diffs into one equivalent to applying `first` then `second`.",
+    )
+
+    yield CppFunc(
+        "Diff invert(const Diff& diff, const S& base)",
+        [
+            "Diff d;",
+            "d.reserve(diff.size());",
+            "for (const auto& item : diff)",
+            (
+                "  d[item.first] = invert_value(item.second, get(base, item.first));"
+                if has_edits
+                else "  d[item.first] = get(base, item.first);"
+            ),
+            "return d;",
+        ],
+        "Construct the diff that undoes applying `diff` to `base`.",
+    )
+
+    yield CppFunc(
+        "Diff restrict(const Diff& diff, std::string_view prefix)",
+        [
+            "const auto [first, last] = key_range(prefix);",
+            "Diff d;",
+            "for (auto it = std::lower_bound(diff.begin(), diff.end(), first,",
+            "       [](const auto& item, KeyId id) { return item.first < id; });",
+            "     it != diff.end() && it->first < last; ++it)",
+            "  d[it->first] = it->second;",
+            "return d;",
+        ],
+        "Extract the part of a diff about a key and the keys nested under it.",
     )
 
     typenames = ", ".join(
         f'`"{t}"`' for t in sorted(set(v.var.type for v in sorted_vars))
     )
-    yield CppFunc(
-        "std::string type(const K& key)",
-        keys_switch(
-            lambda o: f'return "{o.var.type}";',
+    yield from by_id_and_key(
+        "std::string type({key})",
+        (
+            [f"return std::string({desc}.ops->type);"]
+            if table
+            else keys_switch(lambda o: f'return "{o.var.type}";')
         ),
         "Retrieve the type name of a value by key."
         + f"\nPossible return values are: {typenames}."
         + throws(invlaid_key=True),
+        "type({key})",
     )
 
     for parser in parsers:
-        yield CppFunc(
-            f"V {parser.function_name}(const K& key, const {parser.type}& value)",
-            keys_switch(
-                lambda o: f"return {parser.user_function_for(o.var.type)}" + "(value);",
+        yield from by_id_and_key(
+            f"V {parser.function_name}({{key}}, const {parser.type}& value)",
+            (
+                [f"return {desc}.ops->{parser.function_name}(value);"]
+                if table
+                else keys_switch(
+                    lambda o: f"return {parser.user_function_for(o.var.type)}"
+                    + "(value);",
+                )
             ),
             f"Parse a value for a given key from `{parser.type}`."
             + throws(invlaid_key=True),
+            f"{parser.function_name}({{key}}, value)",
         )
 
-    for formatter in formatters:
+    for parser in try_parsers:
+        yield CppFunc(
+            f"expected<V> {parser.function_name}(KeyId id, const {parser.type}& value)",
+            (
+                [f"return {desc}.ops->{parser.function_name}(value);"]
+                if table
+                else keys_switch(
+                    lambda o: f"return {parser.user_function_for(o.var.type)}"
+                    + "(value);",
+                )
+            ),
+            f"Parse a value for a given key from `{parser.type}`, without throwing.",
+        )
         yield CppFunc(
-            f"{formatter.type} {formatter.function_name}(const K& key, const V& value)",
-            keys_switch(
-                lambda o: f"return {formatter.user_function_for(o.var.type)}"
-                + f"(std::get<{o.var.canonical_type}>(value));",
+            f"expected<V> {parser.function_name}(std::string_view key,"
+            f" const {parser.type}& value)",
+            [
+                "if (const auto id = find_key_id(key))",
+                f"  return {parser.function_name}(*id, value);",
+                "return unexpected(conversion_error{"
+                "conversion_errc::invalid_key, std::string(key), {}});",
+            ],
+            f"Parse a value for a given key from `{parser.type}`, without throwing."
+            "\nReturns an `invalid_key` error (holding a copy of `key`) on unknown"
+            "\nkey.",
+        )
+
+    for formatter in formatters:
+        yield from by_id_and_key(
+            f"{formatter.type} {formatter.function_name}({{key}}, const V& value)",
+            (
+                [f"return {desc}.ops->{formatter.function_name}(value);"]
+                if table
+                else keys_switch(
+                    lambda o: (
+                        f"if (const auto e = std::get_if<vector_edit<{o.var.vector_element}>>"
+                        f"(&value)) return {formatter.user_function_for(o.var.type)}(*e); else "
+                        if o.var.vector_element
+                        else ""
+                    )
+                    + f"return {formatter.user_function_for(o.var.type)}"
+                    + f"(std::get<{o.var.canonical_type}>(value));",
+                )
             ),
             f"Format a value for a given key to `{formatter.type}`."
             + throws(invlaid_key=True),
+            f"{formatter.function_name}({{key}}, value)",
         )
 
 
+FIELD_OPS_CODE = """\
+template <typename T> struct value_of {
+  typedef T type;
+};
+template <typename T> struct value_of<std::optional<T>> {
+  typedef T type;
+};
+
+template <typename T> std::optional<V> get_field(const void* field) {
+  return *static_cast<const T*>(field);
+}
+template <typename T> void set_field(void* field, const V& value) {
+  assign_value(*static_cast<T*>(field), value);
+}
+template <typename T> void assign_field(void* field, const void* other) {
+  *static_cast<T*>(field) = *static_cast<const T*>(other);
+}
+template <typename T> void unset_field(void* field) {
+  if constexpr (!std::is_same_v<T, typename value_of<T>::type>)
+    *static_cast<T*>(field) = std::nullopt;
+}
+template <typename T> bool equal_fields(const void* a, const void* b) {
+  return *static_cast<const T*>(a) == *static_cast<const T*>(b);
+}
+template <typename T>
+std::optional<V> diff_fields(const void* current, const void* previous) {
+  return diff_value<V>(*static_cast<const T*>(current),
+                       *static_cast<const T*>(previous));
+}"""
+
+
+def fingerprint_functions(sorted_vars: list[KeyedVar], table: bool):
+    seed = "fingerprint_seeds[static_cast<size_t>(id)]"
+
+    def tracked(change: str):
+        """`change` the field of `id`, swapping its hash in `fingerprint`"""
+        return [
+            "const uint64_t previous = field_fingerprint(s, id);",
+            change,
+            "fingerprint ^= previous ^ field_fingerprint(s, id);",
+        ]
+
+    yield CppFunc(
+        "uint64_t field_fingerprint(const S& s, KeyId id)",
+        (
+            [f"return fields[static_cast<size_t>(id)].ops->hash({seed}, field_of(s, id));"]
+            if table
+            else [
+                f"const uint64_t seed = {seed};",
+                "switch(id){",
+                *(
+                    f"  case KeyId::{v.enum}: return field_hash(seed, s.{v.id});"
+                    for v in sorted_vars
+                ),
+                '  default: throw std::out_of_range("invalid key id"); // unreachable',
+                "}",
+            ]
+        ),
+        "Hash of the value of a key, `fingerprint(s)` is the XOR of those of all"
+        "\nthe keys.",
+    )
+
+    yield CppFunc(
+        "uint64_t fingerprint(const S& s)",
+        (
+            [
+                "uint64_t h = 0;",
+                "for (size_t i = 0; i < fields.size(); ++i)",
+                "  h ^= field_fingerprint(s, static_cast<KeyId>(i));",
+                "return h;",
+            ]
+            if table
+            else [
+                "uint64_t h = 0;",
+                *(
+                    f"h ^= field_hash(fingerprint_seeds[{i}], s.{v.id});"
+                    for i, v in enumerate(sorted_vars)
+                ),
+                "return h;",
+            ]
+        ),
+        "Stable 64 bits hash of the values of an instance, for cache keys."
+        "\nValues are hashed in canonical form (see options-hash.h) and keys by"
+        "\nname, so equal instances hash the same across runs and builds.",
+    )
+
+    # without tags, the switch-mode body hashes nothing
+    tagged = table or any(v.var.tags for v in sorted_vars)
+    unused = "" if tagged else "[[maybe_unused]] "
+    yield CppFunc(
+        f"uint64_t fingerprint({unused}const S& s, {unused}Impact mask)",
+        (
+            [
+                "uint64_t h = 0;",
+                "for (size_t i = 0; i < fields.size(); ++i)",
+                "  if (key_impacts[i] & mask)",
+                "    h ^= field_fingerprint(s, static_cast<KeyId>(i));",
+                "return h;",
+            ]
+            if table
+            else [
+                "uint64_t h = 0;",
+                *(
+                    f"if (key_impacts[{i}] & mask)"
+                    f" h ^= field_hash(fingerprint_seeds[{i}], s.{v.id});"
+                    for i, v in enumerate(sorted_vars)
+                    if v.var.tags
+                ),
+                "return h;",
+            ]
+        ),
+        "Fingerprint of the values of the keys whose impact intersects `mask`,"
+        "\neg. `impact::render` to key what depends on rendering only.",
+    )
+
+    yield CppFunc(
+        "void set(S& s, KeyId id, const V& value, uint64_t& fingerprint)",
+        tracked("set(s, id, value);"),
+        "Set a value by key, updating `fingerprint` (of `s`) without rehashing"
+        "\nthe other keys.",
+    )
+
+    yield CppFunc(
+        "void unset(S& s, KeyId id, uint64_t& fingerprint)",
+        tracked("unset(s, id);"),
+        "Unset an optional value by key, updating `fingerprint` (of `s`)"
+        "\nwithout rehashing the other keys.",
+    )
+
+    yield CppFunc(
+        "void apply(S& s, const Diff& diff, uint64_t& fingerprint)",
+        [
+            "for (const auto& [id, value] : diff)",
+            "  if (value.has_value())",
+            "    set(s, id, value.value(), fingerprint);",
+            "  else",
+            "    unset(s, id, fingerprint);",
+        ],
+        "Apply a diff, updating `fingerprint` (of `s`) for the changed keys only."
+        "\nIf an unset throws, `fingerprint` matches the partially applied `s`.",
+    )
+
+    yield CppFunc(
+        "void apply(S& s, const Diff& diff, uint64_t& fingerprint, Impact mask)",
+        [
+            "for (const auto& [id, value] : diff) {",
+            "  const bool tracked = key_impact(id) & mask;",
+            "  const uint64_t previous = tracked ? field_fingerprint(s, id) : 0;",
+            "  if (value.has_value())",
+            "    set(s, id, value.value());",
+            "  else",
+            "    unset(s, id);",
+            "  if (tracked)",
+            "    fingerprint ^= previous ^ field_fingerprint(s, id);",
+            "}",
+        ],
+        "Apply a diff, updating `fingerprint` (of `s` and `mask`, see"
+        "\n`fingerprint(s, mask)`) for the changed keys only.",
+    )
+
+
+def field_table_code(
+    sorted_vars: list[KeyedVar],
+    parsers: Iterable[CustomIO],
+    formatters: Iterable[CustomIO],
+    try_parsers: Iterable[CustomIO],
+    fingerprint: bool = False,
+):
+    """descriptor table used by the functions of `cpp_functions(dispatch="table")`,
+    one `field_ops` per declared type and one `field_desc` per key"""
+    conversions = [
+        *((p, f"V (*{p.function_name})(const {p.type}&);") for p in parsers),
+        *(
+            (p, f"expected<V> (*{p.function_name})(const {p.type}&);")
+            for p in try_parsers
+        ),
+        *((f, f"{f.type} (*{f.function_name})(const V&);") for f in formatters),
+    ]
+
+    yield "namespace {"
+    yield ""
+    yield from FIELD_OPS_CODE.splitlines()
+    yield ""
+    if try_parsers:
+        yield "template <typename T>"
+        yield "expected<void> check_field(const void* field, const std::optional<V>& value,"
+        yield "                           std::string_view key) {"
+        yield "  return check_change(*static_cast<const T*>(field), value, key);"
+        yield "}"
+        yield ""
+    if fingerprint:
+        yield "template <typename T> uint64_t hash_field(uint64_t seed, const void* field) {"
+        yield "  return field_hash(seed, *static_cast<const T*>(field));"
+        yield "}"
+        yield ""
+    yield "/* operations on a field, by type */"
+    yield "struct field_ops {"
+    yield "  std::string_view type;"
+    yield "  std::optional<V> (*get)(const void*);"
+    yield "  void (*set)(void*, const V&);"
+    yield "  void (*unset)(void*);"
+    yield "  void (*assign)(void*, const void*);"
+    yield "  bool (*equal)(const void*, const void*);"
+    yield "  std::optional<V> (*diff)(const void*, const void*);"
+    if try_parsers:
+        yield "  expected<void> (*check)(const void*, const std::optional<V>&,"
+        yield "                          std::string_view);"
+    if fingerprint:
+        yield "  uint64_t (*hash)(uint64_t, const void*);"
+    for _, member in conversions:
+        yield f"  {member}"
+    yield "};"
+    yield ""
+
+    ops_names: dict[tuple[str, bool], str] = {}
+    for v in sorted_vars:
+        key = (v.var.type, v.var.is_optional)
+        if key in ops_names:
+            continue
+        name = "ops_" + ("optional_" if v.var.is_optional else "") + c_identifier(
+            v.var.type
+        )
+        ops_names[key] = name
+        declared = v.var.declared_type
+        yield f"constexpr field_ops {name} = {{"
+        yield f'  "{v.var.type}",'
+        yield f"  get_field<{declared}>,"
+        yield f"  set_field<{declared}>,"
+        yield f"  unset_field<{declared}>,"
+        yield f"  assign_field<{declared}>,"
+        yield f"  equal_fields<{declared}>,"
+        yield f"  diff_fields<{declared}>,"
+        if try_parsers:
+            yield f"  check_field<{declared}>,"
+        if fingerprint:
+            yield f"  hash_field<{declared}>,"
+        for io in parsers:
+            yield f"  [](const {io.type}& v) -> V {{"
+            yield f"    return {io.user_function_for(v.var.type)}(v);"
+            yield "  },"
+        for io in try_parsers:
+            yield f"  [](const {io.type}& v) -> expected<V> {{"
+            yield f"    return {io.user_function_for(v.var.type)}(v);"
+            yield "  },"
+        for io in formatters:
+            yield f"  [](const V& v) -> {io.type} {{"
+            if element := v.var.vector_element:
+                yield f"    if (const auto e = std::get_if<vector_edit<{element}>>(&v))"
+                yield f"      return {io.user_function_for(v.var.type)}(*e);"
+            yield f"    return {io.user_function_for(v.var.type)}("
+            yield f"        std::get<{v.var.canonical_type}>(v));"
+            yield "  },"
+        yield "};"
+    yield ""
+
+    yield "struct field_desc {"
+    yield "  void* (*field)(S&);"
+    yield "  bool optional;"
+    yield "  const field_ops* ops;"
+    yield "};"
+    yield ""
+    yield f"constexpr std::array<field_desc, {len(sorted_vars)}> fields = {{{{"
+    for v in sorted_vars:
+        optional = "true" if v.var.is_optional else "false"
+        ops = ops_names[(v.var.type, v.var.is_optional)]
+        yield f"  {{[](S& s) -> void* {{ return &s.{v.id}; }}, {optional}, &{ops}}}, // {json.dumps(v.key)}"
+    yield "}};"
+    yield ""
+    yield "void* field_of(S& s, KeyId id) {"
+    yield "  return fields[static_cast<size_t>(id)].field(s);"
+    yield "}"
+    yield "/* the accessors only take the address, constness is restored on return */"
+    yield "const void* field_of(const S& s, KeyId id) {"
+    yield "  return fields[static_cast<size_t>(id)].field(const_cast<S&>(s));"
+    yield "}"
+    yield ""
+    yield "} // namespace"
+
+
 @dataclass
 class CustomIO:
     type: str
@@ -356,6 +1198,12 @@ class CustomIO:
     user_function_pattern: str
 
     def user_function_for(self, type: str):
+        """`type` substituted in the pattern, class templates as the template
+        name with the arguments after the function name, eg.
+        `std::vector<double>` as `parse_std_vector<double>`"""
+        if m := re.fullmatch(r"([\w:]+)\s*<(.*)>", type):
+            name = self.user_function_pattern.replace("%", c_identifier(m[1]))
+            return f"{name}<{m[2]}>"
         return self.user_function_pattern.replace("%", c_identifier(type))
 
     @classmethod
@@ -372,6 +1220,10 @@ class KeyedVar:
     def id(self):
         return self.var.identifier
 
+    @property
+    def enum(self):
+        return c_identifier(self.var.identifier)
+
 
 @dataclass(frozen=True)
 class Var:
@@ -382,6 +1234,60 @@ class Var:
     has_default: bool
     comment: str
 
+    @property
+    def tags(self):
+        lines = [self.comment] if isinstance(self.comment, str) else self.comment
+        return sorted(
+            set(
+                tag
+                for line in lines
+                for tag in re.findall(r"(?<!\w)@(\w+)(?![\w(])", line)
+            )
+        )
+
+    @property
+    def cli_names(self):
+        """names of the `@cli(names...)` tag, if any"""
+        lines = [self.comment] if isinstance(self.comment, str) else self.comment
+        for line in lines:
+            if m := re.search(r"(?<!\w)@cli\(([^)]*)\)", line):
+                return [n.strip() for n in m.group(1).split(",") if n.strip()]
+        return None
+
+    @property
+    def brief(self):
+        """first sentence of the comment, without markup"""
+        lines = [self.comment] if isinstance(self.comment, str) else self.comment
+        words: list[str] = []
+        for line in lines:
+            line = re.sub(r"^\s*(/\*\*|\*/|\*)?", "", line).replace("*/", "")
+            if line.lstrip().startswith("@") or (words and not line.strip()):
+                break
+            words += line.split()
+        text = re.split(r"(?<=\.)\s", " ".join(words))[0].rstrip(".")
+        return re.sub(r"[*`]", "", text)
+
+    @property
+    def vector_element(self):
+        """canonical element type of `std::vector` values, which diffs can
+        carry as `vector_edit`s"""
+        m = re.fullmatch(r"std::vector<(.*)>", self.canonical_type)
+        return m[1] if m else None
+
+    @property
+    def doc(self):
+        """comment text, without markers"""
+        lines = [self.comment] if isinstance(self.comment, str) else self.comment
+        lines = [
+            re.sub(r"^\s*(/\*\*|\*/|\*)?\s?", "", line).replace("*/", "").rstrip()
+            for line in lines
+        ]
+        return "\n".join(lines).strip()
+
+    @property
+    def declared_type(self):
+        return f"std::optional<{self.type}>" if self.is_optional else self.type
+
 
 @dataclass(frozen=True)
 class CppFunc:
@@ -389,6 +1295,13 @@ class CppFunc:
     impl: list[str]
     comment: str = ""
 
+    @property
+    def declaration(self):
+        if self.comment:
+            yield f"/** {self.comment} */"
+        yield f"{self.signature};"
+        yield ""
+
     @property
     def body(self):
         return "\n".join(f"  {line}" for line in self.impl)
@@ -398,6 +1311,488 @@ def c_identifier(s: str):
     return re.sub(r"\W+|^(?=\d)", "_", s)
 
 
+def impact_code(sorted_vars: list[KeyedVar]):
+    tags = sorted(set(tag for v in sorted_vars for tag in v.var.tags))
+
+    def mask(v: KeyedVar):
+        return " | ".join(f"impact::{tag}" for tag in v.var.tags) or "impact::none"
+
+    yield "/** Impact of changing a value, from the `@tags` of the fields"
+    yield "documentation. */"
+    yield "typedef uint32_t Impact;"
+    yield "namespace impact {"
+    yield "constexpr Impact none = 0;"
+    for i, tag in enumerate(tags):
+        yield f"constexpr Impact {tag} = 1 << {i};"
+    yield "} // namespace impact"
+    yield ""
+    yield f"constexpr std::array<Impact, {len(sorted_vars)}> key_impacts = {{"
+    for v in sorted_vars:
+        yield f"  {mask(v)}, // {json.dumps(v.key)}"
+    yield "};"
+    yield ""
+    yield "/** Get the impact of changing the value of a key. */"
+    yield "constexpr Impact key_impact(KeyId id) {"
+    yield "  return key_impacts[static_cast<size_t>(id)];"
+    yield "}"
+    yield ""
+
+
+def field_traits_code(sorted_vars: list[KeyedVar]):
+    yield "/** Compile-time access to the field of a key. */"
+    yield "template <KeyId id> struct field;"
+    yield ""
+    for v in sorted_vars:
+        yield f"template <> struct field<KeyId::{v.enum}> {{"
+        yield f"  typedef {v.var.declared_type} type;"
+        yield f"  static constexpr type& get(S& s) noexcept {{ return s.{v.id}; }}"
+        yield "  static constexpr const type& get(const S& s) noexcept {"
+        yield f"    return s.{v.id};"
+        yield "  }"
+        yield "};"
+    yield ""
+
+    yield "/** Get a reference to a field by compile-time key. */"
+    yield "template <KeyId id>"
+    yield "constexpr typename field<id>::type& get(S& s) noexcept {"
+    yield "  return field<id>::get(s);"
+    yield "}"
+    yield "template <KeyId id>"
+    yield "constexpr const typename field<id>::type& get(const S& s) noexcept {"
+    yield "  return field<id>::get(s);"
+    yield "}"
+    yield ""
+
+
+FOR_EACH_FIELD_CODE = """\
+/** Call `f(key, value)` for each field, in key order, with `key` a
+`key_constant` (its `value` being the `KeyId`, usable as a template argument
+or to index `field_infos` at compile-time) and `value` a reference to the
+field. The calls are expanded at compile-time. */
+template <typename F> constexpr void for_each_field(S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+template <typename F> constexpr void for_each_field(const S& s, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(s)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+
+/** Call `f(key, a_value, b_value)` for each field of two instances. */
+template <typename F>
+constexpr void for_each_field(const S& a, const S& b, F&& f) {
+  [&]<size_t... i>(std::index_sequence<i...>) {
+    (f(key_constant<static_cast<KeyId>(i)>{}, get<static_cast<KeyId>(i)>(a),
+       get<static_cast<KeyId>(i)>(b)),
+     ...);
+  }(std::make_index_sequence<field_infos.size()>{});
+}
+"""
+
+
+def field_metadata_code(sorted_vars: list[KeyedVar]):
+    yield "/** Description of a field, from the parsed struct. */"
+    yield "struct field_info {"
+    yield "  KeyId id;"
+    yield "  std::string_view key;"
+    yield "  std::string_view type;"
+    yield "  std::string_view canonical_type;"
+    yield "  bool is_optional;"
+    yield "  bool has_default;"
+    yield "  Impact impact;"
+    yield "  std::string_view doc; // comment, without markers"
+    yield "};"
+    yield ""
+    yield "/** Descriptions of the fields, in key order (indexed by `KeyId`). */"
+    yield f"inline constexpr std::array<field_info, {len(sorted_vars)}> field_infos = {{{{"
+    for v in sorted_vars:
+        yield "  {"
+        yield f"    KeyId::{v.enum},"
+        yield f"    {json.dumps(v.key)},"
+        yield f"    {json.dumps(v.var.type)},"
+        yield f"    {json.dumps(v.var.canonical_type)},"
+        yield f"    {'true' if v.var.is_optional else 'false'},"
+        yield f"    {'true' if v.var.has_default else 'false'},"
+        yield f"    key_impacts[static_cast<size_t>(KeyId::{v.enum})],"
+        yield f"    {json.dumps(v.var.doc)},"
+        yield "  },"
+    yield "}};"
+    yield ""
+    yield "template <KeyId id> using key_constant = std::integral_constant<KeyId, id>;"
+    yield ""
+    yield from FOR_EACH_FIELD_CODE.splitlines()
+
+
+@dataclass(frozen=True)
+class CliFlag:
+    var: KeyedVar
+    name: str
+    short_name: str
+    group: str
+
+
+def cli_flags(sorted_vars: list[KeyedVar], key_sep: str):
+    flags: list[CliFlag] = []
+    for v in sorted_vars:
+        names = v.var.cli_names
+        if names is None:
+            continue
+        long_names = [n for n in names if len(n) > 1]
+        short_names = [n for n in names if len(n) == 1]
+        if len(long_names) != 1 or len(short_names) > 1:
+            raise ValueError(f"{v.key}: expected @cli([c,]long-name), got {names}")
+        group = v.key.split(key_sep)[0]
+        flags.append(CliFlag(v, long_names[0], "".join(short_names), group))
+    for attr in ("name", "short_name"):
+        names = [getattr(f, attr) for f in flags if getattr(f, attr)]
+        if len(set(names)) != len(names):
+            raise ValueError(f"duplicate @cli names: {sorted(names)}")
+    return flags
+
+
+def cli_flags_code(flags: list[CliFlag]):
+    def char(c: str):
+        return f"'{c}'" if c else "0"
+
+    yield "/** Command line flag of a key, from the `@cli([c,]name)` tags of the"
+    yield "fields documentation. */"
+    yield "struct cli_flag {"
+    yield "  std::string_view name; // used as `--name`"
+    yield "  char short_name; // used as `-c`, 0 if none"
+    yield "  bool is_switch; // bool value, `true` if not given"
+    yield "  KeyId id;"
+    yield "  std::string_view group;"
+    yield "  std::string_view metavar;"
+    yield "  std::string_view help;"
+    yield "};"
+    yield ""
+    yield f"inline constexpr std::array<cli_flag, {len(flags)}> cli_flags = {{{{"
+    for f in flags:
+        yield (
+            f"  {{{json.dumps(f.name)}, {char(f.short_name)},"
+            f" {str(f.var.var.type == 'bool').lower()}, KeyId::{f.var.enum},"
+            f" {json.dumps(f.group)}, {json.dumps(f.var.var.type)},"
+            f" {json.dumps(f.var.var.brief)}}},"
+        )
+    yield "}};"
+    yield ""
+    yield "/** Result of parsing command line arguments. */"
+    yield "struct cli_args {"
+    yield "  Diff diff;"
+    yield "  std::vector<std::string_view> unmatched; // positional and unknown"
+    yield "  bool help = false; // `-h` or `--help` was given"
+    yield "};"
+    yield ""
+
+
+def cli_functions(flags: list[CliFlag], parser: CustomIO, formatter: CustomIO):
+    yield CppFunc(
+        "const cli_flag* find_cli_flag(std::string_view name) noexcept",
+        [
+            "const size_t n = cli_flags.size();",
+            "const int32_t seed = cli_hash_seeds[key_hash(0, name) % n];",
+            "const size_t slot = seed < 0 ? -seed - 1 : key_hash(seed, name) % n;",
+            "const cli_flag& flag = cli_flags[cli_hash_slots[slot]];",
+            "return flag.name == name ? &flag : nullptr;",
+        ],
+        "Find a flag by name (without `--`).",
+    )
+
+    yield CppFunc(
+        "const cli_flag* find_cli_flag(char short_name) noexcept",
+        [
+            "for (const auto& flag : cli_flags)",
+            "  if (flag.short_name == short_name)",
+            "    return &flag;",
+            "return nullptr;",
+        ],
+        "Find a flag by short name.",
+    )
+
+    yield CppFunc(
+        "cli_args parse_cli(int argc, const char* const* argv, const S& defaults,"
+        ' std::string_view unset, std::string_view reset)',
+        CLI_PARSE_CODE.format(parse=parser.function_name).splitlines(),
+        "Parse command line arguments into a diff, `argv[0]` being the program"
+        "\nname."
+        "\nValues are given as `--name=value`, `--name value`, `-c value`,"
+        " `-cvalue`,\n`-c=value`, switches may be grouped (`-abc`)."
+        " `unset` and `reset` values\nunset a key or set it to its value in"
+        " `defaults`.\nThrows `std::invalid_argument` on missing values, and"
+        f" the exceptions of\n`{parser.function_name}()` on invalid ones.",
+    )
+
+    yield CppFunc(
+        "std::string cli_help(const S& defaults)",
+        CLI_HELP_CODE.format(format=formatter.function_name).splitlines(),
+        "Help text of the flags, with their values in `defaults`.",
+    )
+
+
+CLI_PARSE_CODE = """\
+cli_args args;
+const auto set_value = [&](const cli_flag& flag, std::string_view value) {{
+  if (value == unset)
+    args.diff[flag.id] = std::nullopt;
+  else if (value == reset)
+    args.diff[flag.id] = get(defaults, flag.id);
+  else
+    args.diff[flag.id] = {parse}(flag.id, std::string(value));
+}};
+const auto missing_value = [](std::string_view arg) {{
+  return std::invalid_argument("missing value for " + std::string(arg));
+}};
+bool options_ended = false;
+for (int i = 1; i < argc; ++i) {{
+  const std::string_view arg = argv[i];
+  if (options_ended || arg.size() < 2 || arg[0] != '-') {{
+    args.unmatched.push_back(arg);
+  }} else if (arg == "--") {{
+    options_ended = true;
+  }} else if (arg[1] == '-') {{
+    const size_t eq = arg.find('=');
+    const std::string_view name = arg.substr(2, eq - 2);
+    const cli_flag* flag = find_cli_flag(name);
+    if (name == "help")
+      args.help = true;
+    else if (!flag)
+      args.unmatched.push_back(arg);
+    else if (eq != arg.npos)
+      set_value(*flag, arg.substr(eq + 1));
+    else if (flag->is_switch)
+      set_value(*flag, "true");
+    else if (i + 1 < argc)
+      set_value(*flag, argv[++i]);
+    else
+      throw missing_value(arg);
+  }} else {{
+    for (size_t j = 1; j < arg.size(); ++j) {{
+      const cli_flag* flag = find_cli_flag(arg[j]);
+      const std::string_view rest = arg.substr(j + 1);
+      if (arg[j] == 'h') {{
+        args.help = true;
+        continue;
+      }} else if (!flag) {{
+        args.unmatched.push_back(arg);
+      }} else if (rest.starts_with('=')) {{
+        set_value(*flag, rest.substr(1));
+      }} else if (flag->is_switch) {{
+        set_value(*flag, "true");
+        continue;
+      }} else if (!rest.empty()) {{
+        set_value(*flag, rest);
+      }} else if (i + 1 < argc) {{
+        set_value(*flag, argv[++i]);
+      }} else {{
+        throw missing_value(arg);
+      }}
+      break;
+    }}
+  }}
+}}
+return args;"""
+
+
+CLI_HELP_CODE = """\
+const auto names = [](const cli_flag& flag) {{
+  std::string s = flag.short_name ? std::string{{'-', flag.short_name}} + ", "
+                                  : std::string("    ");
+  s.append("--").append(flag.name);
+  if (!flag.is_switch)
+    s.append("=").append(flag.metavar);
+  return s;
+}};
+size_t width = std::string_view("-h, --help").size();
+for (const auto& flag : cli_flags)
+  width = std::max(width, names(flag).size());
+const auto row = [&](const std::string& names, std::string_view help) {{
+  return "  " + names + std::string(width + 2 - names.size(), ' ') +
+         std::string(help);
+}};
+std::string help = row("-h, --help", "Print usage") + "\\n";
+std::string_view group;
+for (const auto& flag : cli_flags) {{
+  if (flag.group != group) {{
+    group = flag.group;
+    help.append("\\n ").append(group).append(" options:\\n");
+  }}
+  help += row(names(flag), flag.help);
+  if (const auto value = get(defaults, flag.id))
+    help.append(" (default: ").append({format}(flag.id, *value)).append(")");
+  help += "\\n";
+}}
+return help;"""
+
+
+DIFF_CLASS_CODE = """\
+/** Map of changes from keys to values, an empty value meaning unset.
+Entries are kept sorted by `KeyId` in a single contiguous array. */
+class Diff {
+public:
+  typedef KeyId key_type;
+  typedef std::optional<V> mapped_type;
+  typedef std::pair<KeyId, std::optional<V>> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  /** Insert an empty value for `id` if there is none. */
+  std::pair<iterator, bool> try_emplace(KeyId id) {
+    if (items.empty() || items.back().first < id)
+      return {items.insert(items.end(), {id, std::nullopt}), true};
+    const auto it = lower_bound(id);
+    if (it != items.end() && it->first == id)
+      return {it, false};
+    return {items.insert(it, {id, std::nullopt}), true};
+  }
+  std::pair<iterator, bool> try_emplace(std::string_view key) {
+    return try_emplace(key_id(key));
+  }
+
+  std::optional<V>& operator[](KeyId id) { return try_emplace(id).first->second; }
+  std::optional<V>& operator[](std::string_view key) {
+    return (*this)[key_id(key)];
+  }
+
+  const std::optional<V>& at(KeyId id) const {
+    const auto it = find(id);
+    if (it == items.end())
+      throw std::out_of_range("key not in diff: " + std::string(key_name(id)));
+    return it->second;
+  }
+  const std::optional<V>& at(std::string_view key) const {
+    return at(key_id(key));
+  }
+
+  iterator find(KeyId id) {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(KeyId id) const {
+    const auto it = lower_bound(id);
+    return it != items.end() && it->first == id ? it : items.end();
+  }
+  const_iterator find(std::string_view key) const {
+    const auto id = find_key_id(key);
+    return id ? find(*id) : items.end();
+  }
+
+  /** Identifier of a key, if it is one. */
+  static std::optional<KeyId> key(std::string_view key) noexcept {
+    return find_key_id(key);
+  }
+
+  size_t count(KeyId id) const { return find(id) != items.end(); }
+  size_t count(std::string_view key) const { return find(key) != items.end(); }
+
+  size_t erase(KeyId id) {
+    const auto it = find(id);
+    if (it == items.end())
+      return 0;
+    items.erase(it);
+    return 1;
+  }
+
+  iterator begin() { return items.begin(); }
+  iterator end() { return items.end(); }
+  const_iterator begin() const { return items.begin(); }
+  const_iterator end() const { return items.end(); }
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+  void clear() { items.clear(); }
+  void reserve(size_t n) { items.reserve(n); }
+
+  /** Combined impact of the changed keys. */
+  Impact impact() const {
+    Impact mask = 0;
+    for (const auto& item : items)
+      mask |= key_impact(item.first);
+    return mask;
+  }
+
+  bool operator==(const Diff& other) const = default;
+
+private:
+  std::vector<value_type> items;
+
+  iterator lower_bound(KeyId id) {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+  const_iterator lower_bound(KeyId id) const {
+    return std::lower_bound(items.begin(), items.end(), id,
+      [](const value_type& item, KeyId id) { return item.first < id; });
+  }
+};
+"""
+
+
+def tracked_class_code(namespace: str, count: int):
+    ns = f"::{namespace}" if namespace else ""
+    return f"""\
+/** An instance that records which fields are modified through it, so the
+changes can be retrieved in time proportional to their number. */
+class Tracked {{
+public:
+  Tracked() = default;
+  explicit Tracked(const S& s) : s(s) {{}}
+
+  const S& value() const {{ return s; }}
+
+  void set(KeyId id, const V& value) {{
+    {ns}::set(s, id, value);
+    mark(id);
+  }}
+  void set(std::string_view key, const V& value) {{ set(key_id(key), value); }}
+
+  void unset(KeyId id) {{
+    {ns}::unset(s, id);
+    mark(id);
+  }}
+  void unset(std::string_view key) {{ unset(key_id(key)); }}
+
+  void apply(const Diff& diff) {{
+    for (const auto& [id, value] : diff)
+      if (value.has_value())
+        set(id, value.value());
+      else
+        unset(id);
+  }}
+
+  bool changed(KeyId id) const {{
+    const size_t i = static_cast<size_t>(id);
+    return dirty[i / 64] & (uint64_t(1) << (i % 64));
+  }}
+
+  /** Retrieve the current values of the fields modified since the last call
+  and reset the tracking. */
+  Diff take_changes() {{
+    Diff changes;
+    for (size_t w = 0; w < dirty.size(); ++w)
+      for (uint64_t bits = std::exchange(dirty[w], 0); bits; bits &= bits - 1) {{
+        const auto id = static_cast<KeyId>(w * 64 + std::countr_zero(bits));
+        changes[id] = {ns}::get(s, id);
+      }}
+    return changes;
+  }}
+
+  void clear_changes() {{ dirty.fill(0); }}
+
+private:
+  S s;
+  std::array<uint64_t, {(count + 63) // 64}> dirty = {{}};
+
+  void mark(KeyId id) {{
+    const size_t i = static_cast<size_t>(id);
+    dirty[i / 64] |= uint64_t(1) << (i % 64);
+  }}
+}};
+"""
+
+
 def keys_struct_code(keyed_vars: Iterable[KeyedVar], var_name: str):
     root: dict[str, Any] = {}
     for v in keyed_vars:
@@ -412,9 +1807,14 @@ def keys_struct_code(keyed_vars: Iterable[KeyedVar], var_name: str):
     ) -> Iterator[str]:
         indent = "  " * depth
         if isinstance(node, KeyedVar):
-            yield indent + f'const K {name} = "{node.key}";'
+            yield indent + f'std::string_view {name} = "{node.key}";'
+        elif depth == 0:
+            yield f"inline constexpr struct {name} {{"
+            for k, v in node.items():
+                yield from generate_keys_struct(v, k, depth + 1)
+            yield f"}} {name} = {{}};"
         else:
-            yield indent + f"const struct {name} {{"
+            yield indent + f"struct {name} {{"
             for k, v in node.items():
                 yield from generate_keys_struct(v, k, depth + 1)
             yield indent + f"}} {name};"
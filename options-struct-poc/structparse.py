@@ -160,7 +160,10 @@ def walk_struct(cursor: Cursor) -> StructNode:
             return ""
 
     def f(c: Cursor) -> StructNode | StructLeaf:
-        if c.type.get_declaration().kind == CursorKind.STRUCT_DECL:
+        if (
+            c.type.get_declaration().kind == CursorKind.STRUCT_DECL
+            and c.type.get_num_template_arguments() < 0
+        ):  # class template instances (eg. `std::pair`) are values
             return StructNode(
                 c.spelling,
                 members=tuple(
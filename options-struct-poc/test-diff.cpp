@@ -0,0 +1,201 @@
+#include <random>
+#include <string>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+#include "options-json.h"
+#include "test-helpers.h"
+
+/* `edit_diff(b, a)` then `edit_diff(c, b)` of random instances */
+class ComposeInvert : public ::testing::TestWithParam<unsigned> {};
+
+TEST_P(ComposeInvert, ComposeMatchesSequentialApply) {
+  std::mt19937 rng(GetParam());
+  const Options a = random_change(filled_options(), rng);
+  const Options b = random_change(a, rng);
+  const Options c = random_change(b, rng);
+  const auto d1 = OptionsIO::edit_diff(b, a);
+  const auto d2 = OptionsIO::edit_diff(c, b);
+
+  Options sequential = a;
+  OptionsIO::apply(sequential, d1);
+  OptionsIO::apply(sequential, d2);
+  EXPECT_TRUE(same_options(sequential, c));
+
+  Options composed = a;
+  OptionsIO::apply(composed, OptionsIO::compose(d1, d2));
+  EXPECT_TRUE(same_options(composed, sequential));
+}
+
+TEST_P(ComposeInvert, InvertRestoresBase) {
+  std::mt19937 rng(GetParam());
+  const Options base = random_change(filled_options(), rng);
+  const auto d = OptionsIO::edit_diff(random_change(base, rng), base);
+
+  Options s = base;
+  OptionsIO::apply(s, d);
+  OptionsIO::apply(s, OptionsIO::invert(d, base));
+  EXPECT_TRUE(same_options(s, base));
+}
+
+TEST_P(ComposeInvert, InvertComposedRestoresBase) {
+  std::mt19937 rng(GetParam());
+  const Options a = random_change(filled_options(), rng);
+  const Options b = random_change(a, rng);
+  const auto d = OptionsIO::compose(
+      OptionsIO::edit_diff(b, a),
+      OptionsIO::edit_diff(random_change(b, rng), b));
+
+  Options s = a;
+  OptionsIO::apply(s, d);
+  OptionsIO::apply(s, OptionsIO::invert(d, a));
+  EXPECT_TRUE(same_options(s, a));
+}
+
+INSTANTIATE_TEST_SUITE_P(Random, ComposeInvert, ::testing::Range(0u, 200u));
+
+/* both diffs hold a `vector_edit` for the same key */
+TEST(ComposeInvert, VectorEditsOfSameKey) {
+  const auto id = OptionsIO::key_id(OptionsIO::keys.model.volume.opacity_map);
+  const Options a = base_options();
+  Options b = a, c;
+  b.model.volume.opacity_map[0] = 0.25;
+  c = b;
+  c.model.volume.opacity_map[50] = 0.9;
+  c.model.volume.opacity_map.insert(c.model.volume.opacity_map.begin() + 52,
+                                    0.75);
+
+  const auto d1 = OptionsIO::edit_diff(b, a), d2 = OptionsIO::edit_diff(c, b);
+  ASSERT_TRUE(
+      std::holds_alternative<options_ns::vector_edit<double>>(*d1.at(id)));
+  ASSERT_TRUE(
+      std::holds_alternative<options_ns::vector_edit<double>>(*d2.at(id)));
+
+  const auto d = OptionsIO::compose(d1, d2);
+  EXPECT_TRUE(
+      std::holds_alternative<options_ns::vector_edit<double>>(*d.at(id)));
+
+  Options s = a;
+  OptionsIO::apply(s, d);
+  EXPECT_EQ(s.model.volume.opacity_map, c.model.volume.opacity_map);
+
+  OptionsIO::apply(s, OptionsIO::invert(d, a));
+  EXPECT_EQ(s.model.volume.opacity_map, a.model.volume.opacity_map);
+}
+
+TEST(TryApply, RejectsWithoutChanging) {
+  const Options original = base_options();
+  const auto check = [&](const OptionsDiff &d,
+                          options_ns::conversion_errc code) {
+    Options s = original;
+    const auto result = OptionsIO::try_apply(s, d);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, code);
+    EXPECT_TRUE(same_options(s, original));
+  };
+  const auto angle = OptionsIO::key_id(OptionsIO::keys.camera.view_angle);
+  const auto map = OptionsIO::key_id(OptionsIO::keys.model.volume.opacity_map);
+  const auto position = OptionsIO::key_id(OptionsIO::keys.camera.position);
+
+  OptionsDiff d;
+  d[position] = Point3{1, 2, 3}; // valid, applied last
+  d[angle] = std::string("x");
+  check(d, options_ns::conversion_errc::wrong_type);
+
+  d = {};
+  d[position] = Point3{1, 2, 3};
+  d[map] = options_ns::vector_edit<double>{{{60, 10, {1.}}}};
+  check(d, options_ns::conversion_errc::invalid_edit);
+
+  d[map] = 1.;
+  check(d, options_ns::conversion_errc::wrong_type);
+
+  d = {};
+  d[angle] = std::nullopt;
+  check(d, options_ns::conversion_errc::non_optional_key);
+}
+
+TEST(TryApply, AppliesValidDiffs) {
+  std::mt19937 rng(0);
+  for (int i = 0; i < 100; ++i) {
+    const Options a = random_change(filled_options(), rng);
+    const Options b = random_change(a, rng);
+    Options s = a;
+    ASSERT_TRUE(OptionsIO::try_apply(s, OptionsIO::diff(b, a)));
+    EXPECT_TRUE(same_options(s, b));
+    s = a;
+    ASSERT_TRUE(OptionsIO::try_apply(s, OptionsIO::edit_diff(b, a)));
+    EXPECT_TRUE(same_options(s, b));
+  }
+}
+
+/* `diff()` holds values: applied to any instance, it sets the keys to their
+  values in `b`, also after a round trip through strings or JSON */
+class ValueDiff : public ::testing::TestWithParam<unsigned> {
+protected:
+  void SetUp() override {
+    std::mt19937 rng(GetParam());
+    a = random_change(filled_options(), rng);
+    b = random_change(a, rng);
+    other = random_change(filled_options(), rng);
+    other.model.volume.opacity_map.resize(3);
+    d = OptionsIO::diff(b, a);
+
+    expected = other;
+    for (const auto &[id, value] : d)
+      if (value)
+        OptionsIO::set(expected, id, *OptionsIO::get(b, id));
+      else
+        OptionsIO::unset(expected, id);
+  }
+
+  Options a, b, other, expected;
+  OptionsDiff d;
+};
+
+TEST_P(ValueDiff, AppliesToOtherInstances) {
+  for (const auto &[id, value] : d)
+    if (value)
+      EXPECT_FALSE(
+          std::holds_alternative<options_ns::vector_edit<double>>(*value));
+  Options s = other;
+  OptionsIO::apply(s, d);
+  EXPECT_TRUE(same_options(s, expected));
+}
+
+TEST_P(ValueDiff, RoundTripsThroughStrings) {
+  OptionsDiff parsed;
+  for (const auto &[id, value] : d)
+    if (value)
+      parsed[id] =
+          OptionsIO::from_string(id, OptionsIO::to_string(id, *value));
+    else
+      parsed[id] = std::nullopt;
+  Options s = other;
+  OptionsIO::apply(s, parsed);
+  EXPECT_TRUE(same_options(s, expected));
+}
+
+TEST_P(ValueDiff, RoundTripsThroughJson) {
+  std::string json;
+  options_ns::write_json(json, d);
+  Options s = other;
+  OptionsIO::apply(s, options_ns::json_to_diff<OptionsDiff>(json));
+  EXPECT_TRUE(same_options(s, expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(Random, ValueDiff, ::testing::Range(0u, 50u));
+
+/* a change of one element of a large vector */
+TEST(ValueDiff, VectorChangeIsValue) {
+  const auto id = OptionsIO::key_id(OptionsIO::keys.model.volume.opacity_map);
+  const Options a = base_options();
+  Options b = a;
+  b.model.volume.opacity_map[10] = 0.25;
+
+  EXPECT_TRUE(std::holds_alternative<std::vector<double>>(
+      *OptionsIO::diff(b, a).at(id)));
+  EXPECT_TRUE(std::holds_alternative<options_ns::vector_edit<double>>(
+      *OptionsIO::edit_diff(b, a).at(id)));
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "options-containers.h"
+#include "options-io.h"
+#include "options-structio.h" // generated
+#include "options.h"
+
+typedef struct options_ns::f3d_options Options;
+typedef options_ns::f3d_options_io::Diff OptionsDiff;
+namespace OptionsIO = options_ns::f3d_options_io;
+
+/* instances compare through their diff, the struct has no `operator==` */
+inline bool same_options(const Options &a, const Options &b) {
+  return OptionsIO::diff(a, b).empty();
+}
+
+/* defaults with a vector long enough for its diffs to be `vector_edit`s */
+inline Options base_options() {
+  Options s;
+  s.model.volume.opacity_map.assign(64, 0.5);
+  return s;
+}
+
+/* random value of the type of `value` */
+inline OptionsIO::V random_value(const OptionsIO::V &value, std::mt19937 &rng) {
+  const auto n = [&](int m) { return static_cast<int>(rng() % m); };
+  return std::visit(
+      [&](const auto &x) -> OptionsIO::V {
+        typedef std::decay_t<decltype(x)> T;
+        if constexpr (std::is_same_v<T, bool>)
+          return !x;
+        else if constexpr (std::is_same_v<T, int>)
+          return n(10);
+        else if constexpr (std::is_same_v<T, double>)
+          return n(10) / 4.;
+        else if constexpr (std::is_same_v<T, std::string>)
+          return "s" + std::to_string(n(10));
+        else if constexpr (std::is_same_v<T, std::array<double, 3>>)
+          return T{n(4) / 2., n(4) / 2., n(4) / 2.};
+        else if constexpr (std::is_same_v<T, Colormap>)
+          return options_ns::parse_Colormap(
+              n(2) ? "viridis" : "inferno");
+        else if constexpr (std::is_same_v<T, std::pair<double, double>>)
+          return T{n(4), n(4) + 4.};
+        else if constexpr (std::is_same_v<T,
+                                          std::map<std::string, std::string>>) {
+          T m = x;
+          m["k" + std::to_string(n(4))] = "v" + std::to_string(n(4));
+          return m;
+        } else if constexpr (std::is_same_v<T, std::vector<double>>) {
+          /* a few element changes, insertions or erasures */
+          T v = x;
+          for (int i = n(3) + 1; i > 0; --i) {
+            const auto at = v.begin() + n(static_cast<int>(v.size()) + 1);
+            switch (n(v.empty() ? 2 : 3)) {
+            case 0:
+              v.insert(at, n(4) / 4.);
+              break;
+            case 1:
+              v.insert(at, {0.125, 0.375});
+              break;
+            default:
+              if (at != v.end())
+                *at = n(4) / 4. + 1;
+            }
+          }
+          return v;
+        } else {
+          static_assert(options_ns::is_vector_edit<T>::value);
+          return x; // not held by instances
+        }
+      },
+      value);
+}
+
+/* `base_options()` with every optional set */
+inline const Options &filled_options() {
+  static const Options filled = [] {
+    const std::map<std::string_view, std::string> samples = {
+        {"double", "1"},
+        {"Point3", "0,1,2"},
+        {"Vector3", "0,1,2"},
+        {"std::pair<double, double>", "0,1"},
+        {"std::string", "s"},
+    };
+    Options filled = base_options();
+    for (const auto &info : OptionsIO::field_infos)
+      if (!OptionsIO::get(filled, info.id))
+        OptionsIO::set(filled, info.id,
+                       OptionsIO::from_string(info.id, samples.at(info.type)));
+    return filled;
+  }();
+  return filled;
+}
+
+/* `s` with a few random keys changed or unset */
+inline Options random_change(const Options &s, std::mt19937 &rng) {
+  /* one key in two is the vector, to compose and invert its edits */
+  const auto vector_id =
+      OptionsIO::key_id(OptionsIO::keys.model.volume.opacity_map);
+
+  Options t = s;
+  for (int n = rng() % 4 + 1; n > 0; --n) {
+    const size_t i_key = rng() % 2 ? static_cast<size_t>(vector_id)
+                                   : rng() % OptionsIO::field_infos.size();
+    const auto &info = OptionsIO::field_infos[i_key];
+    if (info.is_optional && rng() % 2)
+      OptionsIO::unset(t, info.id);
+    else
+      OptionsIO::set(t, info.id,
+                     random_value(OptionsIO::get(t, info.id)
+                                      .value_or(*OptionsIO::get(
+                                          filled_options(), info.id)),
+                                  rng));
+  }
+  return t;
+}
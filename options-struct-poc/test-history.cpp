@@ -0,0 +1,72 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "options-history.h"
+#include "test-helpers.h"
+
+typedef options_ns::diff_history<Options, OptionsDiff> History;
+
+/* element changes of a vector are `vector_edit`s relative to the state they
+  apply to, coalescing them must keep every inverse */
+TEST(History, UndoCoalescedVectorEdits) {
+  const auto t0 = History::clock::now();
+  const Options original = base_options();
+  Options s = original;
+  History history;
+
+  Options next = s;
+  next.model.volume.opacity_map[0] = 0.1;
+  history.apply(s, OptionsIO::edit_diff(next, s), t0);
+  next.model.volume.opacity_map[50] = 0.9;
+  history.apply(s, OptionsIO::edit_diff(next, s),
+                t0 + std::chrono::milliseconds(1));
+  ASSERT_EQ(history.undo_count(), 1u);
+  EXPECT_EQ(s.model.volume.opacity_map, next.model.volume.opacity_map);
+
+  ASSERT_TRUE(history.undo(s));
+  EXPECT_EQ(s.model.volume.opacity_map, original.model.volume.opacity_map);
+
+  ASSERT_TRUE(history.redo(s));
+  EXPECT_EQ(s.model.volume.opacity_map, next.model.volume.opacity_map);
+}
+
+TEST(History, UndoCoalescedValues) {
+  const auto t0 = History::clock::now();
+  const Options original;
+  Options s = original;
+  History history;
+
+  for (int i = 1; i <= 3; ++i) {
+    Options next = s;
+    next.camera.view_angle = 10. * i;
+    history.apply(s, OptionsIO::diff(next, s),
+                  t0 + std::chrono::milliseconds(i));
+  }
+  EXPECT_EQ(history.undo_count(), 1u);
+  EXPECT_EQ(s.camera.view_angle, 30.);
+
+  ASSERT_TRUE(history.undo(s));
+  EXPECT_TRUE(same_options(s, original));
+}
+
+/* undoing a random sequence of changes, some of them coalesced, restores the
+  initial state */
+TEST(History, UndoRandomChanges) {
+  std::mt19937 rng(0);
+  const auto t0 = History::clock::now();
+  const Options original = filled_options();
+  Options s = original;
+  History history(1 << 24);
+
+  for (int i = 0; i < 100; ++i) {
+    const Options next = random_change(s, rng);
+    history.apply(s, OptionsIO::edit_diff(next, s),
+                  t0 + std::chrono::seconds(i / 2));
+    ASSERT_TRUE(same_options(s, next));
+  }
+
+  while (history.undo(s))
+    ;
+  EXPECT_TRUE(same_options(s, original));
+}
@@ -0,0 +1,126 @@
+#include <array>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "options-io.h"
+#include "regex-parsers.h"
+#include "test-helpers.h"
+
+namespace {
+
+/* outcome of a parser: the value, or the exception type and message
+  (`std::out_of_range` messages are those of `std::stod` in the regex
+  parsers, only the type is compared) */
+struct outcome {
+  std::array<double, 3> value = {};
+  std::string error;
+
+  bool operator==(const outcome &) const = default;
+};
+
+template <typename Parse> outcome run(Parse parse, const std::string &s) {
+  try {
+    return {parse(s), {}};
+  } catch (std::out_of_range &) {
+    return {{}, "out_of_range"};
+  } catch (std::invalid_argument &e) {
+    return {{}, e.what()};
+  }
+}
+
+void PrintTo(const outcome &o, std::ostream *os) {
+  if (o.error.empty())
+    *os << "(" << o.value[0] << ", " << o.value[1] << ", " << o.value[2] << ")";
+  else
+    *os << o.error;
+}
+
+/* inputs close to the grammar: numbers, axes, separators and brackets */
+std::string random_input(std::mt19937 &rng) {
+  static const std::vector<std::string> tokens = {
+      "0",  "1",   "12", "3.", ".5", "1.5", "e", "E", "e-2", "+", "-",
+      "x",  "Y",   "z",  ",",  " ",  "  ",  "(", ")", "[",   "]", "{",
+      "}",  "#",   "ff", "0A", "g",  "1e999", "\t", ".", "+-", "00",
+  };
+  std::string s;
+  for (int n = rng() % 8; n > 0; --n)
+    s += tokens[rng() % tokens.size()];
+  return s;
+}
+
+const std::vector<std::string> edge_cases = {
+    "",          "x",         "-y",         "+z",         "xyz",
+    "-x+y-z",    "-xy",       "X",          "yx",         "1,2,3",
+    "1 2 3",     "123",       "1.2.3",      "1..2",       "(1,2,3)",
+    "[1 2 3]",   "{1,2,3}",   "(1,2,3]",    "(1,2,3",     "1,2,3)",
+    " 1,2,3 ",   "( 1 , 2 , 3 )", "1,,2,3", "1e2,3e-1,-4E+2", "1e,2,3",
+    ".5,.5,.5",  "5.,5.,5.",  "+1,-2,+3",   "+-1,2,3",    "1e999,0,0",
+    "1e-999,0,0", "#ff8000",  "#FF8000",    "#ff800",     "#ff80000",
+    "#gg8000",   "ff8000",    "#ff8000 ",   "1.5e2.5,1,1", "12e3",
+};
+
+template <typename Regex, typename Scanner>
+void compare(Regex regex, Scanner scanner) {
+  for (const auto &s : edge_cases)
+    EXPECT_EQ(run(scanner, s), run(regex, s)) << '"' << s << '"';
+
+  std::mt19937 rng(12);
+  for (int i = 0; i < 2000; ++i) {
+    const auto s = random_input(rng);
+    EXPECT_EQ(run(scanner, s), run(regex, s)) << '"' << s << '"';
+  }
+}
+
+} // namespace
+
+/* the scanners of options-io.cpp accept the grammar of the regex parsers
+  they replaced, with the same values and error messages */
+TEST(Scanners, Vector3MatchesRegex) {
+  compare(regex_parsers::parse_Vector3, options_ns::parse_Vector3);
+}
+
+TEST(Scanners, Point3MatchesRegex) {
+  compare(regex_parsers::parse_Point3, options_ns::parse_Point3);
+}
+
+TEST(Scanners, ColorMatchesRegex) {
+  compare(regex_parsers::parse_Color, options_ns::parse_Color);
+}
+
+/* numbers are the whole string but surrounding spaces, the throwing parsers
+  reject what the `try_` ones do */
+TEST(Numbers, WholeString) {
+  EXPECT_EQ(options_ns::parse_int(" 12 "), 12);
+  EXPECT_EQ(options_ns::parse_int("+12"), 12);
+  EXPECT_EQ(options_ns::parse_int("-3"), -3);
+  EXPECT_EQ(options_ns::parse_double("1e3"), 1000.);
+  EXPECT_EQ(options_ns::parse_double(".5"), 0.5);
+  EXPECT_EQ(options_ns::parse_double("-inf"),
+            -std::numeric_limits<double>::infinity());
+
+  for (const std::string s : {"", "abc", "12abc", "1 2", "0x10", "++1"}) {
+    EXPECT_THROW(options_ns::parse_int(s), std::invalid_argument) << s;
+    EXPECT_FALSE(options_ns::try_parse_int(s)) << s;
+  }
+  for (const std::string s : {"", "1e3x", "0x1p3", "1.5.", "1e", "+-1"}) {
+    EXPECT_THROW(options_ns::parse_double(s), std::invalid_argument) << s;
+    EXPECT_FALSE(options_ns::try_parse_double(s)) << s;
+  }
+  EXPECT_THROW(options_ns::parse_int("99999999999"), std::out_of_range);
+  EXPECT_THROW(options_ns::parse_double("1e999"), std::out_of_range);
+}
+
+/* errors about keys own a copy of the key */
+TEST(Numbers, KeyErrorOwnsKey) {
+  const auto error = [] {
+    std::string key = "no.such.key.with.a.long.name";
+    return OptionsIO::try_from_string(key, "1").error();
+  }();
+  EXPECT_EQ(error.code, options_ns::conversion_errc::invalid_key);
+  EXPECT_EQ(error.subject, "no.such.key.with.a.long.name");
+}